@@ -1,4 +1,95 @@
+#!/bin/sh
+# Usage: ./build.sh         build, install and tail logs on the phone
+#        ./build.sh host    build the host stand-in and run the benchmark
+#        ./build.sh sync    build sync records and run the phone sync scenarios
+#        ./build.sh check   build the host stand-in and check the app on the shipped notes
+#        ./build.sh replay  replay the button traces in host/traces on a long note
+#        ./build.sh printf  fuzz mini-printf against the C library and time it
+#        ./build.sh footprint  heap of every screen and the static footprint
+#                              against FOOTPRINT_MAX_RAM, host objects
+
+HOST_OUT=build/host
+# Static RAM (data + bss) budgets: the watch app gets 24 KB, what the app
+# image leaves is the heap of the windows and the notes
+FOOTPRINT_MAX_RAM=6144
+WATCH_MAX_RAM=12288
+
+HOST_CFLAGS="-std=c99 -O2 -Wall -Wno-unused-parameter -D_POSIX_C_SOURCE=199309L -Ihost -Isrc"
+
+if [ "$1" = "printf" ]; then
+ mkdir -p $HOST_OUT && \
+ gcc $HOST_CFLAGS host/printf-check.c src/mini-printf.c -o $HOST_OUT/printf-check && \
+ $HOST_OUT/printf-check
+ exit $?
+fi
+
+# Every .txt (or .csv, a table) file in NOTES is a note, in name order
+NOTES=resources/notes
+
+# FONT must match FONT_TYPE in src/main.c
+FONT=GOTHIC_14
+
+python3 tools/build_notes.py --font $FONT $NOTES || exit 1
+
+if [ "$1" = "host" ] || [ "$1" = "check" ] || [ "$1" = "sync" ] || [ "$1" = "replay" ] || [ "$1" = "footprint" ]; then
+ mkdir -p $HOST_OUT && \
+ for src in src/*.c host/pebble-host.c; do
+  gcc $HOST_CFLAGS -Dmain=notepad_main -c $src -o $HOST_OUT/$(basename $src .c).o || exit 1
+ done
+fi
+
+# The heap of each screen over a tour of the app, with the stats on, then
+# the symbols of the app objects, built like for the watch
+if [ "$1" = "footprint" ]; then
+ FOOTPRINT_OUT=$HOST_OUT/footprint
+ mkdir -p $FOOTPRINT_OUT && \
+ for src in src/*.c host/pebble-host.c; do
+  gcc $HOST_CFLAGS -DSTATS_ENABLED=1 -Dmain=notepad_main -c $src -o $FOOTPRINT_OUT/$(basename $src .c).o || exit 1
+ done
+ gcc $HOST_CFLAGS -DSTATS_ENABLED=1 host/replay.c $FOOTPRINT_OUT/*.o -o $FOOTPRINT_OUT/replay && \
+ $FOOTPRINT_OUT/replay host/footprint.trace && \
+ echo && \
+ python3 tools/footprint.py --max-ram $FOOTPRINT_MAX_RAM $(ls $HOST_OUT/*.o | grep -v pebble-host)
+ exit $?
+fi
+
+if [ "$1" = "host" ]; then
+ gcc $HOST_CFLAGS host/bench.c $HOST_OUT/*.o -o $HOST_OUT/bench && \
+ $HOST_OUT/bench
+ exit $?
+fi
+
+if [ "$1" = "check" ]; then
+ gcc $HOST_CFLAGS host/check.c $HOST_OUT/*.o -o $HOST_OUT/check && \
+ $HOST_OUT/check
+ exit $?
+fi
+
+# A long note made of the shipped ones, so traces never hit its end
+if [ "$1" = "replay" ]; then
+ REPLAY_OUT=$HOST_OUT/traces
+ mkdir -p $REPLAY_OUT/notes && \
+ for i in $(seq 40); do cat $NOTES/note0.txt $NOTES/note1.txt; done > $REPLAY_OUT/notes/long.txt && \
+ python3 tools/build_notes.py --font $FONT --out $REPLAY_OUT/generated $REPLAY_OUT/notes > /dev/null && \
+ gcc $HOST_CFLAGS host/replay.c $HOST_OUT/*.o -o $HOST_OUT/replay && \
+ $HOST_OUT/replay -d $REPLAY_OUT host/traces/*.trace
+ exit $?
+fi
+
+# Sync records of two notes, then of the first with a line added
+if [ "$1" = "sync" ]; then
+ SYNC_OUT=$HOST_OUT/sync
+ mkdir -p $SYNC_OUT/edited && \
+ python3 tools/sync.py --font $FONT $SYNC_OUT $NOTES/note1.txt $NOTES/note2.txt && \
+ { cat $NOTES/note1.txt; echo "A line added on the phone."; } > $SYNC_OUT/edited/note1.txt && \
+ python3 tools/sync.py --font $FONT $SYNC_OUT/edited $SYNC_OUT/edited/note1.txt && \
+ gcc $HOST_CFLAGS host/sync-sim.c host/phone-sim.c $HOST_OUT/*.o -o $HOST_OUT/sync-sim && \
+ $HOST_OUT/sync-sim $SYNC_OUT/note1.ns $SYNC_OUT/note2.ns $SYNC_OUT/edited/note1.ns
+ exit $?
+fi
+
  pebble clean && \
  pebble build && \
+ python3 tools/footprint.py --nm arm-none-eabi-nm --max-ram $WATCH_MAX_RAM build/pebble-app.elf && \
  pebble install --phone mobile && \
  pebble logs --phone mobile
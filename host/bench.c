@@ -0,0 +1,722 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Host benchmark driver. Runs src/main.c on the host stand-in over
+ *          synthetic notes from 1 KB to 1 MB and times note open (cold
+ *          and prefetched from the menu), menu redraw and scroll timer
+ *          ticks, the same for a locked 256 KB note, PIN pushes included,
+ *          then does the same with packs of up to 500 notes. Then
+ *          replays auto scroll and long pushes to count wakeups and
+ *          redraws, times page flips and go to jumps, and reports the
+ *          decode throughput of the notes shipped in resources/generated,
+ *          the cost of searching them, opening, paging and finding a row by
+ *          key in tables of 10 to 10000 rows and the cost of one log call
+ *          in each mode.
+ *
+ *   Usage: build/host/bench [repeats]
+ *******************************************************************************
+ */
+
+#include "pebble-host.h"
+#include "note-lz.h"
+#include "note-search.h"
+#include "note-view.h"
+#include "note-table.h"
+#include "pebble-log.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TICK_MS 100
+#define TICKS 1000
+#define BLOCK_LEN 512
+#define DECODE_ROUNDS 2000
+#define SEARCH_ROUNDS 2000
+#define SCROLL_STEP_MS 10
+#define PREFETCH_WAIT_MS 1000
+#define LOG_ROUNDS 100000
+#define TABLE_HEADER_LEN 8
+#define TABLE_COLUMN_LEN 28
+#define TABLE_KEY_LEN 12
+#define TABLE_KEYS_PER_BUCKET 3
+#define LOOKUP_ROUNDS 2000
+#define PACK_HEADER_LEN 24
+#define PACK_ENTRY_LEN 52
+#define LOCKED_SIZE (256 << 10)
+#define LOCKED_PIN "UUDS"
+
+static const size_t bench_sizes[] = { 1 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20 };
+static const uint32_t bench_counts[] = { 10, 100, 500 };
+static const uint32_t bench_rows[] = { 10, 100, 1000, 10000 };
+
+extern MenuLayer *menu_layer;
+extern NoteView note_view;
+extern NoteTable note_table;
+
+static double bench_now_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+  /**
+   *  Fills a note with periodic-table looking lines, normalized like
+   *  tools/normalize.py leaves them (tabs expanded, LF line ends)
+   */
+static uint8_t *bench_note(size_t size) {
+	static const char *lines[] = {
+		"Symbol  Fe\n", "Atomic Number   26\n", "Atomic Weight   55.845\n",
+		"Group   8 (transition metals)\n", "Density 7.874 g/cm3\n",
+		"Melting Point   1538 C and a longer line that will need to be wrapped on the watch screen\n",
+		"\n",
+	};
+	uint8_t *note = malloc(size);
+	size_t used = 0;
+	for (size_t i = 0; used < size; i++) {
+		const char *line = lines[i % (sizeof(lines) / sizeof(lines[0]))];
+		size_t len = strlen(line);
+		if (len > size - used) len = size - used;
+		memcpy(note + used, line, len);
+		used += len;
+	}
+	return note;
+}
+
+  /**
+   *  Wraps plain text in the compressed note container using only literal
+   *  runs, which is a valid (if poor) encoding for any input
+   */
+static uint8_t *bench_store(const uint8_t *text, size_t size, size_t *packed_size) {
+	uint32_t blocks = (size + BLOCK_LEN - 1) / BLOCK_LEN;
+	uint32_t header = 12 + 4 * (blocks + 1);
+	uint8_t *packed = malloc(header + size + size / 128 + blocks + 1);
+	uint8_t *p = packed + header;
+
+	memcpy(packed, "NZ\1\0", 4);
+	memcpy(packed + 4, &(uint32_t){ size }, 4);
+	memcpy(packed + 8, &(uint16_t){ BLOCK_LEN }, 2);
+	memcpy(packed + 10, &(uint16_t){ blocks }, 2);
+	for (uint32_t b = 0; b < blocks; b++) {
+		uint32_t offset = p - packed;
+		memcpy(packed + 12 + 4 * b, &offset, 4);
+		size_t from = b * BLOCK_LEN;
+		size_t len = (size - from < BLOCK_LEN) ? size - from : BLOCK_LEN;
+		for (size_t i = 0; i < len; i += 128) {
+			size_t run = (len - i < 128) ? len - i : 128;
+			*p++ = run - 1;
+			memcpy(p, text + from + i, run);
+			p += run;
+		}
+	}
+	uint32_t end = p - packed;
+	memcpy(packed + 12 + 4 * blocks, &end, 4);
+	*packed_size = end;
+	return packed;
+}
+
+  /**
+   *  Locks a note of bench_store behind pin, like tools/cipher.py: encrypts
+   *  its blocks and flags the container. Returns the PIN check.
+   */
+static uint32_t bench_lock(uint8_t *packed, size_t packed_size, const char *pin, uint32_t hash) {
+	NoteKey key;
+	uint32_t blocks = packed[10] | (packed[11] << 8);
+	uint32_t start = 12 + 4 * (blocks + 1);
+	uint32_t check = note_key_derive(&key, pin, strlen(pin), hash);
+	note_cipher_apply(&key, start, packed + start, packed_size - start);
+	packed[3] |= NOTE_LZ_FLAG_LOCKED;
+	return check;
+}
+
+  /**
+   *  Line table for a synthetic note, wrapping every 24 characters like
+   *  the fixed-advance font of the host stand-in
+   */
+static uint8_t *bench_lines(const uint8_t *text, size_t size, size_t *table_size) {
+	uint32_t count = 1;
+	uint32_t *starts = malloc(4 * (size + 1));
+	uint32_t column = 0;
+	starts[0] = 0;
+	for (size_t i = 0; i < size; i++) {
+		if (text[i] == '\n' || ++column > 24) {
+			if (i + 1 < size) starts[count++] = (text[i] == '\n') ? i + 1 : i;
+			column = (text[i] == '\n') ? 0 : 1;
+		}
+	}
+
+	uint8_t *table = malloc(12 + 4 * count);
+	memcpy(table, "NL\1\16", 4);
+	memcpy(table + 4, &(uint16_t){ 16 }, 2);
+	memcpy(table + 6, &(uint16_t){ 144 }, 2);
+	memcpy(table + 8, &count, 4);
+	memcpy(table + 12, starts, 4 * count);
+	free(starts);
+	*table_size = 12 + 4 * count;
+	return table;
+}
+
+  /**
+   *  Note pack holding copies entries that all point at the same note and
+   *  line table, with no dictionary or search index
+   */
+static uint8_t *bench_pack(const uint8_t *note, size_t note_size, const uint8_t *lines, size_t lines_size,
+						   uint32_t copies, size_t *pack_size) {
+	uint32_t body = PACK_HEADER_LEN + PACK_ENTRY_LEN * copies;
+	uint8_t *pack = calloc(1, body + note_size + lines_size);
+
+	memcpy(pack, "NP\2\30", 4);
+	memcpy(pack + 4, &copies, 4);
+	memcpy(pack + 8, &body, 4);
+	memcpy(pack + 16, &body, 4);
+	for (uint32_t i = 0; i < copies; i++) {
+		uint8_t *entry = pack + PACK_HEADER_LEN + PACK_ENTRY_LEN * i;
+		memcpy(entry, &body, 4);
+		memcpy(entry + 4, &(uint32_t){ note_size }, 4);
+		memcpy(entry + 8, &(uint32_t){ body + note_size }, 4);
+		memcpy(entry + 12, &(uint32_t){ lines_size }, 4);
+		memcpy(entry + 24, &i, 4);
+		snprintf((char*)entry + 28, 24, "Bench %u", (unsigned)i);
+	}
+	memcpy(pack + body, note, note_size);
+	memcpy(pack + body + note_size, lines, lines_size);
+	*pack_size = body + note_size + lines_size;
+	return pack;
+}
+
+  /**
+   *  Key hash of tools/table.py
+   */
+static uint32_t bench_key_hash(const char *key, size_t len, uint32_t seed) {
+	uint32_t h = 2166136261u ^ seed;
+	for (size_t i = 0; i < len; i++) h = (h ^ (uint8_t)key[i]) * 16777619u;
+	return h ^ (h >> 15);
+}
+
+static uint32_t *bench_bucket_size;
+
+static int bench_by_size(const void *a, const void *b) {
+	return (int)bench_bucket_size[*(const uint32_t*)b] - (int)bench_bucket_size[*(const uint32_t*)a];
+}
+
+  /**
+   *  Minimal perfect hash of the row numbers as text, like perfect_hash of
+   *  tools/table.py: biggest buckets first, each takes the first seed that
+   *  puts all its keys on free slots. Fills seeds and the slots, returns
+   *  the buckets.
+   */
+static uint32_t bench_key_index(uint32_t rows, uint8_t length, uint16_t *seeds, uint8_t *slots) {
+	char (*keys)[TABLE_KEY_LEN] = calloc(rows, TABLE_KEY_LEN);
+	uint32_t *bucket = malloc(4 * rows), *order = malloc(4 * rows), *at = malloc(4 * rows);
+	uint8_t *taken = malloc(rows);
+	uint32_t m = (rows + TABLE_KEYS_PER_BUCKET - 1) / TABLE_KEYS_PER_BUCKET;
+	for (uint32_t r = 0; r < rows; r++) snprintf(keys[r], TABLE_KEY_LEN, "%u", (unsigned)r);
+
+	for (bool placed = false; !placed; m += m / 4 + 1) {
+		bench_bucket_size = calloc(m + 1, 4);
+		uint32_t *start = calloc(m + 1, 4), *buckets = malloc(4 * m);
+		// Keys grouped by bucket, then buckets by size
+		for (uint32_t r = 0; r < rows; r++) {
+			bucket[r] = bench_key_hash(keys[r], strlen(keys[r]), 0) % m;
+			bench_bucket_size[bucket[r]]++;
+		}
+		for (uint32_t b = 0; b < m; b++) start[b + 1] = start[b] + bench_bucket_size[b];
+		for (uint32_t r = 0; r < rows; r++) order[start[bucket[r]]++] = r;
+		for (uint32_t b = 0; b < m; b++) start[b] -= bench_bucket_size[b];
+		for (uint32_t b = 0; b < m; b++) buckets[b] = b;
+		qsort(buckets, m, 4, bench_by_size);
+		memset(taken, 0, rows);
+		memset(seeds, 0, 2 * m);
+
+		placed = true;
+		for (uint32_t i = 0; i < m && placed; i++) {
+			uint32_t b = buckets[i], n = bench_bucket_size[b];
+			if (n == 0) break;
+			placed = false;
+			for (uint32_t seed = 1; seed < 65536 && !placed; seed++) {
+				placed = true;
+				for (uint32_t k = 0; k < n && placed; k++) {
+					const char *key = keys[order[start[b] + k]];
+					at[k] = bench_key_hash(key, strlen(key), seed) % rows;
+					placed = !taken[at[k]];
+					for (uint32_t j = 0; j < k && placed; j++) placed = at[j] != at[k];
+				}
+				if (!placed) continue;
+				seeds[b] = seed;
+				for (uint32_t k = 0; k < n; k++) {
+					uint32_t r = order[start[b] + k];
+					uint8_t *slot = slots + (length + 2) * at[k];
+					taken[at[k]] = 1;
+					memcpy(slot, keys[r], strlen(keys[r]));
+					memcpy(slot + length, &(uint16_t){ r }, 2);
+				}
+			}
+		}
+		free(bench_bucket_size);
+		free(start);
+		free(buckets);
+		if (placed) break;
+	}
+	free(keys);
+	free(bucket);
+	free(order);
+	free(at);
+	free(taken);
+	return m;
+}
+
+  /**
+   *  Table of rows rows (see tools/table.py): a row number, a signed
+   *  decimal and a text column, keyed by the row number
+   */
+static uint8_t *bench_table(uint32_t rows, size_t *table_size) {
+	uint8_t length = snprintf(NULL, 0, "%u", (unsigned)(rows - 1));
+	uint32_t values = TABLE_HEADER_LEN + TABLE_COLUMN_LEN * 3 + TABLE_KEY_LEN;
+	uint32_t pool = values + 12 * rows;
+	uint32_t keys = pool + 16 * rows;
+	uint8_t *table = calloc(1, keys + 2 * rows + (length + 2) * rows);
+	uint8_t *p = table + values;
+	uint32_t used = 0;
+
+	memcpy(table, "NT\2\3", 4);
+	memcpy(table + 4, &(uint16_t){ rows }, 2);
+	table[6] = 16;
+	table[7] = 1;
+	for (uint32_t c = 0; c < 3; c++) {
+		uint8_t *column = table + TABLE_HEADER_LEN + TABLE_COLUMN_LEN * c;
+		column[0] = (c == 2);                // Text
+		column[1] = 4;
+		column[2] = (c == 1);                // Signed
+		column[3] = (c == 1) ? 3 : 0;
+		column[4] = 48;
+		memcpy(column + 8, &(uint32_t){ values + 4 * rows * c }, 4);
+		memcpy(column + 12, &pool, 4);
+		snprintf((char*)column + 16, 12, "%s", (c == 0) ? "#" : (c == 1) ? "Value" : "Name");
+	}
+	for (uint32_t r = 0; r < rows; r++) {
+		int32_t value = (int32_t)(r * 1234) - 50000;
+		memcpy(p + 4 * r, &r, 4);
+		memcpy(p + 4 * (rows + r), &value, 4);
+		memcpy(p + 4 * (2 * rows + r), &used, 4);
+		used += snprintf((char*)table + pool + used, 16, "Row %u", (unsigned)r) + 1;
+	}
+
+	// Key data goes after the pool, the seeds take 2 bytes per bucket
+	keys = pool + used;
+	uint16_t *seeds = calloc(rows, 2);
+	uint32_t m = bench_key_index(rows, length, seeds, table + keys + 2 * rows);
+	uint32_t slots = keys + 2 * m;
+	memmove(table + slots, table + keys + 2 * rows, (length + 2) * rows);
+	memcpy(table + keys, seeds, 2 * m);
+	uint8_t *key = table + TABLE_HEADER_LEN + TABLE_COLUMN_LEN * 3;
+	key[1] = length;
+	memcpy(key + 2, &(uint16_t){ m }, 2);
+	memcpy(key + 4, &keys, 4);
+	memcpy(key + 8, &slots, 4);
+	free(seeds);
+	*table_size = slots + (length + 2) * rows;
+	return table;
+}
+
+  /**
+   *  Opens a table note and pages to its last rows, counting reads
+   */
+static void bench_table_app(uint32_t rows, int repeats) {
+	size_t table_size, pack_size;
+	uint8_t *table = bench_table(rows, &table_size);
+	uint8_t *pack = bench_pack(table, table_size, NULL, 0, 1, &pack_size);
+	pack[PACK_HEADER_LEN + 20] = 1;          // Table flag
+
+	host_reset();
+	host_persist_clear();
+	host_set_resource(RESOURCE_ID_NOTE_PACK, pack, pack_size);
+	init();
+	host_render();
+
+	host_reset_counters();
+	double start = bench_now_us();
+	for (int r = 0; r < repeats; r++) {
+		host_single_click(BUTTON_ID_SELECT);
+		host_render();
+		if (r + 1 < repeats) host_single_click(BUTTON_ID_BACK);
+	}
+	double open_us = (bench_now_us() - start) / repeats;
+	uint32_t open_bytes = host_counters.resource_bytes / repeats;
+	
+	// The same after the highlighted note was prefetched from the menu
+	host_single_click(BUTTON_ID_BACK);
+	double prefetched_us = 0;
+	uint32_t prefetched_bytes = 0;
+	for (int r = 0; r < repeats; r++) {
+		host_advance(PREFETCH_WAIT_MS);
+		host_reset_counters();
+		start = bench_now_us();
+		host_single_click(BUTTON_ID_SELECT);
+		host_render();
+		prefetched_us += bench_now_us() - start;
+		prefetched_bytes += host_counters.resource_bytes;
+		if (r + 1 < repeats) host_single_click(BUTTON_ID_BACK);
+	}
+	prefetched_us /= repeats;
+	prefetched_bytes /= repeats;
+
+	// Jump to the end, then time frames there
+	for (uint32_t r = 0; r < rows; r += 8) host_single_click(BUTTON_ID_DOWN);
+	host_render();
+	host_reset_counters();
+	start = bench_now_us();
+	for (int r = 0; r < repeats; r++) {
+		host_single_click(BUTTON_ID_SELECT);
+		host_render();
+	}
+	double page_us = (bench_now_us() - start) / repeats;
+	double page_reads = (double)host_counters.resource_reads / repeats;
+	uint32_t page_bytes = host_counters.resource_bytes / repeats;
+
+	// Finding rows by key, with the seeds the table window loaded
+	char key[TABLE_KEY_LEN];
+	uint32_t found = 0;
+	host_reset_counters();
+	start = bench_now_us();
+	for (uint32_t i = 0; i < LOOKUP_ROUNDS; i++) {
+		uint32_t row = (i * 7919) % rows;
+		snprintf(key, sizeof(key), "%u", (unsigned)row);
+		found += note_table_find(&note_table, key, NULL) == (int32_t)row;
+	}
+	double find_us = (bench_now_us() - start) / LOOKUP_ROUNDS;
+	if (found != LOOKUP_ROUNDS) printf("%u keys not found\n", (unsigned)(LOOKUP_ROUNDS - found));
+
+	printf("%10u %10.1f %10u %10.1f %10.1f %10u %10.2f %10.1f\n", (unsigned)rows, open_us, open_bytes, page_us,
+		   page_reads, page_bytes, find_us, (double)host_counters.resource_reads / LOOKUP_ROUNDS);
+
+	host_reset();
+	deinit();
+	host_set_resource(RESOURCE_ID_NOTE_PACK, NULL, 0);
+	free(pack);
+	free(table);
+}
+
+  /**
+   *  Opens the highlighted note, pushing its PIN when it has one
+   */
+static void bench_open(const char *pin) {
+	host_single_click(BUTTON_ID_SELECT);
+	for (; pin && *pin; pin++) {
+		host_single_click((*pin == NOTE_PIN_UP) ? BUTTON_ID_UP : (*pin == NOTE_PIN_DOWN) ? BUTTON_ID_DOWN : BUTTON_ID_SELECT);
+	}
+}
+
+  /**
+   *  Runs the app over a pack and times menu redraw, opening the note at
+   *  row, with pin when it is locked, and auto scrolling it
+   */
+static void bench_app(const char *label, const uint8_t *pack, size_t pack_size, uint16_t row, const char *pin, int repeats) {
+	host_reset();
+	host_persist_clear();
+	host_set_resource(RESOURCE_ID_NOTE_PACK, pack, pack_size);
+	init();
+	menu_layer_set_selected_index(menu_layer, (MenuIndex){ 0, row }, MenuRowAlignCenter, false);
+	host_render();
+
+	// Menu redraw
+	double start = bench_now_us();
+	for (int r = 0; r < repeats; r++) host_render();
+	double menu_us = (bench_now_us() - start) / repeats;
+
+	// Note open, from select click to first frame
+	host_reset_counters();
+	start = bench_now_us();
+	for (int r = 0; r < repeats; r++) {
+		bench_open(pin);
+		host_render();
+		if (r + 1 < repeats) host_single_click(BUTTON_ID_BACK);
+	}
+	double open_us = (bench_now_us() - start) / repeats;
+	uint32_t open_bytes = host_counters.resource_bytes / repeats;
+	
+	// The same after the highlighted note was prefetched from the menu
+	host_single_click(BUTTON_ID_BACK);
+	double prefetched_us = 0;
+	uint32_t prefetched_bytes = 0;
+	for (int r = 0; r < repeats; r++) {
+		host_advance(PREFETCH_WAIT_MS);
+		host_reset_counters();
+		start = bench_now_us();
+		bench_open(pin);
+		host_render();
+		prefetched_us += bench_now_us() - start;
+		prefetched_bytes += host_counters.resource_bytes;
+		if (r + 1 < repeats) host_single_click(BUTTON_ID_BACK);
+	}
+	prefetched_us /= repeats;
+	prefetched_bytes /= repeats;
+
+	// Auto scroll ticks through the note
+	host_reset_counters();
+	start = bench_now_us();
+	for (int t = 0; t < TICKS; t++) {
+		host_advance(TICK_MS);
+		host_render();
+	}
+	double tick_us = (bench_now_us() - start) / TICKS;
+	uint32_t tick_bytes = host_counters.resource_bytes / TICKS;
+
+	printf("%10s %12.1f %12u %12.1f %12u %12.1f %12.1f %12u\n",
+		   label, open_us, open_bytes, prefetched_us, prefetched_bytes, menu_us, tick_us, tick_bytes);
+
+	host_reset();
+	deinit();
+	host_set_resource(RESOURCE_ID_NOTE_PACK, NULL, 0);
+}
+
+  /**
+   *  Lets the scroll engine run for ms, redrawing like the firmware does:
+   *  once per pass of the event loop that left something dirty
+   */
+static void bench_scroll_run(const char *label, uint32_t ms) {
+	host_reset_counters();
+	int32_t from = note_view_get_offset(&note_view);
+	int32_t last = from, max_step = 0;
+	uint32_t redraws = 0;
+	double start = bench_now_us();
+	for (uint32_t t = 0; t < ms; t += SCROLL_STEP_MS) {
+		uint32_t dirty = host_counters.dirty_marks;
+		host_advance(SCROLL_STEP_MS);
+		if (host_counters.dirty_marks == dirty) continue;
+		host_render();
+		redraws++;
+		int32_t top = note_view_get_offset(&note_view);
+		int32_t step = (top > last) ? top - last : last - top;
+		if (step > max_step) max_step = step;
+		last = top;
+	}
+	double us = bench_now_us() - start;
+	printf("%10s %8u %10.1f %10.1f %8d %8d %10.1f\n", label, (unsigned)ms,
+		   host_counters.timer_wakeups * 1000.0 / ms, redraws * 1000.0 / ms,
+		   (int)(last - from), (int)max_step, us * 1000 / ms);
+}
+
+  /**
+   *  One page flip with button, or with percent > 0 a landing from the go
+   *  to bar: opened and set to 0% before timing, picked with single clicks
+   */
+static void bench_page_run(const char *label, ButtonId button, int percent) {
+	int32_t from = note_view_get_offset(&note_view);
+	if (percent > 0) {
+		host_long_click_down(BUTTON_ID_SELECT);
+		host_long_click_up(BUTTON_ID_SELECT);
+		host_multi_click(BUTTON_ID_UP, 2);
+	}
+	host_reset_counters();
+	double start = bench_now_us();
+	for (int step = 0; step < percent; step += 10) host_single_click(BUTTON_ID_DOWN);
+	host_single_click(button);
+	host_render();
+	double us = bench_now_us() - start;
+	printf("%10s %8d %10.1f %10u %10u\n", label, (int)(note_view_get_offset(&note_view) - from), us,
+		   (unsigned)host_counters.resource_reads, (unsigned)host_counters.resource_bytes);
+}
+
+  /**
+   *  Auto scroll, long pushes, page flips and the go to bar over a 256 KB
+   *  note
+   */
+static void bench_scroll(void) {
+	size_t size = 256 << 10;
+	uint8_t *text = bench_note(size);
+	size_t packed_size, lines_size, pack_size;
+	uint8_t *note = bench_store(text, size, &packed_size);
+	uint8_t *lines = bench_lines(text, size, &lines_size);
+	uint8_t *pack = bench_pack(note, packed_size, lines, lines_size, 1, &pack_size);
+
+	host_reset();
+	host_persist_clear();
+	host_set_resource(RESOURCE_ID_NOTE_PACK, pack, pack_size);
+	init();
+	host_single_click(BUTTON_ID_SELECT);
+	host_render();
+
+	printf("\n%10s %8s %10s %10s %8s %8s %10s\n", "scroll", "ms", "wakeups/s", "redraws/s", "pixels", "max_step", "us_per_s");
+	host_single_click(BUTTON_ID_SELECT);
+	bench_scroll_run("auto", 10000);
+	host_single_click(BUTTON_ID_SELECT);
+	host_long_click_down(BUTTON_ID_DOWN);
+	bench_scroll_run("hold down", 3000);
+	host_long_click_up(BUTTON_ID_DOWN);
+	host_long_click_down(BUTTON_ID_UP);
+	bench_scroll_run("hold up", 1000);
+	host_long_click_up(BUTTON_ID_UP);
+	bench_scroll_run("idle", 1000);
+	
+	// Page flips and the go to bar, from the top
+	printf("\n%10s %8s %10s %10s %10s\n", "page", "pixels", "us", "reads", "bytes");
+	host_multi_click(BUTTON_ID_UP, 2);
+	host_render();
+	bench_page_run("flip", BUTTON_ID_DOWN, 0);
+	bench_page_run("flip back", BUTTON_ID_UP, 0);
+	for (int percent = 10; percent <= 90; percent += 40) {
+		char label[16];
+		snprintf(label, sizeof(label), "go to %d%%", percent);
+		bench_page_run(label, BUTTON_ID_SELECT, percent);
+	}
+
+	host_reset();
+	deinit();
+	host_set_resource(RESOURCE_ID_NOTE_PACK, NULL, 0);
+	free(pack);
+	free(note);
+	free(lines);
+	free(text);
+}
+
+  /**
+   *  Decodes every block of a shipped note over and over
+   */
+static void bench_decode(NotePack *pack, uint32_t row) {
+	NotePackEntry entry;
+	NoteLz note;
+	char out[BLOCK_LEN];
+	if (!note_pack_entry(pack, row, &entry) || !note_lz_open(&note, pack->handle, entry.offset)) return;
+
+	size_t packed = entry.length;
+	double start = bench_now_us();
+	for (int r = 0; r < DECODE_ROUNDS; r++) {
+		for (uint16_t b = 0; b < note.num_blocks; b++) note_lz_read_block(&note, b, out, sizeof(out));
+	}
+	double us = (bench_now_us() - start) / DECODE_ROUNDS;
+	printf("%10.10s %8u %8zu %7.1f%% %10.2f\n", entry.title, (unsigned)note.size, packed,
+		   100.0 * packed / note.size, us * 1024 / note.size);
+}
+
+  /**
+   *  Runs a query against the shipped index, snippets included
+   */
+static void bench_search(NotePack *pack, const char *query) {
+	NoteIndex index;
+	NoteSearchHit hits[NOTE_SEARCH_MAX_HITS];
+	char block[NOTE_SEARCH_BLOCK_LEN];
+	uint32_t count = 0, total = 0;
+	if (!note_index_open(&index, pack->handle, pack->index_offset)) return;
+
+	host_reset_counters();
+	double start = bench_now_us();
+	for (int r = 0; r < SEARCH_ROUNDS; r++) {
+		count = note_search_run(&index, query, hits, NOTE_SEARCH_MAX_HITS, &total);
+		note_search_snippets(hits, count, pack, block);
+	}
+	double us = (bench_now_us() - start) / SEARCH_ROUNDS;
+	printf("%10s %8u %8u %8.1f %10.2f\n", query, (unsigned)total, (unsigned)count,
+		   (double)host_counters.resource_reads / SEARCH_ROUNDS, us);
+}
+
+  /**
+   *  ns per message of a scroll step log line: elided, immediate and
+   *  deferred (ring write, then the later drain)
+   */
+static void bench_log(void) {
+	double start = bench_now_us();
+	for (int i = 0; i < LOG_ROUNDS; i++) {
+		LOG_DEBUG("###bench_log: dt %d, top %d, speed %d###", i & 63, i, -i);
+	}
+	double elided = (bench_now_us() - start) * 1000 / LOG_ROUNDS;
+
+	start = bench_now_us();
+	for (int i = 0; i < LOG_ROUNDS; i++) {
+		logThis(APP_LOG_LEVEL_DEBUG, __FILE__, __LINE__, "###bench_log: dt %d, top %d, speed %d###", i & 63, i, -i);
+	}
+	double immediate = (bench_now_us() - start) * 1000 / LOG_ROUNDS;
+
+	double deferred = 0, drained = 0;
+	for (int i = 0; i < LOG_ROUNDS; i += LOG_RING_LEN) {
+		start = bench_now_us();
+		for (int j = 0; j < LOG_RING_LEN; j++) {
+			logDefer(APP_LOG_LEVEL_DEBUG, __FILE__, __LINE__, "###bench_log: dt %d, top %d, speed %d###", j, i, -i, 0);
+		}
+		double middle = bench_now_us();
+		logDrain();
+		deferred += middle - start;
+		drained += bench_now_us() - middle;
+	}
+	deferred = deferred * 1000 / LOG_ROUNDS;
+	drained = drained * 1000 / LOG_ROUNDS;
+
+	printf("%10s %10.1f\n%10s %10.1f\n%10s %10.1f\n%10s %10.1f\n",
+		   "elided", elided, "immediate", immediate, "deferred", deferred, "drain", drained);
+}
+
+int main(int argc, char **argv) {
+	int repeats = (argc > 1) ? atoi(argv[1]) : 20;
+
+	printf("%10s %12s %12s %12s %12s %12s %12s %12s\n",
+		   "note", "open_us", "open_bytes", "prefetch_us", "prefetch_b", "menu_us", "tick_us", "tick_bytes");
+
+	for (size_t s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++) {
+		size_t size = bench_sizes[s];
+		uint8_t *text = bench_note(size);
+		size_t packed_size;
+		uint8_t *note = bench_store(text, size, &packed_size);
+		size_t lines_size;
+		uint8_t *lines = bench_lines(text, size, &lines_size);
+
+		size_t pack_size;
+		uint8_t *pack = bench_pack(note, packed_size, lines, lines_size, 1, &pack_size);
+		char label[16];
+		snprintf(label, sizeof(label), "%zuB", size);
+		bench_app(label, pack, pack_size, 0, NULL, repeats);
+		
+		// The same note locked, it is never prefetched
+		if (size == LOCKED_SIZE) {
+			free(pack);
+			uint32_t check = bench_lock(note, packed_size, LOCKED_PIN, 0);
+			pack = bench_pack(note, packed_size, lines, lines_size, 1, &pack_size);
+			pack[PACK_HEADER_LEN + 20] = NOTE_PACK_FLAG_LOCKED;
+			memcpy(pack + PACK_HEADER_LEN + 21, &check, 3);
+			snprintf(label, sizeof(label), "%zuKB lock", size >> 10);
+			bench_app(label, pack, pack_size, 0, LOCKED_PIN, repeats);
+		}
+
+		free(pack);
+		free(note);
+		free(lines);
+		free(text);
+	}
+
+	// The same 16 KB note in ever bigger packs, opening the last one
+	uint8_t *text = bench_note(16 << 10);
+	size_t packed_size, lines_size, pack_size;
+	uint8_t *note = bench_store(text, 16 << 10, &packed_size);
+	uint8_t *lines = bench_lines(text, 16 << 10, &lines_size);
+	for (size_t c = 0; c < sizeof(bench_counts) / sizeof(bench_counts[0]); c++) {
+		uint8_t *pack = bench_pack(note, packed_size, lines, lines_size, bench_counts[c], &pack_size);
+		char label[16];
+		snprintf(label, sizeof(label), "%u notes", (unsigned)bench_counts[c]);
+		bench_app(label, pack, pack_size, bench_counts[c] - 1, NULL, repeats);
+		free(pack);
+	}
+	free(note);
+	free(lines);
+	free(text);
+
+	bench_scroll();
+
+	printf("\n%10s %10s %10s %10s %10s %10s %10s %10s\n", "table", "open_us", "open_bytes", "page_us", "page_reads",
+		   "page_bytes", "find_us", "find_reads");
+	for (size_t r = 0; r < sizeof(bench_rows) / sizeof(bench_rows[0]); r++) bench_table_app(bench_rows[r], repeats);
+
+	NotePack shipped;
+	note_pack_open(&shipped, RESOURCE_ID_NOTE_PACK);
+
+	printf("\n%10s %8s %8s %8s %10s\n", "decode", "plain", "packed", "ratio", "us_per_KB");
+	for (uint32_t row = 0; row < shipped.count; row++) {
+		NotePackEntry entry;
+		if (note_pack_entry(&shipped, row, &entry) && !(entry.flags & NOTE_PACK_FLAG_TABLE)) bench_decode(&shipped, row);
+	}
+
+	printf("\n%10s %8s %8s %8s %10s\n", "search", "total", "shown", "reads", "us");
+	bench_search(&shipped, "hydrogen");
+	bench_search(&shipped, "ato");
+	bench_search(&shipped, "a");
+	bench_search(&shipped, "zzz");
+
+	printf("\n%10s %10s\n", "log", "ns");
+	bench_log();
+	return 0;
+}
@@ -0,0 +1,317 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Host driver checking what the app does on the shipped notes, run
+ *          through src/main.c and its real handlers on the host stand-in.
+ *          Each check prints ok or FAIL; fails if any check does.
+ *
+ *   Usage: build/host/check
+ *******************************************************************************
+ */
+
+#include "pebble-host.h"
+#include "note-view.h"
+#include "note-lines.h"
+#include "note-stream.h"
+#include "note-search.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Down pushes paging note 0 away from its top before a check
+#define CHECK_PAGES 4
+// Notes in the pack scrolled through by the menu check, hundreds of them
+#define CHECK_MENU_NOTES 300
+// Chunks of the note with a corrupt middle block fed to the stream check
+#define CHECK_STREAM_CHUNKS 8
+#define CHECK_STREAM_CORRUPT 3
+// Pack layout, see tools/pack.py
+#define CHECK_PACK_HEADER_LEN 24
+#define CHECK_PACK_ENTRY_LEN 52
+
+extern MenuLayer *menu_layer;
+extern Window *note_window;
+extern NoteView note_view;
+extern NoteLines note_lines;
+extern char search_query[];
+extern NoteSearchHit search_hits[];
+extern uint32_t search_hit_count;
+extern uint32_t note_meta_misses;
+uint32_t note_count(void);
+
+static int check_failures = 0;
+
+static void check_report(const char *label, bool ok, const char *detail) {
+	printf("%-36s %4s  %s\n", label, ok ? "ok" : "FAIL", detail);
+	if (!ok) check_failures++;
+}
+
+  /**
+   *  A fresh start of the app on the menu, nothing saved
+   */
+static void check_start(void) {
+	host_reset();
+	host_persist_clear();
+	init();
+	host_render();
+}
+
+static void check_stop(void) {
+	host_reset();
+	deinit();
+}
+
+  /**
+   *  Opens the note of row from the menu and pages it down, the position
+   *  it is left at is saved on the way back
+   */
+static int32_t check_leave_paged(uint16_t row) {
+	menu_layer_set_selected_index(menu_layer, (MenuIndex){ 0, row }, MenuRowAlignCenter, false);
+	host_single_click(BUTTON_ID_SELECT);
+	host_render();
+	for (int i = 0; i < CHECK_PAGES; i++) {
+		host_single_click(BUTTON_ID_DOWN);
+		host_advance(1000);
+	}
+	host_render();
+	int32_t top = note_view_get_offset(&note_view);
+	host_single_click(BUTTON_ID_BACK);
+	return top;
+}
+
+  /**
+   *  Searches query from the menu and opens its first hit, false when
+   *  there is none
+   */
+static bool check_open_hit(const char *query, NoteSearchHit *hit) {
+	menu_layer_set_selected_index(menu_layer, (MenuIndex){ 1, 0 }, MenuRowAlignCenter, false);
+	host_single_click(BUTTON_ID_SELECT);
+	strcpy(search_query, query);
+	host_long_click_down(BUTTON_ID_SELECT);
+	host_long_click_up(BUTTON_ID_SELECT);
+	host_render();
+	if (search_hit_count == 0) return false;
+	*hit = search_hits[0];
+	host_single_click(BUTTON_ID_SELECT);
+	host_advance(1000);
+	host_render();
+	return window_stack_get_top_window() == note_window;
+}
+
+  /**
+   *  The first word of a note is a hit at offset 0: it opens at the top,
+   *  not where the note was left
+   */
+static void check_hit_at_start(void) {
+	char detail[64];
+	NoteSearchHit hit = { 0 };
+	check_start();
+	int32_t left = check_leave_paged(0);
+	bool open = check_open_hit("hydrogen", &hit);
+	int32_t top = note_view_get_offset(&note_view);
+	snprintf(detail, sizeof(detail), "hit %d@%u, left at %d, opened at %d",
+			 (int)hit.note, (unsigned)hit.offset, (int)left, (int)top);
+	check_report("hit at offset 0 opens at the top", open && left > 0 && hit.note == 0 && hit.offset == 0 && top == 0, detail);
+	check_stop();
+}
+
+  /**
+   *  A hit further down opens at its line, not where the note was left
+   */
+static void check_hit_over_saved(void) {
+	char detail[64];
+	NoteSearchHit hit = { 0 };
+	check_start();
+	int32_t left = check_leave_paged(0);
+	bool open = check_open_hit("physical", &hit);
+	int32_t top = note_view_get_offset(&note_view);
+	int32_t want = note_lines_y(&note_lines, note_lines_find(&note_lines, hit.offset)) - note_lines.line_height;
+	snprintf(detail, sizeof(detail), "hit %d@%u, left at %d, opened at %d",
+			 (int)hit.note, (unsigned)hit.offset, (int)left, (int)top);
+	check_report("hit opens over a saved position", open && hit.note == 0 && left != want && top == want, detail);
+	check_stop();
+}
+
+  /**
+   *  A snippet whose line runs past the end of its block goes on with the
+   *  next block: "Electronegativity" starts 6 bytes before the block edge
+   */
+static void check_snippet_across_blocks(void) {
+	char detail[64];
+	NoteSearchHit hit = { 0 };
+	check_start();
+	check_open_hit("electronegat", &hit);
+	snprintf(detail, sizeof(detail), "hit %d@%u \"%s\"", (int)hit.note, (unsigned)hit.offset, hit.snippet);
+	check_report("snippet across a block edge", strstr(hit.snippet, "Electronegativity 2.2") != NULL, detail);
+	check_stop();
+}
+
+static void check_pack_shift(uint8_t *field, uint32_t shift) {
+	uint32_t offset;
+	memcpy(&offset, field, 4);
+	offset += shift;
+	memcpy(field, &offset, 4);
+}
+
+  /**
+   *  The shipped pack with its table of contents repeated to notes entries,
+   *  all pointing at the shipped notes; NULL when it cannot be read
+   */
+static uint8_t *check_pack_repeated(uint32_t notes, size_t *pack_size) {
+	FILE *f = fopen("resources/generated/notes.pack", "rb");
+	if (f == NULL) return NULL;
+	fseek(f, 0, SEEK_END);
+	size_t size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	uint8_t *shipped = malloc(size);
+	size_t read = fread(shipped, 1, size, f);
+	fclose(f);
+	uint32_t count;
+	memcpy(&count, shipped + 4, 4);
+	if (read != size || count == 0 || count > notes) {
+		free(shipped);
+		return NULL;
+	}
+
+	// Everything after the table moves down by the entries added
+	uint32_t toc = CHECK_PACK_HEADER_LEN + CHECK_PACK_ENTRY_LEN * count;
+	uint32_t shift = CHECK_PACK_ENTRY_LEN * (notes - count);
+	uint8_t *pack = malloc(size + shift);
+	memcpy(pack, shipped, CHECK_PACK_HEADER_LEN);
+	memcpy(pack + 4, &notes, 4);
+	for (uint32_t i = 0; i < notes; i++) {
+		uint8_t *entry = pack + CHECK_PACK_HEADER_LEN + CHECK_PACK_ENTRY_LEN * i;
+		memcpy(entry, shipped + CHECK_PACK_HEADER_LEN + CHECK_PACK_ENTRY_LEN * (i % count), CHECK_PACK_ENTRY_LEN);
+		memcpy(entry + 24, &i, 4);
+	}
+	memcpy(pack + toc + shift, shipped + toc, size - toc);
+	check_pack_shift(pack + 8, shift);
+	check_pack_shift(pack + 16, shift);
+	for (uint32_t i = 0; i < notes; i++) {
+		uint8_t *entry = pack + CHECK_PACK_HEADER_LEN + CHECK_PACK_ENTRY_LEN * i;
+		check_pack_shift(entry, shift);
+		check_pack_shift(entry + 8, shift);
+	}
+	free(shipped);
+	*pack_size = size + shift;
+	return pack;
+}
+
+  /**
+   *  Scrolling the menu down to its last note and back up builds each row
+   *  once: the row cache holds every note, hundreds of them
+   */
+static void check_menu_rows_cached(void) {
+	char detail[64];
+	size_t pack_size = 0;
+	uint8_t *pack = check_pack_repeated(CHECK_MENU_NOTES, &pack_size);
+	host_reset();
+	host_persist_clear();
+	host_set_resource(RESOURCE_ID_NOTE_PACK, pack, pack_size);
+	uint32_t before = note_meta_misses;
+	init();
+	host_render();
+	uint32_t count = note_count();
+	for (int pass = 0; pass < 2; pass++) {
+		for (uint32_t i = 0; i < count; i++) {
+			uint16_t row = pass ? count - 1 - i : i;
+			menu_layer_set_selected_index(menu_layer, (MenuIndex){ 0, row }, MenuRowAlignCenter, false);
+			host_render();
+		}
+	}
+	uint32_t built = note_meta_misses - before;
+	snprintf(detail, sizeof(detail), "%u notes, %u rows built", (unsigned)count, (unsigned)built);
+	check_report("menu rows built once", pack && count == CHECK_MENU_NOTES && built == count, detail);
+	check_stop();
+	host_set_resource(RESOURCE_ID_NOTE_PACK, NULL, 0);
+	free(pack);
+}
+
+  /**
+   *  Byte of the plain text of the stream check at offset: every chunk
+   *  different, so a chunk at the wrong window offset shows
+   */
+static char check_stream_byte(uint32_t offset) {
+	return 'a' + (offset / NOTE_CHUNK_LEN + offset) % 26;
+}
+
+  /**
+   *  A compressed note of literal runs whose block corrupt is longer than a
+   *  block can be, so reading it fails
+   */
+static uint8_t *check_stream_note(uint32_t size, uint32_t corrupt, size_t *note_size) {
+	uint32_t blocks = (size + NOTE_CHUNK_LEN - 1) / NOTE_CHUNK_LEN;
+	uint32_t header = 12 + 4 * (blocks + 1);
+	uint8_t *note = calloc(1, header + size + size / 128 + blocks + 1 + NOTE_LZ_SCRATCH_LEN);
+	uint8_t *p = note + header;
+
+	memcpy(note, "NZ\1\0", 4);
+	memcpy(note + 4, &size, 4);
+	memcpy(note + 8, &(uint16_t){ NOTE_CHUNK_LEN }, 2);
+	memcpy(note + 10, &(uint16_t){ blocks }, 2);
+	for (uint32_t b = 0; b < blocks; b++) {
+		uint32_t offset = p - note;
+		memcpy(note + 12 + 4 * b, &offset, 4);
+		uint32_t from = b * NOTE_CHUNK_LEN;
+		uint32_t len = (size - from < NOTE_CHUNK_LEN) ? size - from : NOTE_CHUNK_LEN;
+		for (uint32_t i = 0; i < len; i += 128) {
+			uint32_t run = (len - i < 128) ? len - i : 128;
+			*p++ = run - 1;
+			for (uint32_t j = 0; j < run; j++) *p++ = check_stream_byte(from + i + j);
+		}
+		if (b == corrupt) p += NOTE_LZ_SCRATCH_LEN;
+	}
+	uint32_t end = p - note;
+	memcpy(note + 12 + 4 * blocks, &end, 4);
+	*note_size = end;
+	return note;
+}
+
+  /**
+   *  A corrupt block in the middle of a note reads as zeros: the stream
+   *  keeps every other chunk at its offset, sliding down and back up
+   */
+static void check_stream_corrupt_block(void) {
+	char detail[64];
+	static char window[NOTE_WINDOW_LEN];
+	uint32_t size = CHECK_STREAM_CHUNKS * NOTE_CHUNK_LEN - 100;
+	size_t note_size;
+	uint8_t *note = check_stream_note(size, CHECK_STREAM_CORRUPT, &note_size);
+	NoteStream stream = { 0 };
+	host_reset();
+	host_set_resource(RESOURCE_ID_NOTE_PACK, note, note_size);
+	note_stream_attach(&stream, window);
+	note_stream_open(&stream, resource_get_handle(RESOURCE_ID_NOTE_PACK), 0);
+
+	// Every offset down the note then back up, checked where it lands
+	uint32_t wrong = 0, checked = 0;
+	for (int pass = 0; pass < 2; pass++) {
+		for (uint32_t i = 0; i < size; i++) {
+			uint32_t offset = pass ? size - 1 - i : i;
+			note_stream_cover(&stream, offset, offset + 1);
+			if (!note_stream_holds(&stream, offset, offset + 1) || stream.length > NOTE_WINDOW_LEN) {
+				wrong++;
+				continue;
+			}
+			char want = (offset / NOTE_CHUNK_LEN == CHECK_STREAM_CORRUPT) ? 0 : check_stream_byte(offset);
+			if (*note_stream_at(&stream, offset) != want) wrong++;
+			checked++;
+		}
+	}
+	snprintf(detail, sizeof(detail), "%u of %u offsets wrong", (unsigned)wrong, (unsigned)checked);
+	check_report("stream over a corrupt block", wrong == 0 && checked == 2 * size, detail);
+
+	note_stream_close(&stream);
+	host_set_resource(RESOURCE_ID_NOTE_PACK, NULL, 0);
+	free(note);
+}
+
+int main(void) {
+	check_hit_at_start();
+	check_hit_over_saved();
+	check_snippet_across_blocks();
+	check_menu_rows_cached();
+	check_stream_corrupt_block();
+	printf("%s\n", check_failures ? "check: FAILED" : "check: all passed");
+	return check_failures ? 1 : 0;
+}
@@ -0,0 +1,1377 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Host (Linux) stand-in for the Pebble SDK 2 API. Good enough to run
+ *          the sources in src/ unchanged under a driver: a window stack, a layer tree,
+ *          text layout with a fixed-advance font model, a virtual clock for
+ *          app timers and resources read from resources/.
+ *******************************************************************************
+ */
+
+#include "pebble-host.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SCREEN_W 144
+#define SCREEN_H 168
+#define MAX_WINDOWS 8
+#define MAX_TIMERS 32
+// App RAM of a Pebble classic. On the watch the app image takes its share
+// first, so heap_bytes_free reads high here
+#define HOST_HEAP_LEN (24 * 1024)
+
+HostCounters host_counters;
+
+///////////////////////////APP HEAP///////////////////////////
+// What the app allocates, itself or by creating windows, layers and the
+// message buffers, is counted like the watch heap. Blocks keep their size
+// in front, aligned like malloc.
+typedef union {
+	size_t size;
+	long double align_float;
+	long long align_int;
+	void *align_ptr;
+} HostBlock;
+
+static size_t host_heap_used = 0;
+
+void *host_app_malloc(size_t size) {
+	HostBlock *block = malloc(sizeof(HostBlock) + size);
+	// Out of host memory, not of the app heap, which is only counted
+	if (block == NULL) abort();
+	block->size = size;
+	host_heap_used += size;
+	if (host_heap_used > host_counters.heap_peak) host_counters.heap_peak = host_heap_used;
+	return block + 1;
+}
+
+void *host_app_calloc(size_t count, size_t size) {
+	void *data = host_app_malloc(count * size);
+	if (data) memset(data, 0, count * size);
+	return data;
+}
+
+void host_app_free(void *ptr) {
+	if (ptr == NULL) return;
+	HostBlock *block = (HostBlock *)ptr - 1;
+	host_heap_used -= block->size;
+	free(block);
+}
+
+size_t heap_bytes_used(void) {
+	return host_heap_used;
+}
+
+size_t heap_bytes_free(void) {
+	return (host_heap_used < HOST_HEAP_LEN) ? HOST_HEAP_LEN - host_heap_used : 0;
+}
+
+///////////////////////////FONTS///////////////////////////
+struct GFontHost {
+	const char *key;
+	int16_t advance;     // Pixels per character
+	int16_t line_height; // Pixels per line
+};
+
+static struct GFontHost host_fonts[] = {
+	{ FONT_KEY_GOTHIC_14, 6, 16 },
+	{ FONT_KEY_GOTHIC_18, 8, 20 },
+	{ FONT_KEY_GOTHIC_24, 10, 26 },
+	{ FONT_KEY_GOTHIC_28, 12, 30 },
+	{ FONT_KEY_BITHAM_30_BLACK, 16, 32 },
+};
+
+GFont fonts_get_system_font(const char *font_key) {
+	for (size_t i = 0; i < sizeof(host_fonts) / sizeof(host_fonts[0]); i++) {
+		if (strcmp(host_fonts[i].key, font_key) == 0) return &host_fonts[i];
+	}
+	return &host_fonts[0];
+}
+
+  /**
+   *  Word wraps text into width pixels, returns the used height. Walks every
+   *  byte like the firmware layout engine does, so costs scale the same way.
+   */
+static int16_t host_text_layout(const char *text, GFont font, int16_t width, int16_t max_height) {
+	if (text == NULL || *text == '\0') return 0;
+	if (font == NULL) font = &host_fonts[0];
+
+	int32_t lines = 1;
+	int32_t x = 0;
+	int32_t word = 0;
+	const char *p = text;
+	for (; *p; p++) {
+		uint8_t ch = (uint8_t)*p;
+		if (ch == '\n') {
+			lines++;
+			x = 0;
+			word = 0;
+			continue;
+		}
+		if ((ch & 0xC0) == 0x80) continue; // UTF-8 continuation byte
+		x += font->advance;
+		word = (ch == ' ') ? 0 : word + font->advance;
+		if (x > width) {
+			lines++;
+			x = (word < width) ? word : font->advance;
+			word = (word < width) ? word : 0;
+		}
+		if (lines * font->line_height > max_height) break;
+	}
+	host_counters.layout_bytes += p - text;
+
+	int32_t height = lines * font->line_height;
+	return (height > max_height) ? max_height : height;
+}
+
+///////////////////////////GRAPHICS///////////////////////////
+struct GContext {
+	int unused;
+};
+
+static GContext host_ctx;
+
+void graphics_context_set_text_color(GContext *ctx, GColor color) {}
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {}
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {}
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask) {}
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1) {}
+
+void graphics_draw_text(GContext *ctx, const char *text, GFont const font, const GRect box,
+						const GTextOverflowMode overflow_mode, const GTextAlignment alignment,
+						const GTextLayoutCacheRef layout) {
+	host_counters.text_draws++;
+	host_text_layout(text, font, box.size.w, box.size.h);
+}
+
+GSize graphics_text_layout_get_max_used_size(GContext *ctx, const char *text, GFont const font,
+											 const GRect box, const GTextOverflowMode overflow_mode,
+											 const GTextAlignment alignment, GTextLayoutCacheRef layout) {
+	return GSize(box.size.w, host_text_layout(text, font, box.size.w, box.size.h));
+}
+
+///////////////////////////LAYERS///////////////////////////
+typedef enum {
+	LAYER_PLAIN,
+	LAYER_TEXT,
+	LAYER_SCROLL,
+	LAYER_MENU,
+} LayerKind;
+
+struct Layer {
+	LayerKind kind;
+	GRect frame;
+	GRect bounds;
+	bool hidden;
+	Layer *parent;
+	Layer *first_child;
+	Layer *next_sibling;
+	LayerUpdateProc update_proc;
+	void *owner;                 // TextLayer, ScrollLayer or MenuLayer
+	void *data;                  // layer_create_with_data payload
+};
+
+static void host_layer_init(Layer *layer, LayerKind kind, GRect frame, void *owner) {
+	memset(layer, 0, sizeof(*layer));
+	layer->kind = kind;
+	layer->frame = frame;
+	layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+	layer->owner = owner;
+}
+
+Layer *layer_create(GRect frame) {
+	Layer *layer = host_app_malloc(sizeof(Layer));
+	host_layer_init(layer, LAYER_PLAIN, frame, NULL);
+	return layer;
+}
+
+Layer *layer_create_with_data(GRect frame, size_t data_size) {
+	Layer *layer = layer_create(frame);
+	layer->data = host_app_calloc(1, data_size);
+	return layer;
+}
+
+void layer_remove_from_parent(Layer *child) {
+	if (child == NULL || child->parent == NULL) return;
+	Layer **link = &child->parent->first_child;
+	while (*link && *link != child) link = &(*link)->next_sibling;
+	if (*link) *link = child->next_sibling;
+	child->parent = NULL;
+	child->next_sibling = NULL;
+}
+
+void layer_destroy(Layer *layer) {
+	if (layer == NULL) return;
+	layer_remove_from_parent(layer);
+	host_app_free(layer->data);
+	host_app_free(layer);
+}
+
+void *layer_get_data(const Layer *layer) { return layer->data; }
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) { layer->update_proc = update_proc; }
+void layer_mark_dirty(Layer *layer) { host_counters.dirty_marks++; }
+void layer_set_hidden(Layer *layer, bool hidden) { layer->hidden = hidden; }
+
+void layer_add_child(Layer *parent, Layer *child) {
+	layer_remove_from_parent(child);
+	Layer **link = &parent->first_child;
+	while (*link) link = &(*link)->next_sibling;
+	*link = child;
+	child->parent = parent;
+}
+
+void layer_set_frame(Layer *layer, GRect frame) {
+	layer->frame = frame;
+	layer->bounds.size = frame.size;
+}
+
+GRect layer_get_frame(const Layer *layer) { return layer->frame; }
+void layer_set_bounds(Layer *layer, GRect bounds) { layer->bounds = bounds; }
+GRect layer_get_bounds(const Layer *layer) { return layer->bounds; }
+
+///////////////////////////TEXT LAYER///////////////////////////
+struct TextLayer {
+	Layer layer;
+	const char *text;
+	GFont font;
+};
+
+TextLayer *text_layer_create(GRect frame) {
+	TextLayer *text_layer = host_app_calloc(1, sizeof(TextLayer));
+	host_layer_init(&text_layer->layer, LAYER_TEXT, frame, text_layer);
+	text_layer->font = &host_fonts[0];
+	return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+	if (text_layer == NULL) return;
+	layer_remove_from_parent(&text_layer->layer);
+	host_app_free(text_layer);
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) { return &text_layer->layer; }
+void text_layer_set_text(TextLayer *text_layer, const char *text) { text_layer->text = text; }
+const char *text_layer_get_text(TextLayer *text_layer) { return text_layer->text; }
+void text_layer_set_font(TextLayer *text_layer, GFont font) { text_layer->font = font; }
+void text_layer_set_overflow_mode(TextLayer *text_layer, GTextOverflowMode line_mode) {}
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) {}
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {}
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {}
+
+void text_layer_set_size(TextLayer *text_layer, const GSize max_size) {
+	text_layer->layer.frame.size = max_size;
+	text_layer->layer.bounds.size = max_size;
+}
+
+GSize text_layer_get_content_size(TextLayer *text_layer) {
+	GSize size = text_layer->layer.frame.size;
+	return GSize(size.w, host_text_layout(text_layer->text, text_layer->font, size.w, size.h));
+}
+
+///////////////////////////SCROLL LAYER///////////////////////////
+struct ScrollLayer {
+	Layer layer;
+	Layer content;
+	ScrollLayerCallbacks callbacks;
+	void *context;
+};
+
+ScrollLayer *scroll_layer_create(GRect frame) {
+	ScrollLayer *scroll_layer = host_app_calloc(1, sizeof(ScrollLayer));
+	host_layer_init(&scroll_layer->layer, LAYER_SCROLL, frame, scroll_layer);
+	host_layer_init(&scroll_layer->content, LAYER_PLAIN, GRect(0, 0, frame.size.w, frame.size.h), NULL);
+	layer_add_child(&scroll_layer->layer, &scroll_layer->content);
+	scroll_layer->context = scroll_layer;
+	return scroll_layer;
+}
+
+void scroll_layer_destroy(ScrollLayer *scroll_layer) {
+	if (scroll_layer == NULL) return;
+	layer_remove_from_parent(&scroll_layer->layer);
+	host_app_free(scroll_layer);
+}
+
+Layer *scroll_layer_get_layer(const ScrollLayer *scroll_layer) { return (Layer *)&scroll_layer->layer; }
+void scroll_layer_add_child(ScrollLayer *scroll_layer, Layer *child) { layer_add_child(&scroll_layer->content, child); }
+void scroll_layer_set_callbacks(ScrollLayer *scroll_layer, ScrollLayerCallbacks callbacks) { scroll_layer->callbacks = callbacks; }
+void scroll_layer_set_context(ScrollLayer *scroll_layer, void *context) { scroll_layer->context = context; }
+void scroll_layer_set_click_config_onto_window(ScrollLayer *scroll_layer, struct Window *window) {}
+
+GPoint scroll_layer_get_content_offset(ScrollLayer *scroll_layer) { return scroll_layer->content.frame.origin; }
+GSize scroll_layer_get_content_size(const ScrollLayer *scroll_layer) { return scroll_layer->content.frame.size; }
+
+void scroll_layer_set_content_offset(ScrollLayer *scroll_layer, GPoint offset, bool animated) {
+	int16_t min_y = scroll_layer->layer.frame.size.h - scroll_layer->content.frame.size.h;
+	if (min_y > 0) min_y = 0;
+	if (offset.y < min_y) offset.y = min_y;
+	if (offset.y > 0) offset.y = 0;
+	offset.x = 0;
+
+	scroll_layer->content.frame.origin = offset;
+	host_counters.offset_changes++;
+	if (scroll_layer->callbacks.content_offset_changed_handler) {
+		scroll_layer->callbacks.content_offset_changed_handler(scroll_layer, scroll_layer->context);
+	}
+}
+
+void scroll_layer_set_content_size(ScrollLayer *scroll_layer, GSize size) {
+	scroll_layer->content.frame.size = size;
+	scroll_layer->content.bounds.size = size;
+}
+
+///////////////////////////WINDOWS AND CLICKS///////////////////////////
+typedef struct {
+	ClickHandler single;
+	uint16_t repeat_ms;         // Single clicks repeat while held, 0 when not
+	ClickHandler multi;
+	uint8_t multi_min;
+	uint8_t multi_max;
+	uint16_t multi_timeout_ms;  // Wait for one more click, single clicks too
+	ClickHandler long_down;
+	ClickHandler long_up;
+	uint16_t long_delay_ms;
+} HostButton;
+
+struct Window {
+	Layer root;
+	WindowHandlers handlers;
+	ClickConfigProvider click_config_provider;
+	void *click_context;
+	void *user_data;
+	bool loaded;
+	HostButton buttons[NUM_BUTTONS];
+};
+
+static Window *host_stack[MAX_WINDOWS];
+static int host_stack_depth = 0;
+static Window *host_configuring = NULL;
+
+Window *window_create(void) {
+	Window *window = host_app_calloc(1, sizeof(Window));
+	host_layer_init(&window->root, LAYER_PLAIN, GRect(0, 0, SCREEN_W, SCREEN_H), NULL);
+	return window;
+}
+
+void window_destroy(Window *window) {
+	if (window == NULL) return;
+	for (int i = 0; i < host_stack_depth; i++) {
+		if (host_stack[i] == window) host_stack[i] = NULL;
+	}
+	host_app_free(window);
+}
+
+Layer *window_get_root_layer(const Window *window) { return (Layer *)&window->root; }
+void window_set_window_handlers(Window *window, WindowHandlers handlers) { window->handlers = handlers; }
+void window_set_fullscreen(Window *window, bool enabled) {}
+void window_set_user_data(Window *window, void *data) { window->user_data = data; }
+void *window_get_user_data(const Window *window) { return window->user_data; }
+bool window_is_loaded(Window *window) { return window->loaded; }
+
+  /**
+   *  Runs the click config provider, collecting the subscriptions
+   */
+static void host_press_cancel(void);
+
+static void host_configure_clicks(Window *window) {
+	host_press_cancel();
+	memset(window->buttons, 0, sizeof(window->buttons));
+	if (window->click_config_provider == NULL) return;
+	host_configuring = window;
+	window->click_config_provider(window->click_context ? window->click_context : window);
+	host_configuring = NULL;
+}
+
+void window_set_click_config_provider_with_context(Window *window, ClickConfigProvider click_config_provider,
+												   void *context) {
+	window->click_config_provider = click_config_provider;
+	window->click_context = context;
+	if (window->loaded) host_configure_clicks(window);
+}
+
+void window_set_click_config_provider(Window *window, ClickConfigProvider click_config_provider) {
+	window_set_click_config_provider_with_context(window, click_config_provider, NULL);
+}
+
+void window_single_click_subscribe(ButtonId button_id, ClickHandler handler) {
+	host_configuring->buttons[button_id].single = handler;
+}
+
+void window_single_repeating_click_subscribe(ButtonId button_id, uint16_t repeat_interval_ms, ClickHandler handler) {
+	host_configuring->buttons[button_id].single = handler;
+	host_configuring->buttons[button_id].repeat_ms = repeat_interval_ms;
+}
+
+void window_multi_click_subscribe(ButtonId button_id, uint8_t min_clicks, uint8_t max_clicks, uint16_t timeout,
+								  bool last_click_only, ClickHandler handler) {
+	host_configuring->buttons[button_id].multi = handler;
+	host_configuring->buttons[button_id].multi_min = min_clicks;
+	host_configuring->buttons[button_id].multi_max = max_clicks;
+	host_configuring->buttons[button_id].multi_timeout_ms = timeout;
+}
+
+void window_long_click_subscribe(ButtonId button_id, uint16_t delay_ms, ClickHandler down_handler, ClickHandler up_handler) {
+	host_configuring->buttons[button_id].long_down = down_handler;
+	host_configuring->buttons[button_id].long_up = up_handler;
+	host_configuring->buttons[button_id].long_delay_ms = delay_ms;
+}
+
+static ButtonId host_clicked_button;
+static uint8_t host_clicked_count;
+
+ButtonId click_recognizer_get_button_id(ClickRecognizerRef recognizer) { return host_clicked_button; }
+uint8_t click_number_of_clicks_counted(ClickRecognizerRef recognizer) { return host_clicked_count; }
+
+Window *window_stack_get_top_window(void) {
+	return host_stack_depth > 0 ? host_stack[host_stack_depth - 1] : NULL;
+}
+
+bool window_stack_contains_window(Window *window) {
+	for (int i = 0; i < host_stack_depth; i++) {
+		if (host_stack[i] == window) return true;
+	}
+	return false;
+}
+
+void window_stack_push(Window *window, bool animated) {
+	if (host_stack_depth == MAX_WINDOWS) return;
+	Window *below = window_stack_get_top_window();
+	if (below && below->handlers.disappear) below->handlers.disappear(below);
+
+	host_stack[host_stack_depth++] = window;
+	if (!window->loaded) {
+		window->loaded = true;
+		if (window->handlers.load) window->handlers.load(window);
+	}
+	host_configure_clicks(window);
+	if (window->handlers.appear) window->handlers.appear(window);
+}
+
+  /**
+   *  Takes a window off the stack; the unload handler may destroy it
+   */
+static void host_window_remove(int index) {
+	Window *window = host_stack[index];
+	for (int i = index; i < host_stack_depth - 1; i++) host_stack[i] = host_stack[i + 1];
+	host_stack_depth--;
+
+	WindowHandlers handlers = window->handlers;
+	if (handlers.disappear) handlers.disappear(window);
+	window->loaded = false;
+	if (handlers.unload) handlers.unload(window);
+
+	Window *top = window_stack_get_top_window();
+	if (top && index == host_stack_depth) {
+		host_configure_clicks(top);
+		if (top->handlers.appear) top->handlers.appear(top);
+	}
+}
+
+Window *window_stack_pop(bool animated) {
+	Window *top = window_stack_get_top_window();
+	if (top) host_window_remove(host_stack_depth - 1);
+	return top;
+}
+
+bool window_stack_remove(Window *window, bool animated) {
+	for (int i = 0; i < host_stack_depth; i++) {
+		if (host_stack[i] == window) {
+			host_window_remove(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////MENU LAYER///////////////////////////
+struct MenuLayer {
+	Layer layer;
+	MenuLayerCallbacks callbacks;
+	void *context;
+	MenuIndex selected;
+	int16_t scroll_y;
+};
+
+MenuLayer *menu_layer_create(GRect frame) {
+	MenuLayer *menu_layer = host_app_calloc(1, sizeof(MenuLayer));
+	host_layer_init(&menu_layer->layer, LAYER_MENU, frame, menu_layer);
+	return menu_layer;
+}
+
+void menu_layer_destroy(MenuLayer *menu_layer) {
+	if (menu_layer == NULL) return;
+	layer_remove_from_parent(&menu_layer->layer);
+	host_app_free(menu_layer);
+}
+
+Layer *menu_layer_get_layer(const MenuLayer *menu_layer) { return (Layer *)&menu_layer->layer; }
+void menu_layer_reload_data(MenuLayer *menu_layer) { layer_mark_dirty(&menu_layer->layer); }
+MenuIndex menu_layer_get_selected_index(const MenuLayer *menu_layer) { return menu_layer->selected; }
+
+void menu_layer_set_callbacks(MenuLayer *menu_layer, void *callback_context, MenuLayerCallbacks callbacks) {
+	menu_layer->callbacks = callbacks;
+	menu_layer->context = callback_context;
+}
+
+static uint16_t host_menu_sections(MenuLayer *menu) {
+	return menu->callbacks.get_num_sections ? menu->callbacks.get_num_sections(menu, menu->context) : 1;
+}
+
+static uint16_t host_menu_rows(MenuLayer *menu, uint16_t section) {
+	return menu->callbacks.get_num_rows(menu, section, menu->context);
+}
+
+static int16_t host_menu_header_height(MenuLayer *menu, uint16_t section) {
+	return menu->callbacks.get_header_height ? menu->callbacks.get_header_height(menu, section, menu->context) : 0;
+}
+
+static int16_t host_menu_cell_height(MenuLayer *menu, MenuIndex *index) {
+	return menu->callbacks.get_cell_height ? menu->callbacks.get_cell_height(menu, index, menu->context)
+										   : MENU_CELL_BASIC_CELL_HEIGHT;
+}
+
+  /**
+   *  Walks the cells top to bottom; draws the ones inside [top, bottom)
+   *  and returns the y position of the selected cell
+   */
+static int16_t host_menu_walk(MenuLayer *menu, int16_t top, int16_t bottom, bool draw) {
+	int16_t y = 0;
+	int16_t selected_y = 0;
+	Layer cell;
+	host_layer_init(&cell, LAYER_PLAIN, GRect(0, 0, menu->layer.frame.size.w, 0), NULL);
+
+	for (uint16_t section = 0; section < host_menu_sections(menu); section++) {
+		int16_t h = host_menu_header_height(menu, section);
+		if (draw && h > 0 && y + h > top && y < bottom && menu->callbacks.draw_header) {
+			cell.frame.size.h = cell.bounds.size.h = h;
+			menu->callbacks.draw_header(&host_ctx, &cell, section, menu->context);
+		}
+		y += h;
+		for (uint16_t row = 0; row < host_menu_rows(menu, section); row++) {
+			MenuIndex index = MenuIndex(section, row);
+			h = host_menu_cell_height(menu, &index);
+			if (section == menu->selected.section && row == menu->selected.row) selected_y = y;
+			if (draw && y + h > top && y < bottom) {
+				cell.frame.size.h = cell.bounds.size.h = h;
+				host_counters.menu_rows_drawn++;
+				menu->callbacks.draw_row(&host_ctx, &cell, &index, menu->context);
+			}
+			y += h;
+		}
+	}
+	return selected_y;
+}
+
+void menu_layer_set_selected_index(MenuLayer *menu_layer, MenuIndex index, MenuRowAlign scroll_align, bool animated) {
+	MenuIndex old = menu_layer->selected;
+	menu_layer->selected = index;
+
+	int16_t y = host_menu_walk(menu_layer, 0, 0, false);
+	if (y < menu_layer->scroll_y) menu_layer->scroll_y = y;
+	if (y + MENU_CELL_BASIC_CELL_HEIGHT > menu_layer->scroll_y + menu_layer->layer.frame.size.h) {
+		menu_layer->scroll_y = y + MENU_CELL_BASIC_CELL_HEIGHT - menu_layer->layer.frame.size.h;
+	}
+	if (menu_layer->callbacks.selection_changed) {
+		menu_layer->callbacks.selection_changed(menu_layer, index, old, menu_layer->context);
+	}
+}
+
+static void host_menu_move(MenuLayer *menu, int step) {
+	MenuIndex index = menu->selected;
+	int row = index.row + step;
+	if (row < 0) {
+		if (index.section == 0) return;
+		index.section--;
+		row = host_menu_rows(menu, index.section) - 1;
+	}
+	else if (row >= host_menu_rows(menu, index.section)) {
+		if (index.section + 1 >= host_menu_sections(menu)) return;
+		index.section++;
+		row = 0;
+	}
+	index.row = row;
+	menu_layer_set_selected_index(menu, index, MenuRowAlignCenter, true);
+}
+
+static MenuLayer *host_menu_of(void *context) {
+	Window *window = context;
+	return window->user_data;
+}
+
+static void host_menu_up(ClickRecognizerRef recognizer, void *context) { host_menu_move(host_menu_of(context), -1); }
+static void host_menu_down(ClickRecognizerRef recognizer, void *context) { host_menu_move(host_menu_of(context), 1); }
+
+static void host_menu_select(ClickRecognizerRef recognizer, void *context) {
+	MenuLayer *menu = host_menu_of(context);
+	if (menu->callbacks.select_click) menu->callbacks.select_click(menu, &menu->selected, menu->context);
+}
+
+static void host_menu_select_long(ClickRecognizerRef recognizer, void *context) {
+	MenuLayer *menu = host_menu_of(context);
+	if (menu->callbacks.select_long_click) menu->callbacks.select_long_click(menu, &menu->selected, menu->context);
+}
+
+static void host_menu_click_config(void *context) {
+	window_single_click_subscribe(BUTTON_ID_UP, host_menu_up);
+	window_single_click_subscribe(BUTTON_ID_DOWN, host_menu_down);
+	window_single_click_subscribe(BUTTON_ID_SELECT, host_menu_select);
+	window_long_click_subscribe(BUTTON_ID_SELECT, 500, host_menu_select_long, NULL);
+}
+
+void menu_layer_set_click_config_onto_window(MenuLayer *menu_layer, struct Window *window) {
+	window->user_data = menu_layer;
+	window_set_click_config_provider_with_context(window, host_menu_click_config, window);
+}
+
+void menu_cell_basic_draw(GContext *ctx, const Layer *cell_layer, const char *title, const char *subtitle, void *icon) {
+	graphics_draw_text(ctx, title, fonts_get_system_font(FONT_KEY_GOTHIC_24),
+					   GRect(0, 0, cell_layer->frame.size.w, 28), GTextOverflowModeTrailingEllipsis,
+					   GTextAlignmentLeft, NULL);
+	if (subtitle) {
+		graphics_draw_text(ctx, subtitle, fonts_get_system_font(FONT_KEY_GOTHIC_18),
+						   GRect(0, 26, cell_layer->frame.size.w, 20), GTextOverflowModeTrailingEllipsis,
+						   GTextAlignmentLeft, NULL);
+	}
+}
+
+void menu_cell_title_draw(GContext *ctx, const Layer *cell_layer, const char *title) {
+	menu_cell_basic_draw(ctx, cell_layer, title, NULL, NULL);
+}
+
+void menu_cell_basic_header_draw(GContext *ctx, const Layer *cell_layer, const char *title) {
+	graphics_draw_text(ctx, title, fonts_get_system_font(FONT_KEY_GOTHIC_14),
+					   GRect(0, 0, cell_layer->frame.size.w, 16), GTextOverflowModeTrailingEllipsis,
+					   GTextAlignmentLeft, NULL);
+}
+
+///////////////////////////RENDERING///////////////////////////
+  /**
+   *  Draws a layer and its children; top is the screen y of the layer
+   */
+static void host_render_layer(Layer *layer, int16_t top) {
+	if (layer->hidden) return;
+	top += layer->frame.origin.y;
+	if (top >= SCREEN_H || top + layer->frame.size.h <= 0) return;
+
+	switch (layer->kind) {
+		case LAYER_TEXT: {
+			TextLayer *text_layer = layer->owner;
+			host_counters.text_draws++;
+			host_text_layout(text_layer->text, text_layer->font, layer->frame.size.w, layer->frame.size.h);
+			break;
+		}
+		case LAYER_MENU: {
+			MenuLayer *menu = layer->owner;
+			host_menu_walk(menu, menu->scroll_y, menu->scroll_y + layer->frame.size.h, true);
+			break;
+		}
+		default:
+			if (layer->update_proc) layer->update_proc(layer, &host_ctx);
+			break;
+	}
+	for (Layer *child = layer->first_child; child; child = child->next_sibling) {
+		host_render_layer(child, top);
+	}
+}
+
+void host_render(void) {
+	Window *top = window_stack_get_top_window();
+	if (top == NULL) return;
+	host_counters.redraws++;
+	host_render_layer(&top->root, 0);
+}
+
+///////////////////////////BUTTONS///////////////////////////
+static HostButton *host_button(ButtonId button) {
+	Window *top = window_stack_get_top_window();
+	return top ? &top->buttons[button] : NULL;
+}
+
+static void *host_click_context(void) {
+	Window *top = window_stack_get_top_window();
+	return top->click_context ? top->click_context : top;
+}
+
+void host_single_click(ButtonId button) {
+	HostButton *b = host_button(button);
+	host_clicked_button = button;
+	host_clicked_count = 1;
+	if (b && b->single) {
+		b->single(NULL, host_click_context());
+	}
+	else if (button == BUTTON_ID_BACK) {
+		window_stack_pop(true);
+	}
+}
+
+void host_multi_click(ButtonId button, uint8_t clicks) {
+	HostButton *b = host_button(button);
+	host_clicked_button = button;
+	host_clicked_count = clicks;
+	if (b && b->multi && clicks >= b->multi_min) b->multi(NULL, host_click_context());
+}
+
+void host_long_click_down(ButtonId button) {
+	HostButton *b = host_button(button);
+	host_clicked_button = button;
+	host_clicked_count = 1;
+	if (b && b->long_down) b->long_down(NULL, host_click_context());
+}
+
+void host_long_click_up(ButtonId button) {
+	HostButton *b = host_button(button);
+	host_clicked_button = button;
+	if (b && b->long_up) b->long_up(NULL, host_click_context());
+}
+
+///////////////////////////BUTTON PRESSES///////////////////////////
+// Raw presses and releases, recognized into clicks on the virtual clock
+// like the firmware does: a single click fires on release, or on press and
+// then every repeat interval when repeating; a button with multi clicks
+// holds its single click back until the multi click timeout passes with no
+// other press; a long click fires once held for its delay, and then the
+// release fires its up handler instead of a single click.
+typedef enum {
+	HOST_DUE_NONE = 0,
+	HOST_DUE_LONG,
+	HOST_DUE_REPEAT,
+	HOST_DUE_MULTI,
+} HostDue;
+
+typedef struct {
+	bool down;
+	bool long_fired;
+	uint8_t clicks;             // Clicks counted toward a multi click
+	HostDue due_kind;
+	uint32_t due;
+} HostPress;
+
+static HostPress host_presses[NUM_BUTTONS];
+static FILE *host_trace = NULL;
+static const char *host_button_names[NUM_BUTTONS] = { "back", "up", "select", "down" };
+
+void host_trace_record(FILE *out) {
+	host_trace = out;
+}
+
+static void host_trace_line(const char *event, ButtonId button, bool comment) {
+	if (host_trace == NULL) return;
+	fprintf(host_trace, "%s%u %s %s\n", comment ? "# " : "", (unsigned)host_now(), event, host_button_names[button]);
+}
+
+const char *host_button_name(ButtonId button) {
+	return (button < NUM_BUTTONS) ? host_button_names[button] : NULL;
+}
+
+  /**
+   *  Forgets presses in progress: the top window changed
+   */
+static void host_press_cancel(void) {
+	memset(host_presses, 0, sizeof(host_presses));
+}
+
+static void host_press_single(ButtonId button) {
+	HostButton *b = host_button(button);
+	host_trace_line("single", button, true);
+	host_clicked_button = button;
+	host_clicked_count = 1;
+	if (b && b->single) {
+		b->single(NULL, host_click_context());
+	}
+	else if (button == BUTTON_ID_BACK) {
+		window_stack_pop(true);
+	}
+}
+
+static void host_press_multi(ButtonId button, uint8_t clicks) {
+	HostButton *b = host_button(button);
+	host_trace_line("multi", button, true);
+	host_clicked_button = button;
+	host_clicked_count = clicks;
+	b->multi(NULL, host_click_context());
+}
+
+  /**
+   *  Clicks counted when the multi click timeout passed
+   */
+static void host_press_clicks(ButtonId button, uint8_t clicks) {
+	HostButton *b = host_button(button);
+	if (b && b->multi && clicks >= b->multi_min) {
+		host_press_multi(button, clicks);
+	}
+	else if (clicks > 0) {
+		host_press_single(button);
+	}
+}
+
+void host_button_down(ButtonId button) {
+	HostButton *b = host_button(button);
+	HostPress *p = &host_presses[button];
+	host_trace_line("down", button, false);
+	if (b == NULL || p->down) return;
+	
+	p->down = true;
+	p->long_fired = false;
+	p->due_kind = HOST_DUE_NONE;
+	if (b->repeat_ms) {
+		host_press_single(button);
+		p->due_kind = HOST_DUE_REPEAT;
+		p->due = host_now() + b->repeat_ms;
+	}
+	else if (b->long_down || b->long_up) {
+		p->due_kind = HOST_DUE_LONG;
+		p->due = host_now() + b->long_delay_ms;
+	}
+}
+
+void host_button_up(ButtonId button) {
+	HostButton *b = host_button(button);
+	HostPress *p = &host_presses[button];
+	host_trace_line("up", button, false);
+	if (b == NULL || !p->down) return;
+	
+	p->down = false;
+	p->due_kind = HOST_DUE_NONE;
+	if (p->long_fired) {
+		host_trace_line("long_up", button, true);
+		host_clicked_button = button;
+		if (b->long_up) b->long_up(NULL, host_click_context());
+		return;
+	}
+	if (b->repeat_ms) return;
+	if (b->multi) {
+		if (++p->clicks >= b->multi_max) {
+			uint8_t clicks = p->clicks;
+			p->clicks = 0;
+			host_press_clicks(button, clicks);
+			return;
+		}
+		p->due_kind = HOST_DUE_MULTI;
+		p->due = host_now() + b->multi_timeout_ms;
+		return;
+	}
+	host_press_single(button);
+}
+
+  /**
+   *  Earliest recognizer deadline, or UINT32_MAX when none
+   */
+static uint32_t host_press_next(ButtonId *button) {
+	uint32_t next = UINT32_MAX;
+	for (int i = 0; i < NUM_BUTTONS; i++) {
+		if (host_presses[i].due_kind != HOST_DUE_NONE && host_presses[i].due < next) {
+			next = host_presses[i].due;
+			*button = i;
+		}
+	}
+	return next;
+}
+
+  /**
+   *  A recognizer deadline passed: the long click, a repeat or the end of
+   *  a multi click
+   */
+static void host_press_due(ButtonId button) {
+	HostButton *b = host_button(button);
+	HostPress *p = &host_presses[button];
+	HostDue kind = p->due_kind;
+	p->due_kind = HOST_DUE_NONE;
+	
+	switch (kind) {
+		case HOST_DUE_LONG:
+			p->long_fired = true;
+			p->clicks = 0;
+			host_trace_line("long", button, true);
+			host_clicked_button = button;
+			host_clicked_count = 1;
+			if (b->long_down) b->long_down(NULL, host_click_context());
+			break;
+		case HOST_DUE_REPEAT:
+			p->due_kind = HOST_DUE_REPEAT;
+			p->due = host_now() + b->repeat_ms;
+			host_press_single(button);
+			break;
+		case HOST_DUE_MULTI: {
+			uint8_t clicks = p->clicks;
+			p->clicks = 0;
+			host_press_clicks(button, clicks);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+///////////////////////////TIMERS AND TIME///////////////////////////
+struct AppTimer {
+	bool used;
+	uint32_t due;
+	uint32_t seq;
+	AppTimerCallback callback;
+	void *data;
+};
+
+static AppTimer host_timers[MAX_TIMERS];
+static uint32_t host_clock = 0;
+static uint32_t host_timer_seq = 0;
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+	for (int i = 0; i < MAX_TIMERS; i++) {
+		if (!host_timers[i].used) {
+			host_timers[i] = (AppTimer){ true, host_clock + timeout_ms, host_timer_seq++, callback, callback_data };
+			return &host_timers[i];
+		}
+	}
+	fprintf(stderr, "host: out of app timers\n");
+	abort();
+}
+
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms) {
+	if (timer_handle == NULL || !timer_handle->used) return false;
+	timer_handle->due = host_clock + new_timeout_ms;
+	return true;
+}
+
+void app_timer_cancel(AppTimer *timer_handle) {
+	if (timer_handle) timer_handle->used = false;
+}
+
+uint32_t host_pending_timers(void) {
+	uint32_t pending = 0;
+	for (int i = 0; i < MAX_TIMERS; i++) pending += host_timers[i].used;
+	return pending;
+}
+
+uint32_t host_now(void) {
+	return host_clock;
+}
+
+  /**
+   *  Moves the virtual clock forward, firing due timers in order
+   */
+void host_advance(uint32_t ms) {
+	uint32_t until = host_clock + ms;
+	for (;;) {
+		AppTimer *next = NULL;
+		for (int i = 0; i < MAX_TIMERS; i++) {
+			AppTimer *t = &host_timers[i];
+			if (t->used && t->due <= until &&
+				(next == NULL || t->due < next->due || (t->due == next->due && t->seq < next->seq))) {
+				next = t;
+			}
+		}
+		// Button recognizers run in the firmware, they wake no app timer
+		ButtonId button = BUTTON_ID_BACK;
+		uint32_t press = host_press_next(&button);
+		if (press <= until && (next == NULL || press < next->due)) {
+			if (press > host_clock) host_clock = press;
+			host_press_due(button);
+			continue;
+		}
+		if (next == NULL) break;
+		if (next->due > host_clock) host_clock = next->due;
+		next->used = false;
+		host_counters.timer_wakeups++;
+		next->callback(next->data);
+	}
+	host_clock = until;
+}
+
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms) {
+	if (t_utc) *t_utc = host_clock / 1000;
+	if (out_ms) *out_ms = host_clock % 1000;
+	return host_clock % 1000;
+}
+
+static TickHandler host_tick_handler;
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) { host_tick_handler = handler; }
+void tick_timer_service_unsubscribe(void) { host_tick_handler = NULL; }
+
+///////////////////////////RESOURCES///////////////////////////
+struct HostResource {
+	const char *file;
+	uint8_t *data;
+	size_t size;
+	bool loaded;
+	bool owned;
+};
+
+static struct HostResource host_resources[HOST_NUM_RESOURCES] = {
+	[RESOURCE_ID_INVALID] = { NULL, NULL, 0, true, false },
+#define X(name, file) [RESOURCE_ID_##name] = { file, NULL, 0, false, false },
+	HOST_RESOURCES
+#undef X
+};
+
+static const char *host_resource_dir = "resources";
+
+void host_set_resource_dir(const char *dir) {
+	host_resource_dir = dir;
+}
+
+  /**
+   *  Serves a resource from memory; NULL data goes back to the file
+   */
+void host_set_resource(uint32_t resource_id, const uint8_t *data, size_t size) {
+	struct HostResource *res = &host_resources[resource_id];
+	if (res->owned) free(res->data);
+	res->data = (uint8_t *)data;
+	res->size = size;
+	res->loaded = (data != NULL);
+	res->owned = false;
+}
+
+  /**
+   *  Reads the resource file the first time it is used
+   */
+static void host_resource_fetch(struct HostResource *res) {
+	if (res->loaded) return;
+	res->loaded = true;
+
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s", host_resource_dir, res->file);
+	FILE *f = fopen(path, "rb");
+	if (f == NULL) {
+		fprintf(stderr, "host: missing resource %s\n", path);
+		return;
+	}
+	fseek(f, 0, SEEK_END);
+	res->size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	res->data = malloc(res->size ? res->size : 1);
+	res->size = fread(res->data, 1, res->size, f);
+	res->owned = true;
+	fclose(f);
+}
+
+ResHandle resource_get_handle(uint32_t resource_id) {
+	if (resource_id >= HOST_NUM_RESOURCES) return NULL;
+	host_resource_fetch(&host_resources[resource_id]);
+	return &host_resources[resource_id];
+}
+
+size_t resource_size(ResHandle h) {
+	return h ? h->size : 0;
+}
+
+size_t resource_load_byte_range(ResHandle h, uint32_t start_offset, uint8_t *buffer, size_t num_bytes) {
+	host_counters.resource_reads++;
+	if (h == NULL || start_offset >= h->size) return 0;
+	if (num_bytes > h->size - start_offset) num_bytes = h->size - start_offset;
+	memcpy(buffer, h->data + start_offset, num_bytes);
+	host_counters.resource_bytes += num_bytes;
+	return num_bytes;
+}
+
+size_t resource_load(ResHandle h, uint8_t *buffer, size_t max_length) {
+	return resource_load_byte_range(h, 0, buffer, max_length);
+}
+
+///////////////////////////PERSISTENT STORAGE///////////////////////////
+// Kept across host_reset like the watch keeps it across launches, only
+// host_persist_clear wipes it
+#define HOST_PERSIST_KEYS 64
+
+typedef struct {
+	bool used;
+	uint32_t key;
+	size_t size;
+	uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} HostPersist;
+
+static HostPersist host_persist[HOST_PERSIST_KEYS];
+
+static HostPersist *host_persist_find(uint32_t key) {
+	for (int i = 0; i < HOST_PERSIST_KEYS; i++) {
+		if (host_persist[i].used && host_persist[i].key == key) return &host_persist[i];
+	}
+	return NULL;
+}
+
+void host_persist_clear(void) {
+	memset(host_persist, 0, sizeof(host_persist));
+}
+
+bool persist_exists(const uint32_t key) {
+	return host_persist_find(key) != NULL;
+}
+
+int persist_get_size(const uint32_t key) {
+	HostPersist *p = host_persist_find(key);
+	return p ? (int)p->size : E_DOES_NOT_EXIST;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size) {
+	host_counters.persist_reads++;
+	HostPersist *p = host_persist_find(key);
+	if (p == NULL) return E_DOES_NOT_EXIST;
+	size_t size = (buffer_size < p->size) ? buffer_size : p->size;
+	memcpy(buffer, p->data, size);
+	return size;
+}
+
+status_t persist_write_data(const uint32_t key, const void *data, const size_t size) {
+	host_counters.persist_writes++;
+	HostPersist *p = host_persist_find(key);
+	for (int i = 0; p == NULL && i < HOST_PERSIST_KEYS; i++) {
+		if (!host_persist[i].used) p = &host_persist[i];
+	}
+	if (p == NULL) return E_OUT_OF_STORAGE;
+	if (size > PERSIST_DATA_MAX_LENGTH) return E_INVALID_ARGUMENT;
+	p->used = true;
+	p->key = key;
+	p->size = size;
+	memcpy(p->data, data, size);
+	return size;
+}
+
+status_t persist_delete(const uint32_t key) {
+	host_counters.persist_writes++;
+	HostPersist *p = host_persist_find(key);
+	if (p == NULL) return E_DOES_NOT_EXIST;
+	p->used = false;
+	return S_SUCCESS;
+}
+
+///////////////////////////DICTIONARY///////////////////////////
+#define HOST_TUPLE_HEADER_LEN 7
+
+static Tuple *host_tuple_next(Tuple *tuple) {
+	return (Tuple *)((uint8_t *)tuple + HOST_TUPLE_HEADER_LEN + tuple->length);
+}
+
+Tuple *dict_read_begin_from_buffer(DictionaryIterator *iter, const uint8_t * const buffer, const uint16_t size) {
+	iter->dictionary = (Dictionary *)buffer;
+	iter->end = buffer + size;
+	iter->cursor = iter->dictionary->head;
+	return dict_read_first(iter);
+}
+
+Tuple *dict_read_first(DictionaryIterator *iter) {
+	iter->cursor = iter->dictionary->head;
+	if (iter->dictionary->count == 0) return NULL;
+	return iter->cursor;
+}
+
+Tuple *dict_read_next(DictionaryIterator *iter) {
+	Tuple *next = host_tuple_next(iter->cursor);
+	if ((uint8_t *)next + HOST_TUPLE_HEADER_LEN > (uint8_t *)iter->end) return NULL;
+	iter->cursor = next;
+	return next;
+}
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+	Tuple *tuple = iter->dictionary->head;
+	for (uint8_t i = 0; i < iter->dictionary->count; i++) {
+		if ((uint8_t *)tuple + HOST_TUPLE_HEADER_LEN > (uint8_t *)iter->end) return NULL;
+		if (tuple->key == key) return tuple;
+		tuple = host_tuple_next(tuple);
+	}
+	return NULL;
+}
+
+DictionaryResult dict_write_begin(DictionaryIterator *iter, uint8_t * const buffer, const uint16_t size) {
+	if (buffer == NULL || size < 1) return DICT_INVALID_ARGS;
+	iter->dictionary = (Dictionary *)buffer;
+	iter->dictionary->count = 0;
+	iter->end = buffer + size;
+	iter->cursor = iter->dictionary->head;
+	return DICT_OK;
+}
+
+static DictionaryResult host_dict_write(DictionaryIterator *iter, uint32_t key, TupleType type, const void *data, uint16_t size) {
+	if ((uint8_t *)iter->cursor + HOST_TUPLE_HEADER_LEN + size > (uint8_t *)iter->end) return DICT_NOT_ENOUGH_STORAGE;
+	iter->cursor->key = key;
+	iter->cursor->type = type;
+	iter->cursor->length = size;
+	memcpy(iter->cursor->value, data, size);
+	iter->cursor = host_tuple_next(iter->cursor);
+	iter->dictionary->count++;
+	return DICT_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t * const data, const uint16_t size) {
+	return host_dict_write(iter, key, TUPLE_BYTE_ARRAY, data, size);
+}
+
+DictionaryResult dict_write_uint8(DictionaryIterator *iter, const uint32_t key, const uint8_t value) {
+	return host_dict_write(iter, key, TUPLE_UINT, &value, 1);
+}
+
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, const uint32_t key, const uint16_t value) {
+	return host_dict_write(iter, key, TUPLE_UINT, &value, 2);
+}
+
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, const uint32_t key, const uint32_t value) {
+	return host_dict_write(iter, key, TUPLE_UINT, &value, 4);
+}
+
+uint32_t dict_write_end(DictionaryIterator *iter) {
+	iter->end = iter->cursor;
+	return (uint8_t *)iter->cursor - (uint8_t *)iter->dictionary;
+}
+
+///////////////////////////APP MESSAGE///////////////////////////
+// One outbox message in flight at a time, like the watch. The phone side
+// is whatever host_app_message_connect hooked up, see host/phone-sim.c
+static AppMessageInboxReceived host_inbox_received;
+static AppMessageInboxDropped host_inbox_dropped;
+static AppMessageOutboxSent host_outbox_sent;
+static AppMessageOutboxFailed host_outbox_failed;
+static HostPhoneReceive host_phone;
+static uint8_t *host_inbox, *host_outbox;
+static uint32_t host_inbox_size, host_outbox_size;
+static DictionaryIterator host_outbox_iter;
+static bool host_outbox_busy;
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+	host_app_free(host_inbox);
+	host_app_free(host_outbox);
+	host_inbox = host_app_malloc(size_inbound);
+	host_outbox = host_app_malloc(size_outbound);
+	host_inbox_size = size_inbound;
+	host_outbox_size = size_outbound;
+	host_outbox_busy = false;
+	return APP_MSG_OK;
+}
+
+void app_message_deregister_callbacks(void) {
+	host_inbox_received = NULL;
+	host_inbox_dropped = NULL;
+	host_outbox_sent = NULL;
+	host_outbox_failed = NULL;
+	host_app_free(host_inbox);
+	host_app_free(host_outbox);
+	host_inbox = host_outbox = NULL;
+	host_inbox_size = host_outbox_size = 0;
+}
+
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+	AppMessageInboxReceived old = host_inbox_received;
+	host_inbox_received = received_callback;
+	return old;
+}
+
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback) {
+	AppMessageInboxDropped old = host_inbox_dropped;
+	host_inbox_dropped = dropped_callback;
+	return old;
+}
+
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback) {
+	AppMessageOutboxSent old = host_outbox_sent;
+	host_outbox_sent = sent_callback;
+	return old;
+}
+
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback) {
+	AppMessageOutboxFailed old = host_outbox_failed;
+	host_outbox_failed = failed_callback;
+	return old;
+}
+
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator) {
+	if (host_outbox == NULL) return APP_MSG_INVALID_ARGS;
+	if (host_outbox_busy) return APP_MSG_BUSY;
+	dict_write_begin(&host_outbox_iter, host_outbox, host_outbox_size);
+	*iterator = &host_outbox_iter;
+	return APP_MSG_OK;
+}
+
+AppMessageResult app_message_outbox_send(void) {
+	if (host_outbox == NULL) return APP_MSG_INVALID_ARGS;
+	if (host_outbox_busy) return APP_MSG_BUSY;
+	uint32_t size = dict_write_end(&host_outbox_iter);
+	host_counters.messages_out++;
+	if (host_phone == NULL) {
+		if (host_outbox_failed) host_outbox_failed(&host_outbox_iter, APP_MSG_NOT_CONNECTED, NULL);
+		return APP_MSG_OK;
+	}
+	host_outbox_busy = true;
+	host_phone(host_outbox, size);
+	return APP_MSG_OK;
+}
+
+void host_app_message_connect(HostPhoneReceive receive) {
+	host_phone = receive;
+	host_outbox_busy = false;
+}
+
+  /**
+   *  The phone acked (or gave up on) the message in the outbox
+   */
+void host_app_message_sent(AppMessageResult result) {
+	if (!host_outbox_busy) return;
+	host_outbox_busy = false;
+	if (result == APP_MSG_OK) {
+		if (host_outbox_sent) host_outbox_sent(&host_outbox_iter, NULL);
+	}
+	else if (host_outbox_failed) {
+		host_outbox_failed(&host_outbox_iter, result, NULL);
+	}
+}
+
+  /**
+   *  A phone message reaches the inbox: handled right away, the result is
+   *  the ack (APP_MSG_OK) or nack the phone gets back
+   */
+AppMessageResult host_app_message_deliver(const uint8_t *data, size_t size) {
+	if (host_inbox == NULL || host_inbox_received == NULL) return APP_MSG_NOT_CONNECTED;
+	if (size > host_inbox_size) {
+		if (host_inbox_dropped) host_inbox_dropped(APP_MSG_BUFFER_OVERFLOW, NULL);
+		return APP_MSG_BUFFER_OVERFLOW;
+	}
+	DictionaryIterator iter;
+	memcpy(host_inbox, data, size);
+	dict_read_begin_from_buffer(&iter, host_inbox, size);
+	host_counters.messages_in++;
+	host_inbox_received(&iter, NULL);
+	return APP_MSG_OK;
+}
+
+///////////////////////////VIBES///////////////////////////
+void vibes_short_pulse(void) {
+	host_counters.vibes++;
+}
+
+///////////////////////////LOGGING AND APP///////////////////////////
+static uint8_t host_log_level = 0;
+
+void host_set_log_level(uint8_t level) {
+	host_log_level = level;
+}
+
+  /**
+   *  Formats every message like the firmware does; prints only up to
+   *  host_log_level
+   */
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+	char line[256];
+	va_list va;
+	va_start(va, fmt);
+	vsnprintf(line, sizeof(line), fmt, va);
+	va_end(va);
+	host_counters.log_calls++;
+	if (log_level <= host_log_level) fprintf(stderr, "[%d] %s:%d %s\n", log_level, src_filename, src_line_number, line);
+}
+
+void app_event_loop(void) {}
+
+void host_reset_counters(void) {
+	memset(&host_counters, 0, sizeof(host_counters));
+	host_counters.heap_peak = host_heap_used;
+}
+
+  /**
+   *  Drops every window and timer left behind by a previous run
+   */
+void host_reset(void) {
+	while (host_stack_depth > 0) window_stack_pop(false);
+	memset(host_timers, 0, sizeof(host_timers));
+	host_press_cancel();
+	host_clock = 0;
+	host_tick_handler = NULL;
+	host_app_message_connect(NULL);
+	host_reset_counters();
+}
@@ -0,0 +1,77 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Controls of the host stand-in, used by drivers to poke the app
+ *          from outside: virtual clock, buttons, rendering, resources
+ *******************************************************************************
+ */
+
+#ifndef __PEBBLE_HOST_CONTROL__
+#define __PEBBLE_HOST_CONTROL__
+
+// Drivers keep the C library malloc, only the app allocates from its heap
+#define HOST_DRIVER
+#include "pebble.h"
+#include <stdio.h>
+
+// App entry points from src/main.c
+void init(void);
+void deinit(void);
+
+typedef struct {
+	uint32_t redraws;           // Layer update passes run by host_render
+	uint32_t dirty_marks;       // layer_mark_dirty calls
+	uint32_t text_draws;        // graphics_draw_text and text layer draws
+	uint32_t layout_bytes;      // Bytes walked by the text layout engine
+	uint32_t menu_rows_drawn;   // Menu rows drawn
+	uint32_t timer_wakeups;     // App timers fired
+	uint32_t offset_changes;    // Scroll layer offset changes
+	uint32_t resource_reads;    // resource_load* calls
+	uint32_t resource_bytes;    // Bytes returned by resource_load*
+	uint32_t log_calls;         // app_log calls
+	uint32_t persist_reads;     // persist_read_data calls
+	uint32_t persist_writes;    // persist_write_data and persist_delete calls
+	uint32_t messages_in;       // AppMessages handed to the inbox
+	uint32_t messages_out;      // AppMessages sent from the outbox
+	uint32_t vibes;             // Vibration pulses
+	uint32_t heap_peak;         // Most app heap in use at once, see heap_bytes_used
+} HostCounters;
+
+extern HostCounters host_counters;
+
+void host_reset(void);
+void host_reset_counters(void);
+void host_set_resource_dir(const char *dir);
+void host_set_resource(uint32_t resource_id, const uint8_t *data, size_t size);
+void host_set_log_level(uint8_t level);
+void host_persist_clear(void);
+
+// The phone end of AppMessage, for a phone simulator. Watch messages go to
+// receive as they are sent; the phone acks them with host_app_message_sent
+// and delivers its own with host_app_message_deliver.
+typedef void (*HostPhoneReceive)(const uint8_t *data, size_t size);
+void host_app_message_connect(HostPhoneReceive receive);
+AppMessageResult host_app_message_deliver(const uint8_t *data, size_t size);
+void host_app_message_sent(AppMessageResult result);
+
+uint32_t host_now(void);
+void host_advance(uint32_t ms);
+uint32_t host_pending_timers(void);
+
+void host_render(void);
+
+void host_single_click(ButtonId button);
+void host_multi_click(ButtonId button, uint8_t clicks);
+void host_long_click_down(ButtonId button);
+void host_long_click_up(ButtonId button);
+
+// Raw presses and releases at host_now(), recognized into the clicks the
+// top window subscribed as the clock advances. With a trace file set, each
+// is written as a line of a button trace (see host/replay.c), and the clicks
+// recognized as comments.
+void host_button_down(ButtonId button);
+void host_button_up(ButtonId button);
+void host_trace_record(FILE *out);
+const char *host_button_name(ButtonId button);
+
+#endif
@@ -0,0 +1,411 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Host (Linux) stand-in for the subset of the Pebble SDK 2 API used
+ *          by the app. Only for off-watch builds, see host/pebble-host.c
+ *******************************************************************************
+ */
+
+#ifndef __PEBBLE_HOST__
+#define __PEBBLE_HOST__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "resource-ids.h"
+
+///////////////////////////GRAPHICS TYPES///////////////////////////
+typedef struct GPoint {
+	int16_t x;
+	int16_t y;
+} GPoint;
+
+typedef struct GSize {
+	int16_t w;
+	int16_t h;
+} GSize;
+
+typedef struct GRect {
+	GPoint origin;
+	GSize size;
+} GRect;
+
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+#define GPointZero GPoint(0, 0)
+
+typedef enum {
+	GColorClear = -1,
+	GColorBlack = 0,
+	GColorWhite = 1,
+} GColor;
+
+typedef enum {
+	GTextOverflowModeWordWrap,
+	GTextOverflowModeTrailingEllipsis,
+	GTextOverflowModeFill,
+} GTextOverflowMode;
+
+typedef enum {
+	GTextAlignmentLeft,
+	GTextAlignmentCenter,
+	GTextAlignmentRight,
+} GTextAlignment;
+
+typedef enum {
+	GCornerNone = 0,
+	GCornersAll = 15,
+} GCornerMask;
+
+typedef struct GFontHost *GFont;
+typedef struct GContext GContext;
+typedef void *GTextLayoutCacheRef;
+
+#define FONT_KEY_GOTHIC_14 "RESOURCE_ID_GOTHIC_14"
+#define FONT_KEY_GOTHIC_18 "RESOURCE_ID_GOTHIC_18"
+#define FONT_KEY_GOTHIC_24 "RESOURCE_ID_GOTHIC_24"
+#define FONT_KEY_GOTHIC_28 "RESOURCE_ID_GOTHIC_28"
+#define FONT_KEY_BITHAM_30_BLACK "RESOURCE_ID_BITHAM_30_BLACK"
+
+GFont fonts_get_system_font(const char *font_key);
+
+void graphics_context_set_text_color(GContext *ctx, GColor color);
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_fill_rect(GContext *ctx, GRect rect, uint16_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_line(GContext *ctx, GPoint p0, GPoint p1);
+void graphics_draw_text(GContext *ctx, const char *text, GFont const font, const GRect box,
+						const GTextOverflowMode overflow_mode, const GTextAlignment alignment,
+						const GTextLayoutCacheRef layout);
+GSize graphics_text_layout_get_max_used_size(GContext *ctx, const char *text, GFont const font,
+											 const GRect box, const GTextOverflowMode overflow_mode,
+											 const GTextAlignment alignment, GTextLayoutCacheRef layout);
+
+///////////////////////////LAYERS///////////////////////////
+typedef struct Layer Layer;
+typedef void (*LayerUpdateProc)(struct Layer *layer, GContext *ctx);
+
+Layer *layer_create(GRect frame);
+Layer *layer_create_with_data(GRect frame, size_t data_size);
+void layer_destroy(Layer *layer);
+void *layer_get_data(const Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_mark_dirty(Layer *layer);
+void layer_add_child(Layer *parent, Layer *child);
+void layer_remove_from_parent(Layer *child);
+void layer_set_frame(Layer *layer, GRect frame);
+GRect layer_get_frame(const Layer *layer);
+void layer_set_bounds(Layer *layer, GRect bounds);
+GRect layer_get_bounds(const Layer *layer);
+void layer_set_hidden(Layer *layer, bool hidden);
+
+typedef struct TextLayer TextLayer;
+
+TextLayer *text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer *text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+const char *text_layer_get_text(TextLayer *text_layer);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+void text_layer_set_size(TextLayer *text_layer, const GSize max_size);
+GSize text_layer_get_content_size(TextLayer *text_layer);
+void text_layer_set_overflow_mode(TextLayer *text_layer, GTextOverflowMode line_mode);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+
+///////////////////////////CLICKS///////////////////////////
+typedef enum {
+	BUTTON_ID_BACK = 0,
+	BUTTON_ID_UP,
+	BUTTON_ID_SELECT,
+	BUTTON_ID_DOWN,
+	NUM_BUTTONS
+} ButtonId;
+
+typedef void *ClickRecognizerRef;
+typedef void (*ClickHandler)(ClickRecognizerRef recognizer, void *context);
+typedef void (*ClickConfigProvider)(void *context);
+
+void window_single_click_subscribe(ButtonId button_id, ClickHandler handler);
+void window_single_repeating_click_subscribe(ButtonId button_id, uint16_t repeat_interval_ms, ClickHandler handler);
+void window_multi_click_subscribe(ButtonId button_id, uint8_t min_clicks, uint8_t max_clicks, uint16_t timeout,
+								  bool last_click_only, ClickHandler handler);
+void window_long_click_subscribe(ButtonId button_id, uint16_t delay_ms, ClickHandler down_handler, ClickHandler up_handler);
+ButtonId click_recognizer_get_button_id(ClickRecognizerRef recognizer);
+uint8_t click_number_of_clicks_counted(ClickRecognizerRef recognizer);
+
+///////////////////////////WINDOWS///////////////////////////
+typedef struct Window Window;
+typedef void (*WindowHandler)(struct Window *window);
+
+typedef struct WindowHandlers {
+	WindowHandler load;
+	WindowHandler appear;
+	WindowHandler disappear;
+	WindowHandler unload;
+} WindowHandlers;
+
+Window *window_create(void);
+void window_destroy(Window *window);
+Layer *window_get_root_layer(const Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+void window_set_click_config_provider(Window *window, ClickConfigProvider click_config_provider);
+void window_set_click_config_provider_with_context(Window *window, ClickConfigProvider click_config_provider,
+												   void *context);
+void window_set_fullscreen(Window *window, bool enabled);
+void window_set_user_data(Window *window, void *data);
+void *window_get_user_data(const Window *window);
+bool window_is_loaded(Window *window);
+
+void window_stack_push(Window *window, bool animated);
+Window *window_stack_pop(bool animated);
+bool window_stack_remove(Window *window, bool animated);
+Window *window_stack_get_top_window(void);
+bool window_stack_contains_window(Window *window);
+
+///////////////////////////SCROLL LAYER///////////////////////////
+typedef struct ScrollLayer ScrollLayer;
+typedef void (*ScrollLayerCallback)(struct ScrollLayer *scroll_layer, void *context);
+
+typedef struct ScrollLayerCallbacks {
+	ClickConfigProvider click_config_provider;
+	ScrollLayerCallback content_offset_changed_handler;
+} ScrollLayerCallbacks;
+
+ScrollLayer *scroll_layer_create(GRect frame);
+void scroll_layer_destroy(ScrollLayer *scroll_layer);
+Layer *scroll_layer_get_layer(const ScrollLayer *scroll_layer);
+void scroll_layer_add_child(ScrollLayer *scroll_layer, Layer *child);
+void scroll_layer_set_callbacks(ScrollLayer *scroll_layer, ScrollLayerCallbacks callbacks);
+void scroll_layer_set_context(ScrollLayer *scroll_layer, void *context);
+void scroll_layer_set_content_offset(ScrollLayer *scroll_layer, GPoint offset, bool animated);
+GPoint scroll_layer_get_content_offset(ScrollLayer *scroll_layer);
+void scroll_layer_set_content_size(ScrollLayer *scroll_layer, GSize size);
+GSize scroll_layer_get_content_size(const ScrollLayer *scroll_layer);
+void scroll_layer_set_click_config_onto_window(ScrollLayer *scroll_layer, struct Window *window);
+
+///////////////////////////MENU LAYER///////////////////////////
+typedef struct MenuLayer MenuLayer;
+
+typedef struct MenuIndex {
+	uint16_t section;
+	uint16_t row;
+} MenuIndex;
+
+#define MenuIndex(section, row) ((MenuIndex){(section), (row)})
+#define MENU_CELL_BASIC_HEADER_HEIGHT ((const int16_t) 16)
+#define MENU_CELL_BASIC_CELL_HEIGHT ((const int16_t) 44)
+
+typedef enum {
+	MenuRowAlignNone,
+	MenuRowAlignCenter,
+	MenuRowAlignTop,
+	MenuRowAlignBottom,
+} MenuRowAlign;
+
+typedef uint16_t (*MenuLayerGetNumberOfSectionsCallback)(struct MenuLayer *menu_layer, void *callback_context);
+typedef uint16_t (*MenuLayerGetNumberOfRowsInSectionsCallback)(struct MenuLayer *menu_layer, uint16_t section_index,
+															   void *callback_context);
+typedef int16_t (*MenuLayerGetCellHeightCallback)(struct MenuLayer *menu_layer, MenuIndex *cell_index,
+												  void *callback_context);
+typedef int16_t (*MenuLayerGetHeaderHeightCallback)(struct MenuLayer *menu_layer, uint16_t section_index,
+													void *callback_context);
+typedef void (*MenuLayerDrawRowCallback)(GContext *ctx, const Layer *cell_layer, MenuIndex *cell_index,
+										 void *callback_context);
+typedef void (*MenuLayerDrawHeaderCallback)(GContext *ctx, const Layer *cell_layer, uint16_t section_index,
+											void *callback_context);
+typedef void (*MenuLayerSelectCallback)(struct MenuLayer *menu_layer, MenuIndex *cell_index, void *callback_context);
+typedef void (*MenuLayerSelectionChangedCallback)(struct MenuLayer *menu_layer, MenuIndex new_index,
+												  MenuIndex old_index, void *callback_context);
+
+typedef struct MenuLayerCallbacks {
+	MenuLayerGetNumberOfSectionsCallback get_num_sections;
+	MenuLayerGetNumberOfRowsInSectionsCallback get_num_rows;
+	MenuLayerGetCellHeightCallback get_cell_height;
+	MenuLayerGetHeaderHeightCallback get_header_height;
+	MenuLayerDrawRowCallback draw_row;
+	MenuLayerDrawHeaderCallback draw_header;
+	MenuLayerSelectCallback select_click;
+	MenuLayerSelectCallback select_long_click;
+	MenuLayerSelectionChangedCallback selection_changed;
+} MenuLayerCallbacks;
+
+MenuLayer *menu_layer_create(GRect frame);
+void menu_layer_destroy(MenuLayer *menu_layer);
+Layer *menu_layer_get_layer(const MenuLayer *menu_layer);
+void menu_layer_set_callbacks(MenuLayer *menu_layer, void *callback_context, MenuLayerCallbacks callbacks);
+void menu_layer_set_click_config_onto_window(MenuLayer *menu_layer, struct Window *window);
+void menu_layer_reload_data(MenuLayer *menu_layer);
+void menu_layer_set_selected_index(MenuLayer *menu_layer, MenuIndex index, MenuRowAlign scroll_align, bool animated);
+MenuIndex menu_layer_get_selected_index(const MenuLayer *menu_layer);
+void menu_cell_basic_draw(GContext *ctx, const Layer *cell_layer, const char *title, const char *subtitle, void *icon);
+void menu_cell_title_draw(GContext *ctx, const Layer *cell_layer, const char *title);
+void menu_cell_basic_header_draw(GContext *ctx, const Layer *cell_layer, const char *title);
+
+///////////////////////////TIMERS AND TIME///////////////////////////
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer_handle);
+
+typedef enum {
+	SECOND_UNIT = 1 << 0,
+	MINUTE_UNIT = 1 << 1,
+	HOUR_UNIT = 1 << 2,
+	DAY_UNIT = 1 << 3,
+	MONTH_UNIT = 1 << 4,
+	YEAR_UNIT = 1 << 5,
+} TimeUnits;
+
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+uint16_t time_ms(time_t *t_utc, uint16_t *out_ms);
+
+///////////////////////////RESOURCES///////////////////////////
+typedef const struct HostResource *ResHandle;
+
+ResHandle resource_get_handle(uint32_t resource_id);
+size_t resource_size(ResHandle h);
+size_t resource_load(ResHandle h, uint8_t *buffer, size_t max_length);
+size_t resource_load_byte_range(ResHandle h, uint32_t start_offset, uint8_t *buffer, size_t num_bytes);
+
+///////////////////////////PERSISTENT STORAGE///////////////////////////
+#define PERSIST_DATA_MAX_LENGTH 256
+
+typedef int32_t status_t;
+
+typedef enum {
+	S_SUCCESS = 0,
+	E_ERROR = -1,
+	E_INVALID_ARGUMENT = -4,
+	E_OUT_OF_STORAGE = -6,
+	E_DOES_NOT_EXIST = -9,
+} StatusCode;
+
+bool persist_exists(const uint32_t key);
+int persist_get_size(const uint32_t key);
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size);
+status_t persist_write_data(const uint32_t key, const void *data, const size_t size);
+status_t persist_delete(const uint32_t key);
+
+///////////////////////////DICTIONARY AND APP MESSAGE///////////////////////////
+typedef enum {
+	TUPLE_BYTE_ARRAY = 0,
+	TUPLE_CSTRING = 1,
+	TUPLE_UINT = 2,
+	TUPLE_INT = 3,
+} TupleType;
+
+typedef struct __attribute__((__packed__)) {
+	uint32_t key;
+	TupleType type:8;
+	uint16_t length;
+	union {
+		uint8_t data[0];
+		char cstring[0];
+		uint8_t uint8;
+		uint16_t uint16;
+		uint32_t uint32;
+		int8_t int8;
+		int16_t int16;
+		int32_t int32;
+	} value[];
+} Tuple;
+
+typedef struct __attribute__((__packed__)) {
+	uint8_t count;
+	Tuple head[];
+} Dictionary;
+
+typedef struct {
+	Dictionary *dictionary;
+	const void *end;
+	Tuple *cursor;
+} DictionaryIterator;
+
+typedef enum {
+	DICT_OK = 0,
+	DICT_NOT_ENOUGH_STORAGE = 1 << 1,
+	DICT_INVALID_ARGS = 1 << 2,
+} DictionaryResult;
+
+typedef enum {
+	APP_MSG_OK = 0,
+	APP_MSG_SEND_TIMEOUT = 1 << 1,
+	APP_MSG_SEND_REJECTED = 1 << 2,
+	APP_MSG_NOT_CONNECTED = 1 << 3,
+	APP_MSG_BUSY = 1 << 6,
+	APP_MSG_BUFFER_OVERFLOW = 1 << 7,
+	APP_MSG_INVALID_ARGS = 1 << 11,
+} AppMessageResult;
+
+Tuple *dict_read_begin_from_buffer(DictionaryIterator *iter, const uint8_t * const buffer, const uint16_t size);
+Tuple *dict_read_first(DictionaryIterator *iter);
+Tuple *dict_read_next(DictionaryIterator *iter);
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key);
+DictionaryResult dict_write_begin(DictionaryIterator *iter, uint8_t * const buffer, const uint16_t size);
+DictionaryResult dict_write_data(DictionaryIterator *iter, const uint32_t key, const uint8_t * const data, const uint16_t size);
+DictionaryResult dict_write_uint8(DictionaryIterator *iter, const uint32_t key, const uint8_t value);
+DictionaryResult dict_write_uint16(DictionaryIterator *iter, const uint32_t key, const uint16_t value);
+DictionaryResult dict_write_uint32(DictionaryIterator *iter, const uint32_t key, const uint32_t value);
+uint32_t dict_write_end(DictionaryIterator *iter);
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageInboxDropped)(AppMessageResult reason, void *context);
+typedef void (*AppMessageOutboxSent)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageOutboxFailed)(DictionaryIterator *iterator, AppMessageResult reason, void *context);
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+void app_message_deregister_callbacks(void);
+AppMessageInboxReceived app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+AppMessageInboxDropped app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback);
+AppMessageOutboxSent app_message_register_outbox_sent(AppMessageOutboxSent sent_callback);
+AppMessageOutboxFailed app_message_register_outbox_failed(AppMessageOutboxFailed failed_callback);
+AppMessageResult app_message_outbox_begin(DictionaryIterator **iterator);
+AppMessageResult app_message_outbox_send(void);
+
+///////////////////////////HEAP///////////////////////////
+size_t heap_bytes_used(void);
+size_t heap_bytes_free(void);
+
+// The app heap, counted by heap_bytes_used. Sources of the app get it in
+// place of the C library one, the host stand-in and its drivers do not
+void *host_app_malloc(size_t size);
+void *host_app_calloc(size_t count, size_t size);
+void host_app_free(void *ptr);
+#ifndef HOST_DRIVER
+#define malloc host_app_malloc
+#define calloc host_app_calloc
+#define free host_app_free
+#endif
+
+///////////////////////////VIBES///////////////////////////
+void vibes_short_pulse(void);
+
+///////////////////////////LOGGING///////////////////////////
+typedef enum {
+	APP_LOG_LEVEL_ERROR = 1,
+	APP_LOG_LEVEL_WARNING = 50,
+	APP_LOG_LEVEL_INFO = 100,
+	APP_LOG_LEVEL_DEBUG = 200,
+	APP_LOG_LEVEL_DEBUG_VERBOSE = 255,
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...);
+
+#define APP_LOG(level, fmt, args...) app_log(level, __FILE__, __LINE__, fmt, ## args)
+
+///////////////////////////APP///////////////////////////
+void app_event_loop(void);
+
+#endif
@@ -0,0 +1,365 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Phone side of the note sync for the host stand-in
+ *******************************************************************************
+ */
+
+#include "phone-sim.h"
+#include "pebble-host.h"
+#include "note-sync.h"
+#include "note-store.h"
+#include <string.h>
+
+#define PHONE_SIM_QUEUE_LEN 48
+#define PHONE_SIM_EVENTS 64
+#define PHONE_SIM_RESEND_MS 250
+#define PHONE_SIM_MAX_NACKS 16
+#define PHONE_SIM_TUPLE_HEADER_LEN 7
+
+typedef enum {
+	PHONE_SIM_TO_WATCH,      // A phone message reaches the watch inbox
+	PHONE_SIM_ACK,           // Its ack (or nack) is back on the phone
+	PHONE_SIM_FROM_WATCH,    // A watch message reaches the phone
+	PHONE_SIM_WATCH_ACK,     // The phone ack is back on the watch
+	PHONE_SIM_RESEND,        // A refused message goes out again
+} PhoneSimEventType;
+
+typedef struct {
+	uint8_t data[NOTE_SYNC_INBOX_LEN];
+	uint16_t size;
+	int16_t chunk_at;        // Offset of the chunk bytes, -1 for other ops
+} PhoneSimMessage;
+
+typedef struct {
+	bool used;
+	PhoneSimEventType type;
+	uint32_t due;
+	uint32_t seq;
+	AppMessageResult result;
+	PhoneSimMessage message;
+} PhoneSimEvent;
+
+typedef struct {
+	uint32_t hash;
+	uint16_t size;
+	uint8_t valid;
+	bool complete;
+	uint16_t crc[NOTE_STORE_CHUNKS];
+} PhoneSimSlot;
+
+static PhoneSimLink phone_link;
+static PhoneSimStats phone_stats;
+static PhoneSimNote phone_notes[NOTE_STORE_SLOTS];
+static uint8_t phone_note_count;
+static bool phone_connected;
+// A HELLO is out, the inventory that answers it is fresh
+static bool phone_hello;
+
+static PhoneSimMessage phone_queue[PHONE_SIM_QUEUE_LEN];
+static uint32_t phone_queue_head, phone_queue_tail;
+static uint32_t phone_in_flight;
+static PhoneSimEvent phone_events[PHONE_SIM_EVENTS];
+static uint32_t phone_seq;
+static uint32_t phone_delivered;
+// When each way of the link is free to start the next message
+static uint32_t phone_up_free, phone_down_free;
+
+static uint16_t phone_sim_crc(const uint8_t *data, size_t length) {
+	uint16_t crc = 0xFFFF;
+	for (size_t i = 0; i < length; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	return crc;
+}
+
+static size_t phone_sim_chunk_len(uint16_t size, uint8_t chunk) {
+	uint32_t from = NOTE_STORE_CHUNK_LEN * chunk;
+	if (from >= size) return 0;
+	return (size - from < NOTE_STORE_CHUNK_LEN) ? size - from : NOTE_STORE_CHUNK_LEN;
+}
+
+static void phone_sim_schedule(PhoneSimEventType type, uint32_t due, AppMessageResult result,
+							   const uint8_t *data, uint16_t size, int16_t chunk_at) {
+	for (int i = 0; i < PHONE_SIM_EVENTS; i++) {
+		PhoneSimEvent *event = &phone_events[i];
+		if (event->used) continue;
+		event->used = true;
+		event->type = type;
+		event->due = due;
+		event->seq = phone_seq++;
+		event->result = result;
+		event->message.size = size;
+		event->message.chunk_at = chunk_at;
+		if (size > 0) memcpy(event->message.data, data, size);
+		return;
+	}
+}
+
+  /**
+   *  Time a message of size takes on one way of the link, from now
+   */
+static uint32_t phone_sim_transfer(uint32_t *free, uint16_t size) {
+	uint32_t start = (*free > host_now()) ? *free : host_now();
+	*free = start + (uint32_t)((uint64_t)size * 1000 / phone_link.bytes_per_s);
+	return *free + phone_link.latency_ms;
+}
+
+static void phone_sim_disconnect(void) {
+	phone_connected = false;
+	phone_hello = false;
+	phone_queue_head = phone_queue_tail = 0;
+	phone_in_flight = 0;
+	memset(phone_events, 0, sizeof(phone_events));
+	host_app_message_connect(NULL);
+}
+
+static void phone_sim_send(const PhoneSimMessage *message) {
+	uint8_t data[NOTE_SYNC_INBOX_LEN];
+	memcpy(data, message->data, message->size);
+	if (message->chunk_at >= 0) {
+		if ((int32_t)phone_stats.chunks == phone_link.corrupt_chunk) data[message->chunk_at] ^= 0x5A;
+		phone_stats.chunks++;
+	}
+	phone_stats.messages++;
+	phone_stats.bytes += message->size;
+	phone_in_flight++;
+	phone_sim_schedule(PHONE_SIM_TO_WATCH, 
+					   phone_sim_transfer(&phone_up_free, message->size), 
+					   APP_MSG_OK, 
+					   data, 
+					   message->size, 
+					   message->chunk_at);
+}
+
+  /**
+   *  Sends queued messages while the window allows
+   */
+static void phone_sim_pump(void) {
+	while (phone_connected && phone_queue_head < phone_queue_tail && phone_in_flight < phone_link.window) {
+		phone_sim_send(&phone_queue[phone_queue_head++]);
+	}
+}
+
+static DictionaryIterator *phone_sim_begin(uint8_t op) {
+	static DictionaryIterator iter;
+	PhoneSimMessage *message = &phone_queue[phone_queue_tail];
+	dict_write_begin(&iter, message->data, sizeof(message->data));
+	dict_write_uint8(&iter, NOTE_SYNC_KEY_OP, op);
+	message->chunk_at = -1;
+	return &iter;
+}
+
+static void phone_sim_queue(DictionaryIterator *iter) {
+	phone_queue[phone_queue_tail++].size = dict_write_end(iter);
+}
+
+static uint32_t phone_sim_u32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+  /**
+   *  Queues what takes the watch from inventory to the notes of the phone:
+   *  BEGIN, the chunks that differ and END for every changed slot, DELETE
+   *  for the slots past the notes
+   */
+static void phone_sim_plan(const uint8_t *inventory, uint16_t length) {
+	phone_queue_head = phone_queue_tail = 0;
+	for (uint8_t slot = 0; slot < NOTE_STORE_SLOTS && NOTE_SYNC_SLOT_LEN * (slot + 1) <= length; slot++) {
+		const uint8_t *p = inventory + NOTE_SYNC_SLOT_LEN * slot;
+		PhoneSimSlot held = { phone_sim_u32(p), p[4] | (p[5] << 8), p[6], p[7] != 0, { 0 } };
+		for (uint8_t chunk = 0; chunk < NOTE_STORE_CHUNKS; chunk++) held.crc[chunk] = p[8 + 2 * chunk] | (p[9 + 2 * chunk] << 8);
+		DictionaryIterator *iter;
+		
+		if (slot >= phone_note_count) {
+			if (held.size == 0 && held.hash == 0) continue;
+			iter = phone_sim_begin(NOTE_SYNC_DELETE);
+			dict_write_uint8(iter, NOTE_SYNC_KEY_SLOT, slot);
+			phone_sim_queue(iter);
+			continue;
+		}
+		
+		const PhoneSimNote *note = &phone_notes[slot];
+		uint32_t hash = phone_sim_u32(note->data + 4);
+		if (held.complete && held.hash == hash && held.size == note->size) continue;
+		
+		iter = phone_sim_begin(NOTE_SYNC_BEGIN);
+		dict_write_uint8(iter, NOTE_SYNC_KEY_SLOT, slot);
+		dict_write_uint32(iter, NOTE_SYNC_KEY_HASH, hash);
+		dict_write_uint16(iter, NOTE_SYNC_KEY_SIZE, note->size);
+		phone_sim_queue(iter);
+		
+		for (uint8_t chunk = 0; chunk < NOTE_STORE_CHUNKS; chunk++) {
+			size_t len = phone_sim_chunk_len(note->size, chunk);
+			if (len == 0) break;
+			const uint8_t *data = note->data + NOTE_STORE_CHUNK_LEN * chunk;
+			uint16_t crc = phone_sim_crc(data, len);
+			// The watch keeps a chunk it holds at the same length, see note_store_begin
+			if ((held.valid & (1 << chunk)) && phone_sim_chunk_len(held.size, chunk) == len && held.crc[chunk] == crc) continue;
+			
+			iter = phone_sim_begin(NOTE_SYNC_CHUNK);
+			dict_write_uint8(iter, NOTE_SYNC_KEY_SLOT, slot);
+			dict_write_uint8(iter, NOTE_SYNC_KEY_INDEX, chunk);
+			dict_write_uint16(iter, NOTE_SYNC_KEY_CRC, crc);
+			phone_queue[phone_queue_tail].chunk_at = (uint8_t *)iter->cursor - phone_queue[phone_queue_tail].data + PHONE_SIM_TUPLE_HEADER_LEN;
+			dict_write_data(iter, NOTE_SYNC_KEY_DATA, data, len);
+			phone_sim_queue(iter);
+		}
+		
+		iter = phone_sim_begin(NOTE_SYNC_END);
+		dict_write_uint8(iter, NOTE_SYNC_KEY_SLOT, slot);
+		phone_sim_queue(iter);
+	}
+	phone_stats.synced = (phone_queue_tail == 0);
+	phone_sim_pump();
+}
+
+  /**
+   *  Asks for the inventory, to plan from it
+   */
+static void phone_sim_hello(void) {
+	phone_queue_head = phone_queue_tail = 0;
+	phone_hello = true;
+	phone_sim_queue(phone_sim_begin(NOTE_SYNC_HELLO));
+	phone_sim_pump();
+}
+
+  /**
+   *  The watch sends: the inventory is the only message it has
+   */
+static void phone_sim_receive(const uint8_t *data, size_t size) {
+	phone_sim_schedule(PHONE_SIM_FROM_WATCH, 
+					   phone_sim_transfer(&phone_down_free, size), 
+					   APP_MSG_OK, 
+					   data, 
+					   size, 
+					   -1);
+}
+
+static void phone_sim_handle(PhoneSimEvent *event) {
+	PhoneSimMessage *message = &event->message;
+	switch (event->type) {
+		case PHONE_SIM_TO_WATCH:
+			phone_sim_schedule(PHONE_SIM_ACK, 
+							   host_now() + phone_link.latency_ms, 
+							   host_app_message_deliver(message->data, message->size), 
+							   message->data, 
+							   message->size, 
+							   message->chunk_at);
+			// What is still on the way is lost with the link
+			if ((int32_t)++phone_delivered == phone_link.drop_after) phone_sim_disconnect();
+			break;
+		case PHONE_SIM_ACK:
+			phone_in_flight--;
+			if (event->result != APP_MSG_OK) {
+				// Sent again as it was, corruption and all, after a while
+				if (++phone_stats.nacks > PHONE_SIM_MAX_NACKS) {
+					phone_sim_disconnect();
+					return;
+				}
+				phone_in_flight++;
+				phone_sim_schedule(PHONE_SIM_RESEND, 
+								   host_now() + PHONE_SIM_RESEND_MS, 
+								   APP_MSG_OK, 
+								   message->data, 
+								   message->size, 
+								   message->chunk_at);
+			}
+			phone_sim_pump();
+			// All acked: check what arrived, a dropped chunk shows missing
+			if (phone_connected && !phone_hello && !phone_stats.synced &&
+				phone_queue_head == phone_queue_tail && phone_in_flight == 0) {
+				phone_sim_hello();
+			}
+			break;
+		case PHONE_SIM_RESEND:
+			phone_in_flight--;
+			phone_sim_send(message);
+			break;
+		case PHONE_SIM_FROM_WATCH: {
+			phone_sim_schedule(PHONE_SIM_WATCH_ACK, 
+							   host_now() + phone_link.latency_ms, 
+							   APP_MSG_OK, 
+							   NULL, 
+							   0, 
+							   -1);
+			DictionaryIterator iter;
+			dict_read_begin_from_buffer(&iter, message->data, message->size);
+			Tuple *op = dict_find(&iter, NOTE_SYNC_KEY_OP);
+			Tuple *inventory = dict_find(&iter, NOTE_SYNC_KEY_INVENTORY);
+			if (!op || op->value->uint8 != NOTE_SYNC_HELLO || !inventory) break;
+			phone_stats.inventories++;
+			if (phone_hello) {
+				phone_hello = false;
+				phone_sim_plan(inventory->value->data, inventory->length);
+			}
+			break;
+		}
+		case PHONE_SIM_WATCH_ACK:
+			host_app_message_sent(APP_MSG_OK);
+			break;
+	}
+}
+
+void phone_sim_init(const PhoneSimLink *link) {
+	phone_link = *link;
+	if (phone_link.window == 0) phone_link.window = 1;
+	if (phone_link.bytes_per_s == 0) phone_link.bytes_per_s = 1;
+	memset(&phone_stats, 0, sizeof(phone_stats));
+	phone_sim_disconnect();
+	phone_up_free = phone_down_free = 0;
+	phone_seq = 0;
+	phone_delivered = 0;
+}
+
+  /**
+   *  Notes the phone wants on the watch, note i in slot i. Records must
+   *  outlive the sync.
+   */
+void phone_sim_set_notes(const PhoneSimNote *notes, uint8_t count) {
+	if (count > NOTE_STORE_SLOTS) count = NOTE_STORE_SLOTS;
+	memcpy(phone_notes, notes, sizeof(PhoneSimNote) * count);
+	phone_note_count = count;
+}
+
+  /**
+   *  The phone app starts: link up and HELLO, the watch answers with its
+   *  inventory
+   */
+void phone_sim_connect(void) {
+	phone_connected = true;
+	phone_stats.synced = false;
+	host_app_message_connect(phone_sim_receive);
+	phone_sim_hello();
+}
+
+  /**
+   *  Runs the link until nothing is left to send or max_ms pass, moving the
+   *  virtual clock. Returns the ms it took.
+   */
+uint32_t phone_sim_run(uint32_t max_ms) {
+	uint32_t start = host_now();
+	for (;;) {
+		PhoneSimEvent *next = NULL;
+		for (int i = 0; i < PHONE_SIM_EVENTS; i++) {
+			PhoneSimEvent *event = &phone_events[i];
+			if (event->used && (next == NULL || event->due < next->due || (event->due == next->due && event->seq < next->seq))) {
+				next = event;
+			}
+		}
+		if (next == NULL || next->due > start + max_ms) break;
+		if (next->due > host_now()) host_advance(next->due - host_now());
+		// Handling may schedule into the freed entry, work on a copy
+		PhoneSimEvent event = *next;
+		next->used = false;
+		phone_sim_handle(&event);
+	}
+	return host_now() - start;
+}
+
+const PhoneSimStats *phone_sim_stats(void) {
+	return &phone_stats;
+}
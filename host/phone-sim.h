@@ -0,0 +1,45 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Phone side of the note sync (see src/note-sync.h) for the host
+ *          stand-in. Holds the records built by tools/sync.py, note i for
+ *          slot i, and syncs them like the phone app would over a link of
+ *          given latency and bandwidth, on the virtual clock. Can corrupt a
+ *          chunk on the way or drop the link to test recovery.
+ *******************************************************************************
+ */
+
+#ifndef __PHONE_SIM__
+#define __PHONE_SIM__
+
+#include "pebble.h"
+
+typedef struct {
+	uint32_t latency_ms;     // One way, per message
+	uint32_t bytes_per_s;    // Each way
+	uint8_t window;          // Phone messages in flight before waiting for acks
+	int32_t corrupt_chunk;   // Flip a byte of the n-th chunk sent, -1 for none
+	int32_t drop_after;      // Drop the link once n phone messages arrived, -1 never
+} PhoneSimLink;
+
+typedef struct {
+	uint32_t messages;       // Phone messages sent, resends included
+	uint32_t chunks;         // Chunks sent
+	uint32_t bytes;          // Bytes sent
+	uint32_t nacks;          // Messages the watch refused, sent again
+	uint32_t inventories;    // Inventories received from the watch
+	bool synced;             // The last inventory matched every note
+} PhoneSimStats;
+
+typedef struct {
+	const uint8_t *data;     // Record of tools/sync.py
+	uint16_t size;
+} PhoneSimNote;
+
+void phone_sim_init(const PhoneSimLink *link);
+void phone_sim_set_notes(const PhoneSimNote *notes, uint8_t count);
+void phone_sim_connect(void);
+uint32_t phone_sim_run(uint32_t max_ms);
+const PhoneSimStats *phone_sim_stats(void);
+
+#endif
@@ -0,0 +1,243 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Host check for src/mini-printf.c. Fuzzes mini_snprintf against
+ *          the C library snprintf over the conversions it supports, random
+ *          flags, widths and buffer sizes (truncation included), and guards
+ *          the bytes past the buffer. Then times both formatters on the
+ *          formats the app uses.
+ *
+ *   Usage: build/host/printf-check [cases] [seed]
+ *          Exits non zero on the first mismatch.
+ *******************************************************************************
+ */
+
+#include "mini-printf.h"
+#include <limits.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_BUFFER 96
+#define GUARD 16
+#define GUARD_BYTE 0xA5
+#define BENCH_CALLS 1000000
+
+static uint32_t check_state;
+static uint32_t check_cases;
+
+static uint32_t check_rand(void) {
+	// xorshift32, so a seed replays the same cases everywhere
+	check_state ^= check_state << 13;
+	check_state ^= check_state >> 17;
+	check_state ^= check_state << 5;
+	return check_state;
+}
+
+static double check_now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+  /**
+   *  Values near the edges of every digit count and of the types
+   */
+static long check_long(void) {
+	static const long edges[] = { 0, 1, -1, 9, 10, 99, 100, 999, 1000, -10, -100,
+		INT_MAX, INT_MIN, INT_MAX - 1, INT_MIN + 1, LONG_MAX, LONG_MIN, 0x7F, 0x80, 0xFFFF };
+	switch (check_rand() % 4) {
+		case 0: return edges[check_rand() % (sizeof(edges) / sizeof(edges[0]))];
+		case 1: return (long)(int32_t)check_rand();
+		case 2: return ((long)check_rand() << 32) | check_rand();
+		default: {
+			long value = 1;
+			for (uint32_t i = check_rand() % 19; i > 0; i--) value *= 10;
+			return value + (long)(check_rand() % 3) - 1;
+		}
+	}
+}
+
+static void check_string(char *s, size_t max) {
+	size_t len = (check_rand() % 4 == 0) ? 0 : check_rand() % max;
+	for (size_t i = 0; i < len; i++) s[i] = 32 + check_rand() % 95;
+	s[len] = '\0';
+}
+
+  /**
+   *  Formats with both and compares text, length and the guard bytes
+   */
+static void check_one(size_t size, const char *fmt, ...) {
+	char want[MAX_BUFFER + GUARD];
+	char got[MAX_BUFFER + GUARD];
+	va_list va, copy;
+
+	memset(want, GUARD_BYTE, sizeof(want));
+	memset(got, GUARD_BYTE, sizeof(got));
+	va_start(va, fmt);
+	va_copy(copy, va);
+	vsnprintf(want, size, fmt, va);
+	int len = mini_vsnprintf(got, size, fmt, copy);
+	va_end(copy);
+	va_end(va);
+	check_cases++;
+
+	bool ok = memcmp(want, got, sizeof(want)) == 0;
+	if (size > 0) ok = ok && (size_t)len == strlen(want);
+	else ok = ok && len == 0;
+	if (!ok) {
+		printf("MISMATCH fmt \"%s\" size %zu\n  libc \"%.*s\"\n  mini \"%.*s\" (%d)\n",
+			   fmt, size, (int)size, want, (int)size, got, len);
+		exit(1);
+	}
+}
+
+  /**
+   *  Builds a random conversion: flags, width, length and type
+   */
+static char check_spec(char *spec, bool *star) {
+	static const char types[] = "diuxXcs%";
+	char type = types[check_rand() % (sizeof(types) - 1)];
+	char *p = spec;
+
+	*p++ = '%';
+	*star = false;
+	if (type != '%') {
+		if (check_rand() % 3 == 0) *p++ = '-';
+		if (check_rand() % 3 == 0 && type != 's' && type != 'c') *p++ = '0';
+		switch (check_rand() % 4) {
+			case 0: break;
+			case 1: *star = true; *p++ = '*'; break;
+			default: p += sprintf(p, "%u", check_rand() % 24); break;
+		}
+		if (check_rand() % 3 == 0 && type != 'c' && type != 's') *p++ = 'l';
+	}
+	*p++ = type;
+	*p = '\0';
+	return type;
+}
+
+static void check_fuzz(uint32_t cases) {
+	char fmt[64], spec[16], text[48];
+
+	for (uint32_t c = 0; c < cases; c++) {
+		bool star;
+		char type = check_spec(spec, &star);
+		bool is_long = strchr(spec, 'l') != NULL;
+		int width = (int)(check_rand() % 41) - 20;
+		size_t size = (check_rand() % 8 == 0) ? check_rand() % 2 : check_rand() % MAX_BUFFER;
+
+		// Literal text around the conversion
+		char before[8], after[8];
+		check_string(before, sizeof(before) - 1);
+		check_string(after, sizeof(after) - 1);
+		for (char *p = before; *p; p++) if (*p == '%') *p = '#';
+		for (char *p = after; *p; p++) if (*p == '%') *p = '#';
+		snprintf(fmt, sizeof(fmt), "%s%s%s", before, spec, after);
+
+		long value = check_long();
+		switch (type) {
+			case 'd': case 'i':
+				if (is_long) {
+					if (star) check_one(size, fmt, width, value); else check_one(size, fmt, value);
+				}
+				else {
+					if (star) check_one(size, fmt, width, (int)value); else check_one(size, fmt, (int)value);
+				}
+				break;
+			case 'u': case 'x': case 'X':
+				if (is_long) {
+					if (star) check_one(size, fmt, width, (unsigned long)value); else check_one(size, fmt, (unsigned long)value);
+				}
+				else {
+					if (star) check_one(size, fmt, width, (unsigned)value); else check_one(size, fmt, (unsigned)value);
+				}
+				break;
+			case 'c': {
+				int ch = 1 + check_rand() % 255;
+				if (star) check_one(size, fmt, width, ch); else check_one(size, fmt, ch);
+				break;
+			}
+			case 's':
+				check_string(text, sizeof(text) - 1);
+				if (star) check_one(size, fmt, width, text); else check_one(size, fmt, text);
+				break;
+			default:
+				check_one(size, fmt);
+				break;
+		}
+	}
+
+	// Several conversions in one format, as the app uses them
+	for (uint32_t c = 0; c < cases / 4; c++) {
+		check_string(text, 24);
+		int a = (int)check_long(), b = (int)check_long();
+		size_t size = check_rand() % MAX_BUFFER;
+		check_one(size, "%d of %d for %s", a, b, text);
+		check_one(size, "Note %d (%dB)", a, b);
+		check_one(size, "%02d:%02d %s|%-6s|%6s", a % 100, b % 100, text, text, text);
+		check_one(size, "%08x/%X/%lu/%ld%%", (unsigned)a, (unsigned)b, (unsigned long)check_long(), check_long());
+	}
+}
+
+typedef int (*check_formatter)(char *buffer, size_t size, const char *fmt, ...);
+
+static int check_mini(char *buffer, size_t size, const char *fmt, ...) {
+	va_list va;
+	va_start(va, fmt);
+	int len = mini_vsnprintf(buffer, size, fmt, va);
+	va_end(va);
+	return len;
+}
+
+static int check_libc(char *buffer, size_t size, const char *fmt, ...) {
+	va_list va;
+	va_start(va, fmt);
+	int len = vsnprintf(buffer, size, fmt, va);
+	va_end(va);
+	return len;
+}
+
+  /**
+   *  ns per call and output MB/s for one format
+   */
+static void check_bench(const char *label, int which) {
+	char buffer[64];
+	const char *title = "Hydrogen (H)";
+	check_formatter formats[] = { check_mini, check_libc };
+
+	for (int f = 0; f < 2; f++) {
+		size_t bytes = 0;
+		double start = check_now_ns();
+		for (int i = 0; i < BENCH_CALLS; i++) {
+			switch (which) {
+				case 0: bytes += formats[f](buffer, sizeof(buffer), "Note %d (%dB)", i & 63, i); break;
+				case 1: bytes += formats[f](buffer, sizeof(buffer), "%d of %d for %s", i & 15, i, title); break;
+				case 2: bytes += formats[f](buffer, sizeof(buffer), "%08x %ld", (unsigned)i * 2654435761u, -(long)i * 7919); break;
+				default: bytes += formats[f](buffer, sizeof(buffer), "%s", title); break;
+			}
+		}
+		double ns = (check_now_ns() - start) / BENCH_CALLS;
+		printf("%-22s %6s %10.1f %10.1f\n", label, f ? "libc" : "mini", ns, bytes / ns * 1e9 / BENCH_CALLS / 1e6);
+	}
+}
+
+int main(int argc, char **argv) {
+	uint32_t cases = (argc > 1) ? strtoul(argv[1], NULL, 10) : 200000;
+	check_state = (argc > 2) ? strtoul(argv[2], NULL, 10) : 2463534242u;
+	if (check_state == 0) check_state = 1;
+
+	check_fuzz(cases);
+	printf("fuzz: %u cases match the C library\n\n", (unsigned)check_cases);
+
+	printf("%-22s %6s %10s %10s\n", "format", "impl", "ns_call", "MB_s");
+	check_bench("Note %d (%dB)", 0);
+	check_bench("%d of %d for %s", 1);
+	check_bench("%08x %ld", 2);
+	check_bench("%s", 3);
+	return 0;
+}
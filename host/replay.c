@@ -0,0 +1,224 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Host driver replaying button traces. Runs src/main.c on the host
+ *          stand-in and plays every trace, press by press on the virtual
+ *          clock, through the click recognizer and the real handlers, from
+ *          the notes menu on a fresh start. Reports per trace the latency
+ *          from an input to the note moving, redraws, timer wakeups and
+ *          reads, so scroll engine changes compare on identical input.
+ *          heap is the most app heap in use during the trace; built with
+ *          STATS_ENABLED, the heap of every screen the trace visited follows
+ *          its row.
+ *
+ *          Trace, one event per line, # starts a comment:
+ *              <ms> down|up back|up|select|down
+ *              <ms> end
+ *          ms counts from the start of the trace and never goes back. The
+ *          trace runs until its end line, or REPLAY_TAIL_MS past its last
+ *          event. The latency of an input is the time from it to the next
+ *          change of the note offset, while the note window is on top, and
+ *          a later input takes over one still waiting.
+ *
+ *   Usage: build/host/replay [-d RESOURCE_DIR] [-r RECORD] TRACE...
+ *          -r writes the presses played to RECORD as a trace, with the
+ *          clicks recognized from them as comments
+ *******************************************************************************
+ */
+
+#include "pebble-host.h"
+#include "note-view.h"
+#include "pebble-stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAX_EVENTS 4096
+#define REPLAY_TAIL_MS 1000
+#define REPLAY_LINE_LEN 128
+
+typedef struct {
+	uint32_t at;
+	bool down;
+	ButtonId button;
+} ReplayEvent;
+
+typedef struct {
+	uint32_t inputs;           // Presses and releases on the note window
+	uint32_t answered;         // Inputs the note moved after
+	uint32_t latency_sum;
+	uint32_t latency_max;
+	uint32_t pixels;           // Note offset change, all moves added up
+} ReplayStats;
+
+extern Window *note_window;
+extern NoteView note_view;
+
+static ReplayEvent replay_events[REPLAY_MAX_EVENTS];
+
+static double replay_now_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+  /**
+   *  Reads a trace into replay_events, returns the event count or -1
+   */
+static int replay_load(const char *path, uint32_t *end) {
+	FILE *f = fopen(path, "r");
+	if (f == NULL) {
+		fprintf(stderr, "replay: cannot read %s\n", path);
+		return -1;
+	}
+	char line[REPLAY_LINE_LEN];
+	int count = 0, number = 0;
+	uint32_t last = 0;
+	*end = 0;
+
+	while (fgets(line, sizeof(line), f)) {
+		char event[16], button[16];
+		unsigned at;
+		number++;
+		char *comment = strchr(line, '#');
+		if (comment) *comment = '\0';
+		int fields = sscanf(line, "%u %15s %15s", &at, event, button);
+		if (fields <= 0) continue;
+
+		if (fields == 2 && strcmp(event, "end") == 0 && at >= last) {
+			*end = at;
+			continue;
+		}
+		int b = 0;
+		while (b < NUM_BUTTONS && !(fields == 3 && strcmp(button, host_button_name(b)) == 0)) b++;
+		if (b == NUM_BUTTONS || at < last || count == REPLAY_MAX_EVENTS ||
+			(strcmp(event, "down") != 0 && strcmp(event, "up") != 0)) {
+			fprintf(stderr, "replay: %s:%d: bad event\n", path, number);
+			fclose(f);
+			return -1;
+		}
+		replay_events[count++] = (ReplayEvent){ at, strcmp(event, "down") == 0, b };
+		last = at;
+	}
+	fclose(f);
+	if (*end < last) *end = last + REPLAY_TAIL_MS;
+	return count;
+}
+
+  /**
+   *  Checks the note offset after anything ran: a move answers the input
+   *  waiting since waiting_since, if any
+   */
+static void replay_observe(ReplayStats *stats, int32_t *offset, bool *on_note, bool *waiting, uint32_t waiting_since) {
+	bool top = window_stack_get_top_window() == note_window;
+	int32_t now = top ? note_view_get_offset(&note_view) : 0;
+	// Opening the note lands it, that is no move
+	if (top && *on_note && now != *offset) {
+		stats->pixels += (now > *offset) ? now - *offset : *offset - now;
+		if (*waiting) {
+			uint32_t latency = host_now() - waiting_since;
+			stats->answered++;
+			stats->latency_sum += latency;
+			if (latency > stats->latency_max) stats->latency_max = latency;
+			*waiting = false;
+		}
+	}
+	*on_note = top;
+	*offset = now;
+}
+
+  /**
+   *  Plays a trace from a fresh start of the app and prints its row
+   */
+static bool replay_run(const char *path, FILE *record) {
+	uint32_t end;
+	int count = replay_load(path, &end);
+	if (count < 0) return false;
+
+	host_reset();
+	host_persist_clear();
+#if STATS_ENABLED
+	stats_reset();
+#endif
+	init();
+	host_render();
+	if (record) fprintf(record, "# %s\n", path);
+	host_trace_record(record);
+	host_reset_counters();
+
+	ReplayStats stats = { 0 };
+	int32_t offset = 0;
+	bool on_note = false, waiting = false;
+	uint32_t waiting_since = 0, redraws = 0;
+	int next = 0;
+	double start = replay_now_us();
+	while (host_now() < end) {
+		uint32_t dirty = host_counters.dirty_marks;
+		for (; next < count && replay_events[next].at == host_now(); next++) {
+			if (window_stack_get_top_window() == note_window) {
+				stats.inputs++;
+				waiting = true;
+				waiting_since = host_now();
+			}
+			if (replay_events[next].down) host_button_down(replay_events[next].button);
+			else host_button_up(replay_events[next].button);
+			replay_observe(&stats, &offset, &on_note, &waiting, waiting_since);
+		}
+		host_advance(1);
+		// Redraw like the firmware: once per pass that left something dirty
+		if (host_counters.dirty_marks != dirty) {
+			host_render();
+			redraws++;
+		}
+		replay_observe(&stats, &offset, &on_note, &waiting, waiting_since);
+	}
+	double us = replay_now_us() - start;
+	host_trace_record(NULL);
+	if (record) fprintf(record, "%u end\n", (unsigned)end);
+
+	const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+	printf("%-12.12s %7u %6u %8u %7.1f %7u %7u %7u %7u %6u %7u %6u %8.0f\n", name, (unsigned)end,
+		   (unsigned)stats.inputs, (unsigned)stats.answered,
+		   stats.answered ? (double)stats.latency_sum / stats.answered : 0.0, (unsigned)stats.latency_max,
+		   (unsigned)redraws, (unsigned)host_counters.timer_wakeups, (unsigned)stats.pixels,
+		   (unsigned)host_counters.resource_reads, (unsigned)host_counters.resource_bytes,
+		   (unsigned)host_counters.heap_peak, us);
+#if STATS_ENABLED
+	for (int screen = 0; screen < STATS_SCREENS; screen++) {
+		const StatsHeap *heap = stats_heap_get(screen);
+		if (heap->samples == 0) continue;
+		printf("  %-10s loads %3u load %6u peak %6u free %6u kept %6u\n", stats_screen_name(screen),
+			   (unsigned)heap->loads, (unsigned)heap->load_bytes, (unsigned)heap->peak_used,
+			   (unsigned)heap->min_free, (unsigned)heap->kept_bytes);
+	}
+#endif
+
+	host_reset();
+	deinit();
+	return true;
+}
+
+int main(int argc, char **argv) {
+	FILE *record = NULL;
+	int arg = 1;
+	for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+		if (strcmp(argv[arg], "-d") == 0) {
+			host_set_resource_dir(argv[arg + 1]);
+		}
+		else if (strcmp(argv[arg], "-r") == 0 && (record = fopen(argv[arg + 1], "w")) == NULL) {
+			fprintf(stderr, "replay: cannot write %s\n", argv[arg + 1]);
+			return 1;
+		}
+	}
+	if (arg == argc) {
+		fprintf(stderr, "usage: replay [-d RESOURCE_DIR] [-r RECORD] TRACE...\n");
+		return 1;
+	}
+
+	int failures = 0;
+	printf("%-12s %7s %6s %8s %7s %7s %7s %7s %7s %6s %7s %6s %8s\n", "trace", "ms", "inputs", "answered",
+		   "lat_avg", "lat_max", "redraws", "wakeups", "pixels", "reads", "bytes", "heap", "cpu_us");
+	for (; arg < argc; arg++) failures += !replay_run(argv[arg], record);
+	if (record) fclose(record);
+	return failures != 0;
+}
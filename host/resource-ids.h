@@ -0,0 +1,25 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Host mirror of the resource ids generated by the Pebble SDK from
+ *          appinfo.json. Keep it in the same order as "media" there.
+ *******************************************************************************
+ */
+
+#ifndef __RESOURCE_IDS_HOST__
+#define __RESOURCE_IDS_HOST__
+
+//X(name, file under resources/)
+#define HOST_RESOURCES \
+	X(MENU_ICON, "images/crayon_mine.png") \
+	X(NOTE_PACK, "generated/notes.pack")
+
+typedef enum {
+	RESOURCE_ID_INVALID = 0,
+#define X(name, file) RESOURCE_ID_##name,
+	HOST_RESOURCES
+#undef X
+	HOST_NUM_RESOURCES
+} ResourceId;
+
+#endif
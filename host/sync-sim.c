@@ -0,0 +1,212 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Host driver for the note sync. Runs src/main.c against the phone
+ *          of host/phone-sim.c on the virtual clock: a first sync one
+ *          message at a time and with a window of four, a resync with
+ *          nothing changed, an edited note, a chunk corrupted on the way, a
+ *          link dropped and the app relaunched mid sync, and a note
+ *          removed. After each one the watch must hold every record byte
+ *          for byte and open the synced notes; fails otherwise.
+ *
+ *   Usage: build/host/sync-sim NOTE1.ns NOTE2.ns NOTE1_EDITED.ns
+ *******************************************************************************
+ */
+
+#include "pebble-host.h"
+#include "phone-sim.h"
+#include "note-store.h"
+#include "note-stream.h"
+#include "note-lines.h"
+#include "note-pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SYNC_LATENCY_MS 40
+#define SYNC_BYTES_PER_S 4000
+#define SYNC_MAX_MS 600000
+
+extern MenuLayer *menu_layer;
+extern Window *note_window;
+extern NotePack note_pack;
+extern NoteStream note_stream;
+extern NoteLines note_lines;
+
+static int sync_failures = 0;
+
+static uint8_t *sync_load(const char *path, uint16_t *size) {
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		fprintf(stderr, "sync-sim: cannot read %s\n", path);
+		exit(2);
+	}
+	uint8_t *data = malloc(NOTE_STORE_MAX_LEN + 1);
+	*size = fread(data, 1, NOTE_STORE_MAX_LEN + 1, f);
+	fclose(f);
+	if (*size > NOTE_STORE_MAX_LEN) {
+		fprintf(stderr, "sync-sim: %s does not fit a slot\n", path);
+		exit(2);
+	}
+	return data;
+}
+
+  /**
+   *  Chunks that differ between two records, what an edit should cost
+   */
+static uint32_t sync_delta(const PhoneSimNote *from, const PhoneSimNote *to) {
+	uint32_t chunks = 0;
+	for (uint32_t at = 0; at < to->size; at += NOTE_STORE_CHUNK_LEN) {
+		uint32_t len = (to->size - at < NOTE_STORE_CHUNK_LEN) ? to->size - at : NOTE_STORE_CHUNK_LEN;
+		uint32_t old = (at < from->size) ? from->size - at : 0;
+		if (old > NOTE_STORE_CHUNK_LEN) old = NOTE_STORE_CHUNK_LEN;
+		if (old != len || memcmp(from->data + at, to->data + at, len) != 0) chunks++;
+	}
+	return chunks;
+}
+
+  /**
+   *  Chunks of notes the store does not hold yet, what a resume should cost
+   */
+static uint32_t sync_missing(const PhoneSimNote *notes, uint8_t count) {
+	uint32_t chunks = 0;
+	for (uint8_t slot = 0; slot < count; slot++) {
+		const NoteStoreSlot *s = note_store_slot(slot);
+		for (uint32_t chunk = 0; chunk * NOTE_STORE_CHUNK_LEN < notes[slot].size; chunk++) {
+			if (s->size != notes[slot].size || !(s->valid & (1 << chunk))) chunks++;
+		}
+	}
+	return chunks;
+}
+
+static void sync_launch(void) {
+	host_reset();
+	init();
+	host_render();
+}
+
+static void sync_quit(void) {
+	host_reset();
+	deinit();
+}
+
+  /**
+   *  The watch holds exactly notes, and opens each of them from the menu
+   */
+static bool sync_verify(const PhoneSimNote *notes, uint8_t count) {
+	uint8_t buffer[NOTE_STORE_MAX_LEN];
+	if (note_store_count() != count) return false;
+	
+	for (uint8_t slot = 0; slot < count; slot++) {
+		const NoteStoreSlot *s = note_store_slot(slot);
+		if (!s->complete || s->size != notes[slot].size ||
+			note_store_read(note_store_handle, slot * NOTE_STORE_SPAN, buffer, s->size) != s->size ||
+			memcmp(buffer, notes[slot].data, s->size) != 0) {
+			return false;
+		}
+		
+		// Synced notes are listed after the pack
+		menu_layer_set_selected_index(menu_layer, (MenuIndex){ 0, note_pack.count + slot }, MenuRowAlignCenter, false);
+		host_single_click(BUTTON_ID_SELECT);
+		host_render();
+		bool open = window_stack_get_top_window() == note_window && note_stream.size > 0 && note_lines.count > 0;
+		host_single_click(BUTTON_ID_BACK);
+		if (!open) return false;
+	}
+	return true;
+}
+
+static void sync_report(const char *label, const PhoneSimLink *link, uint32_t ms, uint32_t expect, bool ok) {
+	const PhoneSimStats *stats = phone_sim_stats();
+	ok = ok && stats->synced && stats->chunks == expect;
+	printf("%-14s %6u %8u %8u %8u %8u %6u %6u %4s\n",
+		   label, link->window, (unsigned)ms, (unsigned)stats->messages, (unsigned)stats->chunks,
+		   (unsigned)expect, (unsigned)stats->bytes, (unsigned)stats->nacks, ok ? "ok" : "FAIL");
+	if (!ok) sync_failures++;
+}
+
+  /**
+   *  One sync over link from what the watch holds now
+   */
+static void sync_run(const char *label, const PhoneSimLink *link, const PhoneSimNote *notes, uint8_t count,
+					 uint32_t expect) {
+	phone_sim_init(link);
+	phone_sim_set_notes(notes, count);
+	phone_sim_connect();
+	uint32_t ms = phone_sim_run(SYNC_MAX_MS);
+	sync_report(label, link, ms, expect, sync_verify(notes, count));
+}
+
+int main(int argc, char **argv) {
+	if (argc != 4) {
+		fprintf(stderr, "Usage: %s NOTE1.ns NOTE2.ns NOTE1_EDITED.ns\n", argv[0]);
+		return 2;
+	}
+	PhoneSimNote notes[2], edited[2];
+	notes[0].data = sync_load(argv[1], &notes[0].size);
+	notes[1].data = sync_load(argv[2], &notes[1].size);
+	edited[0].data = sync_load(argv[3], &edited[0].size);
+	edited[1] = notes[1];
+	uint32_t all = (notes[0].size + NOTE_STORE_CHUNK_LEN - 1) / NOTE_STORE_CHUNK_LEN +
+				   (notes[1].size + NOTE_STORE_CHUNK_LEN - 1) / NOTE_STORE_CHUNK_LEN;
+	
+	PhoneSimLink link = { SYNC_LATENCY_MS, SYNC_BYTES_PER_S, 1, -1, -1 };
+	PhoneSimLink wide = link;
+	wide.window = 4;
+	
+	printf("%-14s %6s %8s %8s %8s %8s %6s %6s %4s\n",
+		   "scenario", "window", "ms", "messages", "chunks", "expect", "bytes", "nacks", "");
+	
+	// First sync, one message in flight then four
+	host_persist_clear();
+	sync_launch();
+	sync_run("first", &link, notes, 2, all);
+	sync_quit();
+	
+	host_persist_clear();
+	sync_launch();
+	sync_run("first", &wide, notes, 2, all);
+	sync_quit();
+	
+	// A relaunch finds them in storage, nothing to send
+	sync_launch();
+	if (note_store_count() != 2) sync_failures++;
+	sync_run("unchanged", &wide, notes, 2, 0);
+	
+	// One note edited: only its chunks that changed
+	sync_run("edited", &wide, edited, 2, sync_delta(&notes[0], &edited[0]));
+	sync_quit();
+	
+	// A chunk corrupted on the way is dropped by the watch and sent again
+	PhoneSimLink corrupt = wide;
+	corrupt.corrupt_chunk = 2;
+	host_persist_clear();
+	sync_launch();
+	sync_run("corrupted", &corrupt, notes, 2, all + 1);
+	sync_quit();
+	
+	// The link drops mid sync and the app is closed: the relaunch resumes
+	// with the chunks that had not arrived
+	PhoneSimLink cut = wide;
+	cut.drop_after = 6;
+	host_persist_clear();
+	sync_launch();
+	phone_sim_init(&cut);
+	phone_sim_set_notes(notes, 2);
+	phone_sim_connect();
+	phone_sim_run(SYNC_MAX_MS);
+	sync_quit();
+	sync_launch();
+	uint32_t missing = sync_missing(notes, 2);
+	if (note_store_count() != 0 || missing == all) sync_failures++;
+	sync_run("resumed", &wide, notes, 2, missing);
+	
+	// The phone drops a note, its slot is freed
+	sync_run("removed", &wide, notes, 1, 0);
+	sync_quit();
+	
+	free((uint8_t *)notes[0].data);
+	free((uint8_t *)notes[1].data);
+	free((uint8_t *)edited[0].data);
+	printf("%s\n", sync_failures ? "sync-sim: FAILED" : "sync-sim: all scenarios passed");
+	return sync_failures ? 1 : 0;
+}
@@ -25,67 +25,172 @@
  *******************************************************************************
  */
 
-//TODO:Password protected notes
-//TODO:NoteDef struct {Title, Password, Font}
-
 ///////////////////////////INCLUDES///////////////////////////
 #include "mini-printf.h"
 #include "pebble.h"
 #include <time.h>
+#include <string.h>
 #include "pebble-log.h"
+#include "pebble-stats.h"
+#include "note-view.h"
+#include "note-scroll.h"
+#include "note-pack.h"
+#include "note-search.h"
+#include "note-table-view.h"
+#include "note-state.h"
+#include "note-store.h"
+#include "note-sync.h"
+#include "note-prefetch.h"
+#include "note-cipher.h"
+#include "note-arena.h"
+#include "note-text.h"
 	
 ///////////////////////////DECLARATIONS///////////////////////////
 //CONSTANTS
 #define LARGE FONT_KEY_GOTHIC_24
 #define MEDIUM FONT_KEY_GOTHIC_18
 #define SMALL FONT_KEY_GOTHIC_14
-#define UP 1
-#define DOWN 2
-#define AUTO 3
+#define UP -1
+#define DOWN 1
 	
 //Config this to fit your needs. 
-// Remember to add the resources and change NUM_NOTES 
-#define NUM_NOTES 2
+// Notes are the .txt files in resources/notes, packed by build.sh
 #define FONT_TYPE SMALL
-#define PIXELS_PER_CLICK 100
-#define PIXELS_PER_LONG_CLICK 6
-#define LONG_CLICK_DELAY 100
-#define PIXELS_PER_AUTO_SCROLL 3
-#define AUTO_SCROLL_DELAY 100
-#define TEXT_BUFFER_LEN 10000
+#define JUMP_STEP_PERCENT 10         // Go to bar step
+#define LONG_CLICK_SPEED 60          // Pixels per second when a long push starts
+#define LONG_CLICK_MAX_SPEED 480     // Pixels per second
+#define LONG_CLICK_ACCELERATION 240  // Pixels per second, per second
+#define AUTO_SCROLL_SPEED 30         // Pixels per second
+#define PREFETCH_BUDGET NOTE_WINDOW_LEN  // Bytes of the highlighted note decoded ahead, 0 disables
 #define ALLOW_FAKE_CLOCK 1
 
 //More constants
-#define NUM_MENU_SECTIONS 1
-#define NUM_FIRST_MENU_ITEMS NUM_NOTES
+#define NUM_MENU_SECTIONS 2
+#define NUM_SECOND_MENU_ITEMS 1
+#define TITLE_BUFFER_LEN 30
+#define NOTE_META_HEAP_SHARE 2  // The row cache takes at most 1/n of the free heap
+#define NOTE_META_HEAD_LEN 64
+// Pack title and its size label, " (1048576B)" at most
+#define NOTE_META_TITLE_LEN (NOTE_PACK_TITLE_LEN + 12)
 
 	
 //GLOBALS
-char note_view[TEXT_BUFFER_LEN];
-uint32_t note_selected;
-size_t note_selected_size;
-bool long_click_running = false;
-bool auto_scroll_running = false;
-AppTimer *timer_handle;
+NoteStream note_stream;
+NoteLines note_lines;
+int note_selected_row;
+// A search hit opens at its offset, the first word of a note included;
+// without a target the note reopens where it was left
+bool note_selected_target;
+uint32_t note_selected_offset;
+
+// Menu row previews are decoded once and drawn from here; the title comes
+// from the table of contents, a ranged read with nothing to decode. The
+// cache has a slot per note; when the heap cannot hold that many it is
+// direct mapped by row over the slots it has.
+typedef struct {
+	int16_t row;           // Notes are 4096 at most, see tools/index.py
+	char preview[TITLE_BUFFER_LEN];
+} NoteMeta;
+NoteMeta *note_meta = NULL;
+uint32_t note_meta_len = 0;
+uint32_t note_meta_hits = 0;
+uint32_t note_meta_misses = 0;
+
+//RESOURCE LINKS
+// Every note, its line table, the dictionary and the search index
+NotePack note_pack;
 
 //WINDOWS
 // This is the main window, shows a list of notes
 Window *main_window;
 // This is a menu layer, you have more control than with a simple menu layer
 MenuLayer *menu_layer;
+// This holds the menu row cache while the menu is loaded
+NoteArena main_arena;
+#define MAIN_ARENA_LEN(rows) NOTE_ARENA_SIZE((rows) * sizeof(NoteMeta))
 
 // This is the note window, shows only one note
 Window *note_window;
-// This is a scroll layer to handle big texts
-ScrollLayer *scroll_layer;
-// This is the note itself
-TextLayer *text_layer;
+// This is the note itself, drawn line by line
+NoteView note_view;
+// This moves the note
+NoteScroll note_scroll;
+// This is where the note was left, saved on unload
+NoteState note_state;
+// This loads the note highlighted in the menu before it is selected
+NotePrefetch note_prefetch;
+// This is the go to bar, a long push on select shows it over the note
+TextLayer *jump_text;
+#define JUMP_LINE_LEN 32
+char *jump_str = NULL;
+int jump_percent = -1; // Picked in the bar, -1 while it is hidden
+// This holds the text of the open or prefetched note and the go to bar,
+// given back when neither is needed, so the menu holds no note
+NoteArena note_arena;
+#define NOTE_ARENA_LEN (NOTE_ARENA_SIZE(NOTE_WINDOW_LEN) + NOTE_ARENA_SIZE(JUMP_LINE_LEN))
+
+// This is the PIN window, unlocks a locked note with a sequence of pushes
+Window *pin_window;
+TextLayer *pin_title_text;
+TextLayer *pin_dots_text;
+TextLayer *pin_help_text;
+int pin_row;
+NotePackEntry pin_entry;
+char *pin_pushes = NULL;
+size_t pin_len = 0;
+#define PIN_LINE_LEN (2 * NOTE_PIN_MAX_LEN + 1)
+char *pin_dots_str = NULL;
+// This holds the pushes and their dots, wiped as the window goes
+NoteArena pin_arena;
+#define PIN_ARENA_LEN (NOTE_ARENA_SIZE(NOTE_PIN_MAX_LEN) + NOTE_ARENA_SIZE(PIN_LINE_LEN))
+// The PIN window derives the key, the note window takes it and wipes it on unload
+NoteKey pin_key;
+NoteKey note_key;
+
+// This is the table window, shows one CSV note as a table
+Window *table_window;
+NoteTable note_table;
+NoteTableView note_table_view;
+// This holds the bucket seeds of the open table, sized for them
+NoteArena table_arena;
+#define TABLE_ARENA_LEN(seeds) NOTE_ARENA_SIZE(seeds)
+
+// This is the search window, builds a query letter by letter
+Window *search_window;
+TextLayer *search_query_text;
+TextLayer *search_letter_text;
+TextLayer *search_help_text;
+NoteIndex note_index;
+#define SEARCH_ALPHABET "abcdefghijklmnopqrstuvwxyz0123456789"
+#define SEARCH_LINE_LEN 32
+char search_query[NOTE_SEARCH_KEY_LEN + 1];
+int search_letter = 0;
+char *search_query_str = NULL;
+char *search_letter_str = NULL;
+NoteArena search_arena;
+#define SEARCH_ARENA_LEN (2 * NOTE_ARENA_SIZE(SEARCH_LINE_LEN) + NOTE_ARENA_SIZE(NOTE_SEARCH_BLOCK_LEN))
+// When set, the search window finds a row of this table by key instead,
+// the words query waits in search_saved
+NoteTable *search_table = NULL;
+char search_saved[NOTE_SEARCH_KEY_LEN + 1];
+void search_lookup_show(NoteTable *table);
+
+// This is the search results window, one row per hit
+Window *results_window;
+MenuLayer *results_layer;
+// Scratch for the header and the rows as they draw
+NoteArena results_arena;
+#define RESULTS_ARENA_LEN (2 * NOTE_ARENA_SIZE(SEARCH_LINE_LEN))
+NoteSearchHit search_hits[NOTE_SEARCH_MAX_HITS];
+uint32_t search_hit_count = 0;
+uint32_t search_total = 0;
 
 // This is the fake clock window, to hide the note if necessary hehe
 Window *clock_window;
 TextLayer *clock_text;
 #define TIME_STR_BUFFER_BYTES 32
-char s_time_str_buffer[TIME_STR_BUFFER_BYTES];
+char *s_time_str_buffer = NULL;
+NoteArena clock_arena;
 int state_machine = 0; //UP+DOWN+UP+DOWN+SELECT to exit clock
 
 
@@ -93,11 +198,59 @@ int state_machine = 0; //UP+DOWN+UP+DOWN+SELECT to exit clock
 
 
 ///////////////////////////    CODE   ///////////////////////////
+///////////////////////////NOTES///////////////////////////
+  /**
+   *  Notes in the menu: the pack, then the synced ones
+   */
+uint32_t note_count(void) {
+	return note_pack.count + note_store_count();
+}
+
+  /**
+   *  Table of contents entry of a menu row, read through entry->handle
+   */
+bool note_entry(uint32_t row, NotePackEntry *entry) {
+	if (row < note_pack.count) {
+		return note_pack_entry(&note_pack, 
+							   row, 
+							   entry);
+	}
+	return note_store_entry(row - note_pack.count, 
+							entry);
+}
+
+  /**
+   *  Takes the note arena, for the note window or the prefetch, and hands
+   *  the stream its window and the go to bar its text. False when the heap
+   *  is short: notes then open empty.
+   */
+bool note_memory_open(void) {
+	if (note_arena_is_open(&note_arena)) return true;
+	if (!note_arena_open(&note_arena, NOTE_ARENA_LEN)) return false;
+	
+	note_stream_attach(&note_stream, 
+					   note_arena_alloc(&note_arena, NOTE_WINDOW_LEN));
+	jump_str = note_arena_alloc(&note_arena, 
+								JUMP_LINE_LEN);
+	return true;
+}
+
+  /**
+   *  Gives the note arena back, wiping the text it held
+   */
+void note_memory_close(void) {
+	note_stream_attach(&note_stream, 
+					   NULL);
+	jump_str = NULL;
+	note_arena_close(&note_arena);
+}
+
+
 ///////////////////////////CLOCK WINDOW///////////////////////////
 
 #if ALLOW_FAKE_CLOCK == 1
 void up_single_click_clock_window_handler(ClickRecognizerRef recognizer, void *context) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###up_single_click_clock_window_handler: %d###", state_machine);
+	LOG_DEBUG("###up_single_click_clock_window_handler: %d###", state_machine);
 	switch (state_machine) {
 		case 0: state_machine = 1; break;
 		case 2: state_machine = 3; break;
@@ -106,7 +259,7 @@ void up_single_click_clock_window_handler(ClickRecognizerRef recognizer, void *c
 }
 
 void down_single_click_clock_window_handler(ClickRecognizerRef recognizer, void *context) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###down_single_click_clock_window_handler: %d###", state_machine);
+	LOG_DEBUG("###down_single_click_clock_window_handler: %d###", state_machine);
 	switch (state_machine) {
 		case 1: state_machine = 2; break;
 		case 3: state_machine = 4; break;
@@ -115,7 +268,7 @@ void down_single_click_clock_window_handler(ClickRecognizerRef recognizer, void
 }
 
 void select_single_click_clock_window_handler(ClickRecognizerRef recognizer, void *context) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###select_single_click_clock_window_handler: %d###", state_machine);
+	LOG_DEBUG("###select_single_click_clock_window_handler: %d###", state_machine);
     if (state_machine == 4) {
 	    window_stack_pop(true);
 	}
@@ -136,7 +289,7 @@ void clock_config_provider(Window *window) {
 
 static void handle_tick(struct tm *tick_time, TimeUnits units_changed) {
       // Handle tick only if current window is the clock
-        if (window_stack_get_top_window() == clock_window) {
+        if (window_stack_get_top_window() == clock_window && s_time_str_buffer) {
                 strftime(s_time_str_buffer, 
                                    TIME_STR_BUFFER_BYTES, 
                                    "%I %M %p", 
@@ -146,8 +299,13 @@ static void handle_tick(struct tm *tick_time, TimeUnits units_changed) {
     }
 	
 void clock_window_load(Window *me) {
+	STATS_HEAP(STATS_SCREEN_CLOCK, STATS_LOAD_BEGIN);
 
 	Layer *clock_window_layer = window_get_root_layer(clock_window);
+	note_arena_open(&clock_arena, 
+					TIME_STR_BUFFER_BYTES);
+	s_time_str_buffer = note_arena_alloc(&clock_arena, 
+										 TIME_STR_BUFFER_BYTES);
 	
 	// Format text leayer
 	clock_text = text_layer_create(GRect(40, 30, 64, 138));
@@ -159,11 +317,13 @@ void clock_window_load(Window *me) {
 						fonts_get_system_font(FONT_KEY_BITHAM_30_BLACK));
 
 	// Fill clock text
-	time_t t = time(NULL);
-	struct tm *now = localtime(&t);
-    strftime(s_time_str_buffer, TIME_STR_BUFFER_BYTES, "%I %M %p", now);
-	text_layer_set_text(clock_text, 
-						s_time_str_buffer);
+	if (s_time_str_buffer) {
+		time_t t = time(NULL);
+		struct tm *now = localtime(&t);
+		strftime(s_time_str_buffer, TIME_STR_BUFFER_BYTES, "%I %M %p", now);
+		text_layer_set_text(clock_text, 
+							s_time_str_buffer);
+	}
 						
 	tick_timer_service_subscribe(MINUTE_UNIT, handle_tick);
 	
@@ -172,11 +332,16 @@ void clock_window_load(Window *me) {
 	
     window_set_click_config_provider(clock_window, 
 									 (ClickConfigProvider)clock_config_provider);
+	STATS_HEAP(STATS_SCREEN_CLOCK, STATS_LOAD_END);
 
 }
 void clock_window_unload(Window *me) {
+	STATS_HEAP(STATS_SCREEN_CLOCK, STATS_UNLOAD_BEGIN);
 	tick_timer_service_unsubscribe();
 	text_layer_destroy(clock_text);
+	s_time_str_buffer = NULL;
+	note_arena_close(&clock_arena);
+	STATS_HEAP(STATS_SCREEN_CLOCK, STATS_UNLOAD_END);
 	window_destroy(clock_window);
 }
 
@@ -187,137 +352,170 @@ void clock_window_unload(Window *me) {
 	
 ///////////////////////////NOTE WINDOW///////////////////////////
   /**
-   *  Goes one screen up
+   *  Page the go to bar lands on: the one holding the line at jump_percent
+   */
+uint32_t jump_page(void) {
+	uint32_t line = (note_lines.count > 0) ? (note_lines.count - 1) * jump_percent / 100 : 0;
+	return line / note_view_page_lines(&note_view);
+}
+
+  /**
+   *  Shows the go to bar with the picked percent and its page, or hides it
+   */
+void jump_update(void) {
+	if (jump_percent < 0 || jump_str == NULL) {
+		layer_set_hidden(text_layer_get_layer(jump_text), 
+						 true);
+		return;
+	}
+	mini_snprintf(jump_str, 
+				  JUMP_LINE_LEN, 
+				  "Go to %d%%, page %d/%d", 
+				  jump_percent, 
+				  (int)jump_page() + 1, 
+				  (int)note_view_pages(&note_view));
+	text_layer_set_text(jump_text, 
+						jump_str);
+	layer_set_hidden(text_layer_get_layer(jump_text), 
+					 false);
+}
+
+  /**
+   *  Moves the go to bar pick, within 0-100%
+   */
+void jump_step(int step) {
+	jump_percent += step;
+	if (jump_percent < 0) jump_percent = 0;
+	if (jump_percent > 100) jump_percent = 100;
+	jump_update();
+}
+
+  /**
+   *  Goes one page of whole lines up
    */
 void up_single_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
-	GPoint offset = scroll_layer_get_content_offset(scroll_layer);
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###up_single_click_note_window_handler: offset.y %d###", offset.y);
-	offset.y = offset.y + PIXELS_PER_CLICK;
-	scroll_layer_set_content_offset	(scroll_layer,
-									 offset,
-									 true);
+	LOG_DEBUG("###up_single_click_note_window_handler: top %d###", (int)note_view_get_offset(&note_view));
+	if (jump_percent >= 0) {
+		jump_step(-JUMP_STEP_PERCENT);
+		return;
+	}
+	note_scroll_to(&note_scroll, 
+				   note_view_flip(&note_view, UP));
 }
 
   /**
-   *  Goes one screen down
+   *  Goes one page of whole lines down
    */
 void down_single_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
-	GPoint offset = scroll_layer_get_content_offset(scroll_layer);
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###down_single_click_note_window_handler: offset.y %d###", offset.y);
-	offset.y = offset.y - PIXELS_PER_CLICK;
-	scroll_layer_set_content_offset	(scroll_layer,
-									 offset,
-									 true);
+	LOG_DEBUG("###down_single_click_note_window_handler: top %d###", (int)note_view_get_offset(&note_view));
+	if (jump_percent >= 0) {
+		jump_step(JUMP_STEP_PERCENT);
+		return;
+	}
+	note_scroll_to(&note_scroll, 
+				   note_view_flip(&note_view, DOWN));
 }
 
   /**
    *  Goes to the top
    */
 void up_multi_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###up_multi_click_note_window_handler: Entering###");
-	GPoint offset = scroll_layer_get_content_offset(scroll_layer);
-	offset.y = 0;
-	scroll_layer_set_content_offset	(scroll_layer,
-									 offset,
-									 true);
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###up_multi_click_note_window_handler: Exiting###");
+	LOG_DEBUG("###up_multi_click_note_window_handler: Entering###");
+	if (jump_percent >= 0) {
+		jump_step(-100);
+		return;
+	}
+	note_scroll_to(&note_scroll, 
+				   0);
+	LOG_DEBUG("###up_multi_click_note_window_handler: Exiting###");
 }	
 
   /**
    *  Goes to the bottom
    */
 void down_multi_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###down_multi_click_note_window_handler: Entering###");
-	GSize size = scroll_layer_get_content_size(scroll_layer);
-	GPoint offset = scroll_layer_get_content_offset(scroll_layer);
-	offset.y = -1 * size.h;
-	scroll_layer_set_content_offset	(scroll_layer,
-									 offset,
-									 true);
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###down_multi_click_note_window_handler: Exiting###");
-}	
-
-  /**
-   *  Handles ticks when autoscrolling or long pushing
-   */
-void handle_timer(void *data) {
-	
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###handle_timer: long_click_running %d###", long_click_running);
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###handle_timer: auto_scroll_running %d###", auto_scroll_running);
-	
-	int cookie = (int) data;
-	
-	if (long_click_running) {
-		GPoint offset = scroll_layer_get_content_offset(scroll_layer);
-		if (cookie == UP) {
-			offset.y = offset.y + PIXELS_PER_LONG_CLICK;
-		}
-		if (cookie == DOWN) {		
-			offset.y = offset.y - PIXELS_PER_LONG_CLICK;
-		}
-	
-		scroll_layer_set_content_offset	(scroll_layer,
-										 offset,
-										 true);
-		timer_handle = app_timer_register(LONG_CLICK_DELAY, handle_timer, data);
-	}
-	if (auto_scroll_running) {
-		GPoint offset = scroll_layer_get_content_offset(scroll_layer);
-		offset.y = offset.y - PIXELS_PER_AUTO_SCROLL;
-		scroll_layer_set_content_offset	(scroll_layer,
-										 offset,
-										 true);
-		timer_handle = app_timer_register(AUTO_SCROLL_DELAY, handle_timer, data);
+	LOG_DEBUG("###down_multi_click_note_window_handler: Entering###");
+	if (jump_percent >= 0) {
+		jump_step(100);
+		return;
 	}
-	
-}
+	note_scroll_to(&note_scroll, 
+				   note_view_max_offset(&note_view));
+	LOG_DEBUG("###down_multi_click_note_window_handler: Exiting###");
+}	
 
   /**
    *  Goes up smoothly
    */
 void up_long_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
-	long_click_running = true;
-	timer_handle = app_timer_register(LONG_CLICK_DELAY, handle_timer, (void *)UP);
+	note_scroll_hold(&note_scroll, 
+					 UP);
 }
 
   /**
    *  Goes down smoothly
    */
 void down_long_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
-	long_click_running = true;
-	timer_handle = app_timer_register(LONG_CLICK_DELAY, handle_timer, (void *)DOWN);
+	note_scroll_hold(&note_scroll, 
+					 DOWN);
 }
 
   /**
    *  Stops all the smoothiness
    */
 void release_long_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
-	long_click_running = false;
+	note_scroll_release(&note_scroll);
 }
 
   /**
    *  Starts/Stops autoscrolling
    */
 void select_single_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###select_single_click_note_window_handler: auto_scroll_running %d###", auto_scroll_running);
-	auto_scroll_running = !auto_scroll_running;
-	if (auto_scroll_running) {
-		//window_set_status_bar_icon(&note_window,
-		//							 AUTO );
-		timer_handle = app_timer_register(100, handle_timer, (void *)AUTO);
+	// With the go to bar up, lands on its page: one seek, however long the note
+	if (jump_percent >= 0) {
+		note_scroll_to(&note_scroll, 
+					   note_view_page_top(&note_view, jump_page()));
+		jump_percent = -1;
+		jump_update();
+		return;
 	}
-	else {
-		//window_set_status_bar_icon(&note_window,
-		//							 NORMAL );
-		app_timer_cancel(timer_handle);
+	bool auto_scroll_running = !note_scroll_get_auto(&note_scroll);
+	LOG_DEBUG("###select_single_click_note_window_handler: auto_scroll_running %d###", auto_scroll_running);
+	//window_set_status_bar_icon(&note_window,
+	//							 auto_scroll_running ? AUTO : NORMAL );
+	note_scroll_set_auto(&note_scroll, 
+						 auto_scroll_running);
+}
+
+  /**
+   *  Shows the go to bar, starting at the percent of the page on screen
+   */
+void select_long_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
+	uint32_t pages = note_view_pages(&note_view);
+	note_scroll_set_auto(&note_scroll, 
+						 false);
+	jump_percent = (pages > 1) ? note_view_page(&note_view) * 100 / (pages - 1) : 0;
+	jump_percent = jump_percent / JUMP_STEP_PERCENT * JUMP_STEP_PERCENT;
+	jump_update();
+}
+
+  /**
+   *  Back hides the go to bar, else leaves the note
+   */
+void back_single_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
+	if (jump_percent >= 0) {
+		jump_percent = -1;
+		jump_update();
+		return;
 	}
+	window_stack_pop(true);
 }
 
   /**
    *  If enabled, goes to fake clock (tm)
    */
 void select_multi_click_note_window_handler(ClickRecognizerRef recognizer, void *context) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###select_multi_click_note_window_handler: Entering###");
+	LOG_DEBUG("###select_multi_click_note_window_handler: Entering###");
 		
 #if ALLOW_FAKE_CLOCK == 1
 	// Format and push window
@@ -336,7 +534,7 @@ void select_multi_click_note_window_handler(ClickRecognizerRef recognizer, void
 					  true);
 #endif
 	
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###select_multi_click_note_window_handler: Exiting###");
+	LOG_DEBUG("###select_multi_click_note_window_handler: Exiting###");
 }
 
   /**
@@ -346,6 +544,7 @@ void note_config_provider(Window *window) {
     window_single_click_subscribe(BUTTON_ID_UP, up_single_click_note_window_handler);
     window_single_click_subscribe(BUTTON_ID_DOWN, down_single_click_note_window_handler);
     window_single_click_subscribe(BUTTON_ID_SELECT, select_single_click_note_window_handler);
+    window_single_click_subscribe(BUTTON_ID_BACK, back_single_click_note_window_handler);
 
 	window_multi_click_subscribe(BUTTON_ID_SELECT, 2, 10, 500, true, select_multi_click_note_window_handler);
 	window_multi_click_subscribe(BUTTON_ID_UP, 2, 10, 100, true, up_multi_click_note_window_handler);
@@ -353,6 +552,7 @@ void note_config_provider(Window *window) {
  
     window_long_click_subscribe(BUTTON_ID_UP, 700, up_long_click_note_window_handler, release_long_click_note_window_handler);
     window_long_click_subscribe(BUTTON_ID_DOWN, 700, down_long_click_note_window_handler, release_long_click_note_window_handler);
+    window_long_click_subscribe(BUTTON_ID_SELECT, 700, select_long_click_note_window_handler, NULL);
 	
 }
 
@@ -361,126 +561,750 @@ void note_config_provider(Window *window) {
    *  Load the note window
    */
 void note_window_load(Window *me) { 
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###note_window_load: Entering###");
+	LOG_DEBUG("###note_window_load: Entering###");
+	STATS_BEGIN(STATS_NOTE_WINDOW_LOAD);
+	STATS_HEAP(STATS_SCREEN_NOTE, STATS_LOAD_BEGIN);
 	
-	const GRect max_text_bounds = GRect(0, 0, 144, 20000); // 20000 pixels of text
+	// The view is built on the first open only, later opens just rebind it
+	if (note_view_get_layer(&note_view) == NULL) {
+		Layer *note_window_layer = window_get_root_layer(me);
+		GRect bounds = layer_get_bounds(note_window_layer); // Window is 144x168
+		
+		// Initialize the note view with a nice readable font
+		note_view_init(&note_view, 
+					   bounds, 
+					   &note_stream, 
+					   &note_lines, 
+					   fonts_get_system_font(FONT_TYPE));
+		
+		// Add the layers for display
+		layer_add_child(note_window_layer, //Root layer of the window
+						note_view_get_layer(&note_view));
+		
+		// The go to bar, over the bottom of the note
+		jump_text = text_layer_create(GRect(0, bounds.size.h - 24, bounds.size.w, 24));
+		text_layer_set_background_color(jump_text, 
+										GColorBlack);
+		text_layer_set_text_color(jump_text, 
+								  GColorWhite);
+		text_layer_set_text_alignment(jump_text, 
+									  GTextAlignmentCenter);
+		layer_add_child(note_window_layer, 
+						text_layer_get_layer(jump_text));
+	}
+	jump_percent = -1;
+	jump_update();
 	
-	// Initialize the scroll layer
-	Layer *note_window_layer = window_get_root_layer(me);
-    GRect bounds = layer_get_bounds(note_window_layer);
-	scroll_layer = scroll_layer_create(bounds); // Window is 144x168
+	// A locked note reads with the key the PIN window left
+	NotePackEntry entry;
+	note_entry(note_selected_row, 
+			   &entry);
+	if (entry.flags & NOTE_PACK_FLAG_LOCKED) {
+		note_key = pin_key;
+		note_key_wipe(&pin_key);
+		note_lz_set_key(&note_key);
+	}
 	
-	// Set the initial max size
-	scroll_layer_set_content_size(scroll_layer, 
-								  max_text_bounds.size);
+	// Load the line table and the first window of text, unless the menu
+	// prefetched them. A search hit opens elsewhere, so it loads its own
+	if (!note_memory_open()) {
+		LOG_ERROR("###note_window_load: No memory for note %d###", note_selected_row);
+	}
+	if (note_selected_target || 
+		!note_prefetch_take(&note_prefetch, note_selected_row, entry.hash)) {
+		note_lines_open(&note_lines, 
+						entry.handle, 
+						entry.lines_offset);
+		note_stream_open(&note_stream, 
+						 entry.handle, 
+						 entry.offset);
+	}
+	LOG_DEBUG("###note_window_load: Note bytes: %d, readed: %d, lines: %d ###", (int)note_stream.size, (int)note_stream.length, (int)note_lines.count);
 	
-	// Initialize the text layer and load text
-	text_layer = text_layer_create(max_text_bounds);
+	note_view_bind(&note_view, 
+				   &note_stream, 
+				   &note_lines);
 	
-	note_selected_size = resource_size(resource_get_handle(note_selected));
-	if (TEXT_BUFFER_LEN < note_selected_size) note_selected_size = TEXT_BUFFER_LEN;
-	note_selected_size = resource_load(resource_get_handle(note_selected),
-									   (uint8_t*)note_view,
-									   note_selected_size);
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###note_window_load: Readed resource bytes: %d ###", note_selected_size);
+	note_scroll_init(&note_scroll, 
+					 &note_view, 
+					 AUTO_SCROLL_SPEED, 
+					 LONG_CLICK_SPEED, 
+					 LONG_CLICK_MAX_SPEED, 
+					 LONG_CLICK_ACCELERATION);
 	
-	//Transform 0x0d 0x0a to 0x20 0x\n
-	//text_transform(note_view);
+	// Jump to the line holding the selected offset, one line down so it has context above.
+	// Otherwise go back where the note was left
+	note_state_load(&note_state, 
+					entry.hash);
+	if (note_selected_target) {
+		uint32_t line = note_lines_find(&note_lines, 
+										note_selected_offset);
+		note_scroll_to(&note_scroll, 
+					   note_lines_y(&note_lines, line) - note_lines.line_height);
+	}
+	else {
+		note_scroll_to(&note_scroll, 
+					   note_state_top(&note_state, note_lines_height(&note_lines)));
+	}
 	
-	//Set text to the layer
-	text_layer_set_text(text_layer, 
-						note_view);
-		
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###note_window_load: post text_layer_set_text ###");
+		//window_set_status_bar_icon(&note_window,
+		//							 NORMAL );
 	
-	// Change the font to a nice readable one
-	text_layer_set_font(text_layer, 
-						fonts_get_system_font(FONT_TYPE));
+	STATS_HEAP(STATS_SCREEN_NOTE, STATS_LOAD_END);
+	STATS_END(STATS_NOTE_WINDOW_LOAD);
+	LOG_DEBUG("###note_window_load: Exiting###");
+}
 
-	// Trim text layer and scroll content to fit text box
-	GSize max_size = text_layer_get_content_size(text_layer);
-	text_layer_set_size(text_layer, 
-						max_size);
-						
-    const int vert_scroll_text_padding = 4;
-	scroll_layer_set_content_size(scroll_layer, 
-								  GSize(144, max_size.h + vert_scroll_text_padding));
+  /**
+   *  Unload the note window: stops the note and wipes its text, but keeps
+   *  the window and its layers for the next open
+   */
+void note_window_unload(Window *me) {
+	LOG_DEBUG("###note_window_unload: Entering###");
+	STATS_HEAP(STATS_SCREEN_NOTE, STATS_UNLOAD_BEGIN);
+	 
+	note_state_save(&note_state, 
+					note_view_get_offset(&note_view), 
+					note_lines_height(&note_lines));
+	note_scroll_deinit(&note_scroll);
+	// The menu may have started a prefetch already, its memory stays
+	if (note_prefetch.row < 0) {
+		note_memory_close();
+	}
+	else {
+		note_stream_close(&note_stream);
+	}
+	note_view_wipe(&note_view);
+	note_lz_set_key(NULL);
+	note_key_wipe(&note_key);
+	// Scrolling only queued its messages, log them now
+	logDrain();
 	
-	// Add the layers for display
-	scroll_layer_add_child(scroll_layer, 
-						   text_layer_get_layer(text_layer));
+	STATS_HEAP(STATS_SCREEN_NOTE, STATS_UNLOAD_END);
+	LOG_DEBUG("###note_window_unload: Exiting###");
+}
+
+  /**
+   *  Opens a note, scrolled to the line holding offset when target is set
+   */
+void note_window_show(int row, bool target, uint32_t offset) {
+	note_selected_row = row;
+	note_selected_target = target;
+	note_selected_offset = target ? offset : 0;
 	
-	layer_add_child(note_window_layer, //Root layer of the window
-					scroll_layer_get_layer(scroll_layer));
+	// Already showing a note: unload it so the push loads the new one
+	window_stack_remove(note_window, 
+						false);
 	
-		//window_set_status_bar_icon(&note_window,
-		//							 NORMAL );
+	//Push!
+	window_stack_push(note_window, 
+					  true);
+}
 	
-    window_set_click_config_provider(note_window, 
-									 (ClickConfigProvider)note_config_provider);
+
+///////////////////////////PIN WINDOW///////////////////////////
+  /**
+   *  One dot per push so far, and help, or a message when given
+   */
+void pin_update(const char *message) {
+	if (pin_dots_str == NULL) return;
+	for (size_t i = 0; i < pin_len; i++) {
+		pin_dots_str[2 * i] = '*';
+		pin_dots_str[2 * i + 1] = ' ';
+	}
+	pin_dots_str[2 * pin_len] = '\0';
+	text_layer_set_text(pin_dots_text, 
+						pin_dots_str);
+	text_layer_set_text(pin_help_text, 
+						message ? message : "Up, Down and Select\nmake the PIN");
+}
+
+  /**
+   *  Adds a push to the PIN and opens the note once the PIN is right. There
+   *  is no enter button: every PIN is tried as it grows, a wrong one starts
+   *  over after NOTE_PIN_MAX_LEN pushes.
+   */
+void pin_push(char push) {
+	if (pin_pushes == NULL) return;
+	pin_pushes[pin_len++] = push;
+	
+	if (pin_len >= NOTE_PIN_MIN_LEN && 
+		note_key_derive(&pin_key, pin_pushes, pin_len, pin_entry.hash) == pin_entry.check) {
+		LOG_INFO("###pin_push: Note %d unlocked###", pin_row);
+		// The note window takes the key as it loads, then the PIN window goes
+		note_window_show(pin_row, 
+						 false, 
+						 0);
+		window_stack_remove(pin_window, 
+							false);
+		return;
+	}
+	note_key_wipe(&pin_key);
 	
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###note_window_load: Exiting###");
+	if (pin_len == NOTE_PIN_MAX_LEN) {
+		LOG_INFO("###pin_push: Wrong PIN for note %d###", pin_row);
+		memset(pin_pushes, 0, NOTE_PIN_MAX_LEN);
+		pin_len = 0;
+		vibes_short_pulse();
+		pin_update("Wrong PIN\nTry again");
+		return;
+	}
+	pin_update(NULL);
+}
+
+void up_single_click_pin_window_handler(ClickRecognizerRef recognizer, void *context) {
+	pin_push(NOTE_PIN_UP);
+}
+
+void down_single_click_pin_window_handler(ClickRecognizerRef recognizer, void *context) {
+	pin_push(NOTE_PIN_DOWN);
+}
+
+void select_single_click_pin_window_handler(ClickRecognizerRef recognizer, void *context) {
+	pin_push(NOTE_PIN_SELECT);
+}
+
+void pin_config_provider(Window *window) {
+    window_single_click_subscribe(BUTTON_ID_UP, up_single_click_pin_window_handler);
+    window_single_click_subscribe(BUTTON_ID_DOWN, down_single_click_pin_window_handler);
+    window_single_click_subscribe(BUTTON_ID_SELECT, select_single_click_pin_window_handler);
 }
 
   /**
-   *  Unload the note window
+   *  Load the PIN window
    */
-void note_window_unload(Window *me) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###note_window_unload: Entering###");
-	 
-	int note_view_len = strlen(note_view);
-	for (int i=0; i<note_view_len; i++) {
-      note_view[i] = 0;
-    }
-    text_layer_destroy(text_layer);
-    scroll_layer_destroy(scroll_layer);
-    window_destroy(note_window);
+void pin_window_load(Window *me) {
+	STATS_HEAP(STATS_SCREEN_PIN, STATS_LOAD_BEGIN);
+	Layer *pin_window_layer = window_get_root_layer(me);
+	GRect bounds = layer_get_bounds(pin_window_layer);
 	
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###note_window_unload: Exiting###");
+	note_arena_open(&pin_arena, 
+					PIN_ARENA_LEN);
+	pin_pushes = note_arena_alloc(&pin_arena, 
+								  NOTE_PIN_MAX_LEN);
+	pin_dots_str = note_arena_alloc(&pin_arena, 
+									PIN_LINE_LEN);
+	
+	pin_title_text = text_layer_create(GRect(4, 8, bounds.size.w - 8, 30));
+	text_layer_set_font(pin_title_text, 
+						fonts_get_system_font(FONT_KEY_GOTHIC_24));
+	text_layer_set_text(pin_title_text, 
+						pin_entry.title);
+	pin_dots_text = text_layer_create(GRect(4, 44, bounds.size.w - 8, 34));
+	text_layer_set_font(pin_dots_text, 
+						fonts_get_system_font(FONT_KEY_GOTHIC_24));
+	pin_help_text = text_layer_create(GRect(4, 84, bounds.size.w - 8, bounds.size.h - 84));
+	text_layer_set_font(pin_help_text, 
+						fonts_get_system_font(FONT_KEY_GOTHIC_14));
+	
+	layer_add_child(pin_window_layer, 
+					text_layer_get_layer(pin_title_text));
+	layer_add_child(pin_window_layer, 
+					text_layer_get_layer(pin_dots_text));
+	layer_add_child(pin_window_layer, 
+					text_layer_get_layer(pin_help_text));
+	pin_update(NULL);
+	
+    window_set_click_config_provider(pin_window, 
+									 (ClickConfigProvider)pin_config_provider);
+	STATS_HEAP(STATS_SCREEN_PIN, STATS_LOAD_END);
+}
+
+  /**
+   *  Unload the PIN window, forgetting the pushes
+   */
+void pin_window_unload(Window *me) {
+	STATS_HEAP(STATS_SCREEN_PIN, STATS_UNLOAD_BEGIN);
+	pin_len = 0;
+	text_layer_destroy(pin_title_text);
+	text_layer_destroy(pin_dots_text);
+	text_layer_destroy(pin_help_text);
+	pin_pushes = pin_dots_str = NULL;
+	note_arena_close(&pin_arena);
+	STATS_HEAP(STATS_SCREEN_PIN, STATS_UNLOAD_END);
+	window_destroy(pin_window);
 }
+
+  /**
+   *  Asks the PIN of the locked note of row, then opens it
+   */
+void pin_window_show(int row) {
+	pin_row = row;
+	note_entry(row, 
+			   &pin_entry);
+	pin_len = 0;
 	
+	pin_window = window_create();
+	window_set_window_handlers(pin_window, 
+							   (WindowHandlers){
+									.load = pin_window_load,
+								    .unload = pin_window_unload,
+                               }
+							  );
+	window_stack_push(pin_window, 
+					  true);
+}
 
-///////////////////////////MAIN WINDOW///////////////////////////
+
+///////////////////////////TABLE WINDOW///////////////////////////
+  /**
+   *  One page of rows up
+   */
+void up_single_click_table_window_handler(ClickRecognizerRef recognizer, void *context) {
+	note_table_view_scroll(&note_table_view, 
+						   -(int32_t)note_table_view_page_rows(&note_table_view));
+}
+
+  /**
+   *  One page of rows down
+   */
+void down_single_click_table_window_handler(ClickRecognizerRef recognizer, void *context) {
+	note_table_view_scroll(&note_table_view, 
+						   note_table_view_page_rows(&note_table_view));
+}
+
+  /**
+   *  Next page of columns
+   */
+void select_single_click_table_window_handler(ClickRecognizerRef recognizer, void *context) {
+	note_table_view_next_columns(&note_table_view);
+}
+
+  /**
+   *  Holding select finds a row by key, with the letters of the search window
+   */
+void select_long_click_table_window_handler(ClickRecognizerRef recognizer, void *context) {
+	if (note_table.keys == 0) return;
+	search_lookup_show(&note_table);
+}
+
+void table_config_provider(Window *window) {
+	window_single_repeating_click_subscribe(BUTTON_ID_UP, 150, up_single_click_table_window_handler);
+	window_single_repeating_click_subscribe(BUTTON_ID_DOWN, 150, down_single_click_table_window_handler);
+    window_single_click_subscribe(BUTTON_ID_SELECT, select_single_click_table_window_handler);
+	
+    window_long_click_subscribe(BUTTON_ID_SELECT, 700, select_long_click_table_window_handler, NULL);
+}
+
+  /**
+   *  Load the table window: reads the table header only, the view reads
+   *  the cells it shows
+   */
+void table_window_load(Window *me) {
+	LOG_DEBUG("###table_window_load: Entering###");
+	STATS_HEAP(STATS_SCREEN_TABLE, STATS_LOAD_BEGIN);
+	
+	NotePackEntry entry;
+	note_entry(note_selected_row, 
+			   &entry);
+	note_table_open(&note_table, 
+					entry.handle, 
+					entry.offset);
+	size_t seeds = note_table_keys_len(&note_table);
+	if (seeds > 0 && note_arena_open(&table_arena, TABLE_ARENA_LEN(seeds))) {
+		note_table_load_keys(&note_table, 
+							 note_arena_alloc(&table_arena, seeds));
+	}
+	
+	// Like the note window, the view is built once and rebound after
+	if (note_table_view_get_layer(&note_table_view) == NULL) {
+		Layer *table_window_layer = window_get_root_layer(me);
+		note_table_view_init(&note_table_view, 
+							 layer_get_bounds(table_window_layer), 
+							 &note_table, 
+							 fonts_get_system_font(FONT_TYPE));
+		layer_add_child(table_window_layer, 
+						note_table_view_get_layer(&note_table_view));
+	}
+	note_table_view_bind(&note_table_view, 
+						 &note_table);
+	
+	STATS_HEAP(STATS_SCREEN_TABLE, STATS_LOAD_END);
+	LOG_DEBUG("###table_window_load: %d rows, %d columns, %d keys###", note_table.rows, note_table.columns, note_table.keys);
+}
+
+void table_window_unload(Window *me) {
+	STATS_HEAP(STATS_SCREEN_TABLE, STATS_UNLOAD_BEGIN);
+	note_table_unload_keys(&note_table);
+	note_arena_close(&table_arena);
+	STATS_HEAP(STATS_SCREEN_TABLE, STATS_UNLOAD_END);
+}
+
+  /**
+   *  Opens a CSV note as a table
+   */
+void table_window_show(int row) {
+	note_selected_row = row;
+	window_stack_push(table_window, 
+					  true);
+}
+
+
+///////////////////////////SEARCH WINDOW///////////////////////////
+
+  /**
+   *  Results header: how many hits and for what
+   */
+int16_t results_get_header_height_callback(MenuLayer *me, uint16_t section_index, void *data) {
+	return MENU_CELL_BASIC_HEADER_HEIGHT;
+}
+
+uint16_t results_get_num_rows_callback(MenuLayer *me, uint16_t section_index, void *data) {
+	return search_hit_count;
+}
+
+void results_draw_header_callback(GContext* ctx, const Layer *cell_layer, uint16_t section_index, void *data) {
+	size_t mark = note_arena_mark(&results_arena);
+	char *header = note_arena_alloc(&results_arena, 
+									SEARCH_LINE_LEN);
+	
+	if (header == NULL) return;
+	if (search_total == 0) {
+		mini_snprintf(header, SEARCH_LINE_LEN, "No hits for %s", search_query);
+	}
+	else if (search_total > search_hit_count) {
+		mini_snprintf(header, SEARCH_LINE_LEN, "%d of %d for %s", (int)search_hit_count, (int)search_total, search_query);
+	}
+	else {
+		mini_snprintf(header, SEARCH_LINE_LEN, "%d hits for %s", (int)search_total, search_query);
+	}
+	menu_cell_basic_header_draw(ctx, 
+								cell_layer, 
+								header);
+	note_arena_release(&results_arena, 
+					   mark);
+}
+
+  /**
+   *  Each hit shows the line around the word and where it is
+   */
+void results_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuIndex *cell_index, void *data) {
+	size_t mark = note_arena_mark(&results_arena);
+	char *where = note_arena_alloc(&results_arena, 
+								   SEARCH_LINE_LEN);
+	NoteSearchHit *hit = &search_hits[cell_index->row];
+	NotePackEntry entry;
+	
+	if (where == NULL) return;
+	note_pack_entry(&note_pack, 
+					hit->note, 
+					&entry);
+	mini_snprintf(where, 
+				  SEARCH_LINE_LEN, 
+				  "%d%% %s", 
+				  hit->percent, 
+				  entry.title);
+	menu_cell_basic_draw(ctx, 
+						 cell_layer, 
+						 hit->snippet, 
+						 where, 
+						 NULL);
+	note_arena_release(&results_arena, 
+					   mark);
+}
+
+  /**
+   *  Opens the note of a hit scrolled to the word
+   */
+void results_select_callback(MenuLayer *me, MenuIndex *cell_index, void *data) {
+	NoteSearchHit *hit = &search_hits[cell_index->row];
+	LOG_INFO("###results_select_callback: Note %d offset %d###", hit->note, (int)hit->offset);
+	
+	note_window_show(hit->note, 
+					 true, 
+					 hit->offset);
+}
+
+void results_window_load(Window *me) {
+	STATS_HEAP(STATS_SCREEN_RESULTS, STATS_LOAD_BEGIN);
+	Layer *results_window_layer = window_get_root_layer(me);
+	note_arena_open(&results_arena, 
+					RESULTS_ARENA_LEN);
+	
+	results_layer = menu_layer_create(layer_get_bounds(results_window_layer));
+	menu_layer_set_callbacks(results_layer, 
+							 NULL, 
+							 (MenuLayerCallbacks){
+								.get_num_rows = results_get_num_rows_callback,
+								.get_header_height = results_get_header_height_callback,
+								.draw_header = results_draw_header_callback,
+								.draw_row = results_draw_row_callback,
+								.select_click = results_select_callback,
+	                         }
+							);
+	menu_layer_set_click_config_onto_window(results_layer, 
+											me);
+	layer_add_child(results_window_layer, 
+					menu_layer_get_layer(results_layer));
+	STATS_HEAP(STATS_SCREEN_RESULTS, STATS_LOAD_END);
+}
+
+void results_window_unload(Window *me) {
+	STATS_HEAP(STATS_SCREEN_RESULTS, STATS_UNLOAD_BEGIN);
+	menu_layer_destroy(results_layer);
+	note_arena_close(&results_arena);
+	STATS_HEAP(STATS_SCREEN_RESULTS, STATS_UNLOAD_END);
+	window_destroy(results_window);
+}
+
+  /**
+   *  Hits for the query, or 1/0 whether a table row has it as key
+   */
+static int search_window_hits(void) {
+	uint32_t first, last;
+	if (search_table) {
+		return note_table_find(search_table, search_query, NULL) >= 0;
+	}
+	return note_index_lookup(&note_index, search_query, &first, &last);
+}
 
   /**
-   *  This function links numbers with resources
-   */
-uint32_t row_to_resource(int row) {
-	switch (row) {
-#if NUM_NOTES > 0
-		case 0:    return RESOURCE_ID_NOTE0;
-#endif		
-#if NUM_NOTES > 1
-		case 1:    return RESOURCE_ID_NOTE1;
-#endif		
-#if NUM_NOTES > 2
-		case 2:    return RESOURCE_ID_NOTE2;
-#endif		
-#if NUM_NOTES > 3
-		case 3:    return RESOURCE_ID_NOTE3;
-#endif		
-#if NUM_NOTES > 4
-		case 4:    return RESOURCE_ID_NOTE4;
-#endif		
-#if NUM_NOTES > 5
-		case 5:    return RESOURCE_ID_NOTE5;
-#endif		
-#if NUM_NOTES > 6
-		case 6:    return RESOURCE_ID_NOTE6;
-#endif		
-#if NUM_NOTES > 7
-		case 7:    return RESOURCE_ID_NOTE7;
-#endif		
-#if NUM_NOTES > 8
-		case 8:    return RESOURCE_ID_NOTE8;
-#endif		
-#if NUM_NOTES > 9
-		case 9:    return RESOURCE_ID_NOTE9;
-#endif		
-	}
-	return RESOURCE_ID_NOTE0;
+   *  What search_window_hits counts: hits in the notes, rows in a table
+   */
+static const char *search_window_unit(int hits) {
+	if (search_table) return (hits == 1) ? "row" : "rows";
+	return (hits == 1) ? "hit" : "hits";
 }
+
+  /**
+   *  Refreshes the query and the letter about to be added, with the hits
+   *  each one would get
+   */
+void search_window_update(void) {
+	size_t len = strlen(search_query);
+	int hits;
+	
+	if (search_query_str == NULL) return;
+	if (len == 0) {
+		mini_snprintf(search_query_str, SEARCH_LINE_LEN, "_");
+	}
+	else {
+		hits = search_window_hits();
+		mini_snprintf(search_query_str, 
+					  SEARCH_LINE_LEN, 
+					  "%s (%d %s)", 
+					  search_query, 
+					  hits, 
+					  search_window_unit(hits));
+	}
+	text_layer_set_text(search_query_text, 
+						search_query_str);
 	
+	if (len < NOTE_SEARCH_KEY_LEN) {
+		search_query[len] = SEARCH_ALPHABET[search_letter];
+		search_query[len + 1] = '\0';
+		hits = search_window_hits();
+		mini_snprintf(search_letter_str, 
+					  SEARCH_LINE_LEN, 
+					  "+ %c (%d %s)", 
+					  SEARCH_ALPHABET[search_letter], 
+					  hits, 
+					  search_window_unit(hits));
+		search_query[len] = '\0';
+	}
+	else {
+		search_letter_str[0] = '\0';
+	}
+	text_layer_set_text(search_letter_text, 
+						search_letter_str);
+}
+
+  /**
+   *  Up and down pick the letter to add
+   */
+void up_single_click_search_window_handler(ClickRecognizerRef recognizer, void *context) {
+	int letters = strlen(SEARCH_ALPHABET);
+	search_letter = (search_letter + letters - 1) % letters;
+	search_window_update();
+}
+
+void down_single_click_search_window_handler(ClickRecognizerRef recognizer, void *context) {
+	search_letter = (search_letter + 1) % strlen(SEARCH_ALPHABET);
+	search_window_update();
+}
+
+  /**
+   *  Select adds the letter to the query
+   */
+void select_single_click_search_window_handler(ClickRecognizerRef recognizer, void *context) {
+	size_t len = strlen(search_query);
+	if (len < NOTE_SEARCH_KEY_LEN) {
+		search_query[len] = SEARCH_ALPHABET[search_letter];
+		search_query[len + 1] = '\0';
+	}
+	search_window_update();
+}
+
+  /**
+   *  Back removes the last letter, or leaves when the query is empty
+   */
+void back_single_click_search_window_handler(ClickRecognizerRef recognizer, void *context) {
+	size_t len = strlen(search_query);
+	if (len == 0) {
+		window_stack_pop(true);
+		return;
+	}
+	search_query[len - 1] = '\0';
+	search_window_update();
+}
+
+  /**
+   *  Holding select runs the query and shows the hits
+   */
+void select_long_click_search_window_handler(ClickRecognizerRef recognizer, void *context) {
+	LOG_DEBUG("###select_long_click_search_window_handler: Query %s###", search_query);
+	if (search_query[0] == '\0') return;
+	
+	// Finding a row goes back to the table, on it
+	if (search_table) {
+		int32_t row = note_table_find(search_table, 
+									  search_query, 
+									  NULL);
+		LOG_INFO("###select_long_click_search_window_handler: Key %s at row %d###", search_query, (int)row);
+		if (row < 0) return;
+		window_stack_pop(true);
+		note_table_view_show_row(&note_table_view, 
+								 row);
+		return;
+	}
+	
+	STATS_BEGIN(STATS_SEARCH);
+	search_hit_count = note_search_run(&note_index, 
+									   search_query, 
+									   search_hits, 
+									   NOTE_SEARCH_MAX_HITS, 
+									   &search_total);
+	// The decoded blocks are scratch, given back once the snippets are made
+	size_t mark = note_arena_mark(&search_arena);
+	note_search_snippets(search_hits, 
+						 search_hit_count, 
+						 &note_pack, 
+						 note_arena_alloc(&search_arena, NOTE_SEARCH_BLOCK_LEN));
+	note_arena_release(&search_arena, 
+					   mark);
+	STATS_END(STATS_SEARCH);
+	LOG_INFO("###select_long_click_search_window_handler: %d hits, showing %d###", (int)search_total, (int)search_hit_count);
+	
+	results_window = window_create();
+	window_set_window_handlers(results_window, 
+							   (WindowHandlers){
+									.load = results_window_load,
+								    .unload = results_window_unload,
+                               }
+							  );
+	window_stack_push(results_window, 
+					  true);
+}
+
+void search_config_provider(Window *window) {
+	window_single_repeating_click_subscribe(BUTTON_ID_UP, 150, up_single_click_search_window_handler);
+	window_single_repeating_click_subscribe(BUTTON_ID_DOWN, 150, down_single_click_search_window_handler);
+    window_single_click_subscribe(BUTTON_ID_SELECT, select_single_click_search_window_handler);
+	window_single_click_subscribe(BUTTON_ID_BACK, back_single_click_search_window_handler);
+	
+    window_long_click_subscribe(BUTTON_ID_SELECT, 700, select_long_click_search_window_handler, NULL);
+}
+
+  /**
+   *  Load the search window
+   */
+void search_window_load(Window *me) {
+	LOG_DEBUG("###search_window_load: Entering###");
+	STATS_HEAP(STATS_SCREEN_SEARCH, STATS_LOAD_BEGIN);
+	
+	Layer *search_window_layer = window_get_root_layer(me);
+	GRect bounds = layer_get_bounds(search_window_layer);
+	
+	note_arena_open(&search_arena, 
+					SEARCH_ARENA_LEN);
+	search_query_str = note_arena_alloc(&search_arena, 
+										SEARCH_LINE_LEN);
+	search_letter_str = note_arena_alloc(&search_arena, 
+										 SEARCH_LINE_LEN);
+	if (search_table == NULL) {
+		note_index_open(&note_index, 
+						note_pack.handle, 
+						note_pack.index_offset);
+	}
+	
+	search_query_text = text_layer_create(GRect(4, 8, bounds.size.w - 8, 34));
+	text_layer_set_font(search_query_text, 
+						fonts_get_system_font(FONT_KEY_GOTHIC_28));
+	search_letter_text = text_layer_create(GRect(4, 44, bounds.size.w - 8, 30));
+	text_layer_set_font(search_letter_text, 
+						fonts_get_system_font(FONT_KEY_GOTHIC_24));
+	search_help_text = text_layer_create(GRect(4, 80, bounds.size.w - 8, bounds.size.h - 80));
+	text_layer_set_font(search_help_text, 
+						fonts_get_system_font(FONT_KEY_GOTHIC_14));
+	text_layer_set_text(search_help_text, 
+						search_table ? "Up/Down: letter\nSelect: add it\nBack: delete\nHold select: go to it" 
+									 : "Up/Down: letter\nSelect: add it\nBack: delete\nHold select: search");
+	
+	layer_add_child(search_window_layer, 
+					text_layer_get_layer(search_query_text));
+	layer_add_child(search_window_layer, 
+					text_layer_get_layer(search_letter_text));
+	layer_add_child(search_window_layer, 
+					text_layer_get_layer(search_help_text));
+	search_window_update();
+	
+    window_set_click_config_provider(search_window, 
+									 (ClickConfigProvider)search_config_provider);
+	
+	STATS_HEAP(STATS_SCREEN_SEARCH, STATS_LOAD_END);
+	LOG_DEBUG("###search_window_load: Exiting###");
+}
+
+void search_window_unload(Window *me) {
+	STATS_HEAP(STATS_SCREEN_SEARCH, STATS_UNLOAD_BEGIN);
+	text_layer_destroy(search_query_text);
+	text_layer_destroy(search_letter_text);
+	text_layer_destroy(search_help_text);
+	search_query_str = search_letter_str = NULL;
+	note_arena_close(&search_arena);
+	STATS_HEAP(STATS_SCREEN_SEARCH, STATS_UNLOAD_END);
+	window_destroy(search_window);
+	
+	// Back to words, with the query from before the lookup
+	if (search_table) {
+		search_table = NULL;
+		strncpy(search_query, 
+				search_saved, 
+				sizeof(search_query));
+	}
+}
+
+  /**
+   *  Opens the search window, keeping the last query
+   */
+void search_window_show(void) {
+	search_window = window_create();
+	window_set_window_handlers(search_window, 
+							   (WindowHandlers){
+									.load = search_window_load,
+								    .unload = search_window_unload,
+                               }
+							  );
+	window_stack_push(search_window, 
+					  true);
+}
+
+  /**
+   *  Opens the search window to find a row of table by key, starting from
+   *  an empty key
+   */
+void search_lookup_show(NoteTable *table) {
+	strncpy(search_saved, 
+			search_query, 
+			sizeof(search_saved));
+	search_query[0] = '\0';
+	search_table = table;
+	search_window_show();
+}
+
+
+///////////////////////////MAIN WINDOW///////////////////////////
+
   /**
    *  This callback is used to specify the amount of sections of menu items
    *  With this, you can dynamically add and remove sections
@@ -497,7 +1321,9 @@ uint16_t menu_get_num_sections_callback(MenuLayer *me, void *data) {
 uint16_t menu_get_num_rows_callback(MenuLayer *me, uint16_t section_index, void *data) {
 	switch (section_index) {
         case 0:
-            return NUM_FIRST_MENU_ITEMS;
+            return note_count();
+        case 1:
+            return NUM_SECOND_MENU_ITEMS;
 
         default:
             return 0;
@@ -526,55 +1352,139 @@ void menu_draw_header_callback(GContext* ctx, const Layer *cell_layer, uint16_t
 										cell_layer, 
 										"Your notes");
             break;
+        case 1:
+            menu_cell_basic_header_draw(ctx,
+										cell_layer, 
+										"Search");
+            break;
+	}
+}
+
+	
+void note_meta_close(void) {
+	note_meta = NULL;
+	note_meta_len = 0;
+	note_arena_close(&main_arena);
+}
+
+  /**
+   *  Opens the row cache empty, with a slot for each note, or as many as
+   *  its share of the heap holds
+   */
+void note_meta_open(void) {
+	note_meta_close();
+	uint32_t rows = note_count();
+	uint32_t fit = heap_bytes_free() / NOTE_META_HEAP_SHARE / sizeof(NoteMeta);
+	if (rows > fit) {
+		LOG_WARNING("###note_meta_open: %d notes, the cache holds %d###", (int)rows, (int)fit);
+		rows = fit;
+	}
+	if (rows == 0) rows = 1;
+	if (note_arena_open(&main_arena, MAIN_ARENA_LEN(rows))) {
+		note_meta = note_arena_alloc(&main_arena, 
+									 rows * sizeof(NoteMeta));
+		note_meta_len = rows;
+		for (uint32_t i = 0; i < note_meta_len; i++) {
+			note_meta[i].row = -1;
+		}
 	}
 }
 
+  /**
+   *  Returns the cached menu row of the note of entry, filling it the first
+   *  time, or NULL when the menu has no heap for its cache
+   */
+NoteMeta *note_meta_get(int row, const NotePackEntry *entry) {
+	if (note_meta == NULL) return NULL;
+	NoteMeta *meta = &note_meta[row % note_meta_len];
+	if (meta->row == row) {
+		note_meta_hits++;
+		return meta;
+	}
+	note_meta_misses++;
+	
+	NoteLz note;
+	char read_buffer[NOTE_META_HEAD_LEN];
+	size_t read = 0;
+	meta->row = row;
+	
+	// Tables have no text to preview, their size tells more
+	if (entry->flags & NOTE_PACK_FLAG_TABLE) {
+		mini_snprintf(meta->preview, 
+					  TITLE_BUFFER_LEN, 
+					  "Table, %d rows", 
+					  note_table_count_rows(entry->handle, entry->offset));
+		return meta;
+	}
+	// Locked notes keep their text to themselves
+	if (entry->flags & NOTE_PACK_FLAG_LOCKED) {
+		strncpy(meta->preview, 
+				"Locked", 
+				TITLE_BUFFER_LEN);
+		return meta;
+	}
+	
+	if (note_lz_open(&note, 
+					 entry->handle, 
+					 entry->offset)) {
+		read = note_lz_read_block(&note, 
+								  0, 
+								  read_buffer, 
+								  NOTE_META_HEAD_LEN);
+	}
 	
+	// The title is the first line of the note, preview what follows it
+	size_t skip = 0;
+	while (skip < read && (read_buffer[skip] == '\n' || read_buffer[skip] == ' ')) skip++;
+	while (skip < read && read_buffer[skip] != '\n') skip++;
+	note_text_one_line(meta->preview, 
+					   TITLE_BUFFER_LEN, 
+					   read_buffer + skip, 
+					   read - skip);
+	return meta;
+}
+
   /**
    *  This is the menu item draw callback where you specify what each item should look like
    */
 void menu_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuIndex *cell_index, void *data) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###menu_draw_row_callback: Entering###");
+	LOG_DEFER_DEBUG("###menu_draw_row_callback: section %d, row %d###", cell_index->section, cell_index->row);
+	STATS_BEGIN(STATS_MENU_DRAW_ROW);
 	// Determine which section we're going to draw in
 	
 	switch (cell_index->section) {
 	    case 0:
-			if (cell_index->row < NUM_NOTES) {
-				uint32_t resource_name = row_to_resource(cell_index->row);
-								
-				#define TITLE_BUFFER_LEN 30
-				char note_title[TITLE_BUFFER_LEN];		
-				char note_preview[TITLE_BUFFER_LEN];	
-				char read_buffer[TITLE_BUFFER_LEN];	
-				
-				// Retrieve resource
-				resource_load(resource_get_handle(resource_name),
-							  (uint8_t*)read_buffer,
-							  TITLE_BUFFER_LEN);	
-				
-				// mini_snprintf to add endline character to note_preview
-				mini_snprintf(note_preview, 
-							  TITLE_BUFFER_LEN, 
-							  "%s", 
-							  read_buffer);
-	
-				// mini_snprintf to add endline character and format to note_title
-				mini_snprintf(note_title, 
-							  TITLE_BUFFER_LEN, 
-							  "Note %d (%dB)", 
-							  cell_index->row,
-							  resource_size(resource_get_handle(resource_name)));
+			if (cell_index->row < note_count()) {
+				// Title and size from the table of contents, the preview from the cache
+				NotePackEntry entry;
+				char title[NOTE_META_TITLE_LEN];
+				note_entry(cell_index->row, 
+						   &entry);
+				NoteMeta *meta = note_meta_get(cell_index->row, 
+											   &entry);
+				if (meta == NULL) break;
+				mini_snprintf(title, 
+							  NOTE_META_TITLE_LEN, 
+							  "%s (%dB)", 
+							  entry.title, 
+							  (int)entry.size);
 				
 				menu_cell_basic_draw(ctx, 
 									 cell_layer, 
-									 note_title, 
-									 note_preview, 
+									 title, 
+									 meta->preview, 
 									 NULL);
 		    }
             break;
+	    case 1:
+			menu_cell_basic_draw(ctx, 
+								 cell_layer, 
+								 "Find a word", 
+								 "In all your notes", 
+								 NULL);
+            break;
 	}
-	
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###menu_draw_row_callback: Exiting###");
+	STATS_END(STATS_MENU_DRAW_ROW);
 }
 
 
@@ -582,34 +1492,76 @@ void menu_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuIndex *c
    *  Here we capture when a user selects a menu item
    */
 void menu_select_callback(MenuLayer *me, MenuIndex *cell_index, void *data) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###menu_select_callback: Entering###");
-	app_log(APP_LOG_LEVEL_INFO, "main.c", 0, "###menu_select_callback: Item selected section %d, row %d###", cell_index->section, cell_index->row);
+	LOG_DEBUG("###menu_select_callback: Entering###");
+	LOG_INFO("###menu_select_callback: Item selected section %d, row %d###", cell_index->section, cell_index->row);
 
-	note_selected = row_to_resource(cell_index->row);
-		
-	// Initialize main window but dont push it
-	note_window = window_create();
-	
-	// Setup window handlers
-	window_set_window_handlers(note_window, 
-							   (WindowHandlers){
-									.load = note_window_load,
-								    .unload = note_window_unload,
-                               }
-							  );
+	switch (cell_index->section) {
+		case 0: {
+			NotePackEntry entry;
+			note_entry(cell_index->row, 
+					   &entry);
+			if (entry.flags & NOTE_PACK_FLAG_TABLE) {
+				table_window_show(cell_index->row);
+			}
+			else if (entry.flags & NOTE_PACK_FLAG_LOCKED) {
+				pin_window_show(cell_index->row);
+			}
+			else {
+				note_window_show(cell_index->row, 
+								 false, 
+								 0);
+			}
+			break;
+		}
+		case 1:
+			search_window_show();
+			break;
+	}
+
+	LOG_DEBUG("###menu_select_callback: Exiting###");
+}
+
+  /**
+   *  The highlight moved: prefetch the note now under it
+   */
+void menu_selection_changed_callback(MenuLayer *me, MenuIndex new_index, MenuIndex old_index, void *data) {
+	NotePackEntry entry;
+	if (new_index.section == 0 && 
+		note_entry(new_index.row, &entry)) {
+		note_prefetch_start(&note_prefetch, 
+							new_index.row, 
+							&entry);
+	}
+	else {
+		note_prefetch_reset(&note_prefetch);
+	}
 	
-	//Push!
-	window_stack_push(note_window, 
-					  true);
+	// Note memory only for the note being prefetched, none for other rows
+	if (note_prefetch.row >= 0 && !note_memory_open()) {
+		note_prefetch_reset(&note_prefetch);
+	}
+	if (note_prefetch.row < 0 && !window_stack_contains_window(note_window)) {
+		note_memory_close();
+	}
+}
 
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###menu_select_callback: Exiting###");
+#if STATS_ENABLED
+  /**
+   *  A long push on any row opens the hidden stats window
+   */
+void menu_select_long_callback(MenuLayer *me, MenuIndex *cell_index, void *data) {
+	stats_window_show();
 }
+#endif
 
   /**
    *  This initializes the menu upon main_window load
    */
 void main_window_load(Window *me) {
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###main_window_load: Entering###");
+	LOG_DEBUG("###main_window_load: Entering###");
+	STATS_HEAP(STATS_SCREEN_MAIN, STATS_LOAD_BEGIN);
+	
+	note_meta_open();
 	
 	// Now we prepare to initialize the menu layer
     Layer *main_window_layer = window_get_root_layer(me);
@@ -628,6 +1580,10 @@ void main_window_load(Window *me) {
 								.draw_header = menu_draw_header_callback,
 								.draw_row = menu_draw_row_callback,
 								.select_click = menu_select_callback,
+								.selection_changed = menu_selection_changed_callback,
+#if STATS_ENABLED
+								.select_long_click = menu_select_long_callback,
+#endif
 	                         }
 							);
 
@@ -639,14 +1595,63 @@ void main_window_load(Window *me) {
 	layer_add_child(main_window_layer, 
 					menu_layer_get_layer(menu_layer));
 			
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###main_window_load: Exiting###");
+	STATS_HEAP(STATS_SCREEN_MAIN, STATS_LOAD_END);
+	LOG_DEBUG("###main_window_load: Exiting###");
+}
+
+  /**
+   *  Synced notes came or went: rows move, so rebuild the menu, and close a
+   *  synced note being rewritten under its window
+   */
+void note_sync_changed_handler(void) {
+	LOG_INFO("###note_sync_changed_handler: %d synced notes###", (int)note_store_count());
+	
+	note_prefetch_reset(&note_prefetch);
+	if (window_stack_contains_window(note_window) && note_selected_row >= (int)note_pack.count) {
+		window_stack_remove(note_window, 
+							false);
+	}
+	if (note_arena_is_open(&main_arena)) {
+		note_meta_open();
+	}
+	if (menu_layer) {
+		menu_layer_reload_data(menu_layer);
+		// The highlighted row may hold another note now
+		if (window_stack_get_top_window() == main_window) {
+			menu_selection_changed_callback(menu_layer, 
+											menu_layer_get_selected_index(menu_layer), 
+											menu_layer_get_selected_index(menu_layer), 
+											NULL);
+		}
+	}
+}
+
+  /**
+   *  Back on the menu: prefetch the highlighted note again
+   */
+void main_window_appear(Window *me) {
+	menu_selection_changed_callback(menu_layer, 
+									menu_layer_get_selected_index(menu_layer), 
+									menu_layer_get_selected_index(menu_layer), 
+									NULL);
+}
+
+  /**
+   *  Another window covers the menu: no more prefetching, what is loaded
+   *  stays for the note window to take
+   */
+void main_window_disappear(Window *me) {
+	note_prefetch_stop(&note_prefetch);
 }
 
   /**
    *  This unload the main window
    */
 void main_window_unload(Window *me) {
+	STATS_HEAP(STATS_SCREEN_MAIN, STATS_UNLOAD_BEGIN);
     menu_layer_destroy(menu_layer);
+	note_meta_close();
+	STATS_HEAP(STATS_SCREEN_MAIN, STATS_UNLOAD_END);
     window_destroy(main_window);
 }
 
@@ -656,7 +1661,16 @@ void main_window_unload(Window *me) {
    *  Main
    */
 void init() {	
-    app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###init: Entering###");
+    LOG_DEBUG("###init: Entering###");
+	
+	// Open the notes, the menu cache comes with the menu
+	note_pack_open(&note_pack, 
+				   RESOURCE_ID_NOTE_PACK);
+	note_sync_init(note_sync_changed_handler);
+	note_prefetch_init(&note_prefetch, 
+					   &note_stream, 
+					   &note_lines, 
+					   PREFETCH_BUDGET);
 	
 	// Initialize main window and push it to the front of the screen
 	main_window = window_create();
@@ -665,30 +1679,74 @@ void init() {
 	window_set_window_handlers(main_window, 
 							   (WindowHandlers){
 									.load   = main_window_load,
+									.appear = main_window_appear,
+									.disappear = main_window_disappear,
 								    .unload = main_window_unload,
                                }
 							  );  
 							  
     window_stack_push(main_window, true);
+	
+	// The note window lives as long as the app, each open rebinds it
+	note_window = window_create();
+	window_set_window_handlers(note_window, 
+							   (WindowHandlers){
+									.load = note_window_load,
+								    .unload = note_window_unload,
+                               }
+							  );
+    window_set_click_config_provider(note_window, 
+									 (ClickConfigProvider)note_config_provider);
+	
+	table_window = window_create();
+	window_set_window_handlers(table_window, 
+							   (WindowHandlers){
+									.load = table_window_load,
+								    .unload = table_window_unload,
+                               }
+							  );
+    window_set_click_config_provider(table_window, 
+									 (ClickConfigProvider)table_config_provider);
 							  
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###init: Exiting###");
+	LOG_DEBUG("###init: Exiting###");
 }
 
 void deinit() {	
-    app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###deinit: Entering###");
-	app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###deinit: Exiting###");
+    LOG_DEBUG("###deinit: Entering###");
+	LOG_INFO("###deinit: Menu cache hits %d, misses %d###", (int)note_meta_hits, (int)note_meta_misses);
+	STATS_DUMP();
+	note_prefetch_stop(&note_prefetch);
+	note_sync_deinit();
+	
+	window_stack_remove(note_window, 
+						false);
+	if (note_view_get_layer(&note_view) != NULL) {
+		note_view_deinit(&note_view);
+		text_layer_destroy(jump_text);
+	}
+	window_destroy(note_window);
+	
+	window_stack_remove(table_window, 
+						false);
+	if (note_table_view_get_layer(&note_table_view) != NULL) {
+		note_table_view_deinit(&note_table_view);
+	}
+	window_destroy(table_window);
+	LOG_DEBUG("###deinit: Exiting###");
+	logDrain();
 }
 
   /**
    *  Main
    */
 int main(void) {
-    app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###main: Entering###");
+    LOG_DEBUG("###main: Entering###");
 	
 	init();
 	app_event_loop();
 	deinit();
 	
-    app_log(APP_LOG_LEVEL_DEBUG, "main.c", 0, "###main: Exiting###");
+    LOG_DEBUG("###main: Exiting###");
+	return 0;
 }
 
@@ -12,155 +12,266 @@
  *      glibc snprintf():   34860 bytes     (+24092 bytes)
  * Wasting nearly 24kB of memory just for snprintf() on
  * a chip with 32kB flash is crazy. Use mini_snprintf() instead.
+ *
+ * Supported: %d %i %u %x %X %c %s %%, the 'l' length modifier,
+ * a field width (digits or '*') and the '0' and '-' flags.
+ * The formatter writes through a sink, so output can go straight
+ * to a buffer, a log or a text layer without copies, and it keeps
+ * no state outside its stack frame, so it is reentrant.
  */
 
 #include <string.h>
 #include <stdarg.h>
 #include "mini-printf.h"
 
-static unsigned int
-mini_strlen(const char *s)
-{
-	unsigned int len = 0;
-	while (s[len] != '\0') len++;
-	return len;
-}
+/* Room for the digits of a 64 bit value */
+#define MINI_NUM_LEN 24
+#define MINI_PAD_LEN 16
 
-static unsigned int
-mini_itoa(int value, unsigned int radix, unsigned int uppercase,
-	 char *buffer, unsigned int zero_pad)
-{
-	char	*pbuffer = buffer;
-	int	negative = 0;
-	unsigned int	i, len;
+static const char mini_digits_lower[] = "0123456789abcdef";
+static const char mini_digits_upper[] = "0123456789ABCDEF";
+static const char mini_zeros[MINI_PAD_LEN + 1] = "0000000000000000";
+static const char mini_spaces[MINI_PAD_LEN + 1] = "                ";
 
-	/* No support for unusual radixes. */
-	if (radix > 16)
-		return 0;
+/* Two decimal digits per lookup, halves the divisions */
+static const char mini_pairs[200] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/*
+ * Writes value right aligned into the end of buffer, returns where
+ * the digits start. No reversal needed.
+ */
+static char *
+mini_utoa(unsigned long value, unsigned int radix, int uppercase, char *end)
+{
+	char *p = end;
 
-	if (value < 0) {
-		negative = 1;
-		value = -value;
+	if (radix == 10) {
+		while (value >= 100) {
+			unsigned int pair = (unsigned int)(value % 100) * 2;
+			value /= 100;
+			*(--p) = mini_pairs[pair + 1];
+			*(--p) = mini_pairs[pair];
+		}
+		if (value >= 10) {
+			unsigned int pair = (unsigned int)value * 2;
+			*(--p) = mini_pairs[pair + 1];
+			*(--p) = mini_pairs[pair];
+		}
+		else {
+			*(--p) = '0' + (char)value;
+		}
+		return p;
 	}
 
-	/* This builds the string back to front ... */
+	const char *digits = uppercase ? mini_digits_upper : mini_digits_lower;
 	do {
-		int digit = value % radix;
-		*(pbuffer++) = (digit < 10 ? '0' + digit : (uppercase ? 'A' : 'a') + digit - 10);
-		value /= radix;
+		*(--p) = digits[value & 15];
+		value >>= 4;
 	} while (value > 0);
+	return p;
+}
 
-	for (i = (pbuffer - buffer); i < zero_pad; i++)
-		*(pbuffer++) = '0';
-
-	if (negative)
-		*(pbuffer++) = '-';
-
-	*(pbuffer) = '\0';
+/* Emits count copies of the pad string, in runs */
+static int
+mini_pad(mini_sink sink, void *context, const char *pad, int count)
+{
+	int written = 0;
 
-	/* ... now we reverse it (could do it recursively but will
-	 * conserve the stack space) */
-	len = (pbuffer - buffer);
-	for (i = 0; i < len / 2; i++) {
-		char j = buffer[i];
-		buffer[i] = buffer[len-i-1];
-		buffer[len-i-1] = j;
+	while (count > 0) {
+		int run = (count > MINI_PAD_LEN) ? MINI_PAD_LEN : count;
+		written += sink(pad, run, context);
+		count -= run;
 	}
+	return written;
+}
 
-	return len;
+/*
+ * Emits a field: sign or prefix, then zero or space padding up to
+ * width, then the body
+ */
+static int
+mini_field(mini_sink sink, void *context, const char *sign, int sign_len,
+	   const char *body, int body_len, int width, int zero_pad, int left)
+{
+	int written = 0;
+	int pad = width - sign_len - body_len;
+
+	if (pad > 0 && !left && !zero_pad)
+		written += mini_pad(sink, context, mini_spaces, pad);
+	if (sign_len)
+		written += sink(sign, sign_len, context);
+	if (pad > 0 && !left && zero_pad)
+		written += mini_pad(sink, context, mini_zeros, pad);
+	written += sink(body, body_len, context);
+	if (pad > 0 && left)
+		written += mini_pad(sink, context, mini_spaces, pad);
+	return written;
 }
 
 int
-mini_vsnprintf(char *buffer, unsigned int buffer_len, char *fmt, va_list va)
+mini_vpprintf(mini_sink sink, void *context, const char *fmt, va_list va)
 {
-	char *pbuffer = buffer;
-	char bf[24];
-	char ch;
-
-	int _putc(char ch)
-	{
-		if ((unsigned int)((pbuffer - buffer) + 1) >= buffer_len)
-			return 0;
-		*(pbuffer++) = ch;
-		*(pbuffer) = '\0';
-		return 1;
-	}
+	char bf[MINI_NUM_LEN];
+	char *end = bf + MINI_NUM_LEN;
+	int written = 0;
 
-	int _puts(char *s, unsigned int len)
-	{
-		unsigned int i;
+	while (*fmt) {
+		/* Copy the literal run up to the next conversion in one go */
+		const char *run = fmt;
+		while (*fmt && *fmt != '%')
+			fmt++;
+		if (fmt > run)
+			written += sink(run, fmt - run, context);
+		if (*fmt == '\0')
+			break;
+		fmt++;
 
-		if (buffer_len - (pbuffer - buffer) - 1 < len)
-			len = buffer_len - (pbuffer - buffer) - 1;
+		int zero_pad = 0, left = 0, is_long = 0, width = 0;
 
-		/* Copy to buffer */
-		for (i = 0; i < len; i++)
-			*(pbuffer++) = s[i];
-		*(pbuffer) = '\0';
+		for (;; fmt++) {
+			if (*fmt == '0')
+				zero_pad = 1;
+			else if (*fmt == '-')
+				left = 1;
+			else
+				break;
+		}
+		if (*fmt == '*') {
+			width = va_arg(va, int);
+			if (width < 0) {
+				left = 1;
+				width = -width;
+			}
+			fmt++;
+		}
+		else {
+			while (*fmt >= '0' && *fmt <= '9')
+				width = width * 10 + (*(fmt++) - '0');
+		}
+		while (*fmt == 'l') {
+			is_long = 1;
+			fmt++;
+		}
 
-		return len;
-	}
+		char ch = *(fmt++);
+		const char *sign = "";
+		char *digits;
+		unsigned long value;
 
-	while ((ch=*(fmt++))) {
-		if ((unsigned int)((pbuffer - buffer) + 1) >= buffer_len)
-			break;
-		if (ch!='%')
-			_putc(ch);
-		else {
-			char zero_pad = 0;
-			char *ptr;
-			unsigned int len;
-
-			ch=*(fmt++);
-
-			/* Zero padding requested */
-			if (ch=='0') {
-				ch=*(fmt++);
-				if (ch == '\0')
-					goto end;
-				if (ch >= '0' && ch <= '9')
-					zero_pad = ch - '0';
-				ch=*(fmt++);
+		switch (ch) {
+			case 0:
+				return written;
+
+			case 'd':
+			case 'i': {
+				long svalue = is_long ? va_arg(va, long) : (long)va_arg(va, int);
+				/* Negate in unsigned, so LONG_MIN and INT_MIN stay exact */
+				if (svalue < 0) {
+					sign = "-";
+					value = 0UL - (unsigned long)svalue;
+				}
+				else {
+					value = (unsigned long)svalue;
+				}
+				digits = mini_utoa(value, 10, 0, end);
+				written += mini_field(sink, context, sign, *sign ? 1 : 0,
+						      digits, end - digits, width, zero_pad, left);
+				break;
 			}
 
-			switch (ch) {
-				case 0:
-					goto end;
-
-				case 'u':
-				case 'd':
-					len = mini_itoa(va_arg(va, unsigned int), 10, 0, bf, zero_pad);
-					_puts(bf, len);
-					break;
-
-				case 'x':
-				case 'X':
-					len = mini_itoa(va_arg(va, unsigned int), 16, (ch=='X'), bf, zero_pad);
-					_puts(bf, len);
-					break;
-
-				case 'c' :
-					_putc((char)(va_arg(va, int)));
-					break;
-
-				case 's' :
-					ptr = va_arg(va, char*);
-					_puts(ptr, mini_strlen(ptr));
-					break;
-
-				default:
-					_putc(ch);
-					break;
+			case 'u':
+			case 'x':
+			case 'X':
+				value = is_long ? va_arg(va, unsigned long) : (unsigned long)va_arg(va, unsigned int);
+				digits = mini_utoa(value, (ch == 'u') ? 10 : 16, (ch == 'X'), end);
+				written += mini_field(sink, context, "", 0,
+						      digits, end - digits, width, zero_pad, left);
+				break;
+
+			case 'c':
+				bf[0] = (char)va_arg(va, int);
+				written += mini_field(sink, context, "", 0, bf, 1, width, 0, left);
+				break;
+
+			case 's': {
+				const char *s = va_arg(va, const char *);
+				if (s == NULL)
+					s = "(null)";
+				written += mini_field(sink, context, "", 0, s, strlen(s), width, 0, left);
+				break;
 			}
+
+			default:
+				/* %% and unknown conversions print the character */
+				bf[0] = ch;
+				written += sink(bf, 1, context);
+				break;
 		}
 	}
-end:
-	return pbuffer - buffer;
+	return written;
 }
 
+int
+mini_pprintf(mini_sink sink, void *context, const char *fmt, ...)
+{
+	int ret;
+	va_list va;
+	va_start(va, fmt);
+	ret = mini_vpprintf(sink, context, fmt, va);
+	va_end(va);
+
+	return ret;
+}
+
+struct mini_buff {
+	char *buffer;
+	unsigned int len;	/* Room, NUL excluded */
+	unsigned int used;
+};
+
+/* Sink into a fixed buffer, silently truncating */
+static int
+mini_buff_sink(const char *data, int len, void *context)
+{
+	struct mini_buff *b = (struct mini_buff *)context;
+	unsigned int room = b->len - b->used;
+
+	if ((unsigned int)len > room)
+		len = room;
+	memcpy(b->buffer + b->used, data, len);
+	b->used += len;
+	return len;
+}
 
 int
-mini_snprintf(char* buffer, unsigned int buffer_len, char *fmt, ...)
+mini_vsnprintf(char *buffer, unsigned int buffer_len, const char *fmt, va_list va)
+{
+	struct mini_buff b;
+
+	if (buffer_len == 0)
+		return 0;
+	b.buffer = buffer;
+	b.len = buffer_len - 1;
+	b.used = 0;
+	mini_vpprintf(mini_buff_sink, &b, fmt, va);
+	buffer[b.used] = '\0';
+
+	return b.used;
+}
+
+
+int
+mini_snprintf(char* buffer, unsigned int buffer_len, const char *fmt, ...)
 {
 	int ret;
 	va_list va;
@@ -169,4 +280,4 @@ mini_snprintf(char* buffer, unsigned int buffer_len, char *fmt, ...)
 	va_end(va);
 
 	return ret;
-}
\ No newline at end of file
+}
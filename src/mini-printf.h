@@ -9,10 +9,19 @@
 
 #include <stdarg.h>
 
-int mini_vsnprintf(char* buffer, unsigned int buffer_len, char *fmt, va_list va);
-int mini_snprintf(char* buffer, unsigned int buffer_len, char *fmt, ...);
+/*
+ * Receives the formatted output in pieces, which are not NUL terminated.
+ * Returns how many bytes it took.
+ */
+typedef int (*mini_sink)(const char *data, int len, void *context);
+
+int mini_vpprintf(mini_sink sink, void *context, const char *fmt, va_list va);
+int mini_pprintf(mini_sink sink, void *context, const char *fmt, ...);
+
+int mini_vsnprintf(char* buffer, unsigned int buffer_len, const char *fmt, va_list va);
+int mini_snprintf(char* buffer, unsigned int buffer_len, const char *fmt, ...);
 
 //#define vsnprintf mini_vsnprintf
 //#define snprintf mini_snprintf
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,74 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Bump allocator scoped to a window
+ *******************************************************************************
+ */
+
+#include "note-arena.h"
+#include "pebble-log.h"
+#include <string.h>
+
+  /**
+   *  Takes size bytes of heap for the buffers of a window. False when the
+   *  heap is short, the arena then stays closed and hands out nothing.
+   */
+bool note_arena_open(NoteArena *arena, size_t size) {
+	arena->size = NOTE_ARENA_SIZE(size);
+	arena->used = 0;
+	arena->base = malloc(arena->size);
+	if (arena->base == NULL) {
+		LOG_ERROR("###note_arena_open: No heap for %d bytes, %d free###", (int)arena->size, (int)heap_bytes_free());
+		arena->size = 0;
+		return false;
+	}
+	memset(arena->base, 0, arena->size);
+	return true;
+}
+
+  /**
+   *  Wipes what was handed out and gives the block back: every buffer of
+   *  the arena is gone at once
+   */
+void note_arena_close(NoteArena *arena) {
+	if (arena->base == NULL) return;
+	memset(arena->base, 0, arena->used);
+	free(arena->base);
+	arena->base = NULL;
+	arena->size = 0;
+	arena->used = 0;
+}
+
+bool note_arena_is_open(const NoteArena *arena) {
+	return arena->base != NULL;
+}
+
+  /**
+   *  A zeroed buffer of len bytes, NULL when the arena is closed or full
+   */
+void *note_arena_alloc(NoteArena *arena, size_t len) {
+	size_t take = NOTE_ARENA_SIZE(len);
+	if (arena->base == NULL || take > arena->size - arena->used) {
+		LOG_ERROR("###note_arena_alloc: %d bytes do not fit, %d of %d used###", (int)len, (int)arena->used, (int)arena->size);
+		return NULL;
+	}
+	void *buffer = arena->base + arena->used;
+	arena->used += take;
+	return buffer;
+}
+
+  /**
+   *  Where the arena is at, for note_arena_release
+   */
+size_t note_arena_mark(const NoteArena *arena) {
+	return arena->used;
+}
+
+  /**
+   *  Gives back, wiped, every buffer taken since mark
+   */
+void note_arena_release(NoteArena *arena, size_t mark) {
+	if (arena->base == NULL || mark >= arena->used) return;
+	memset(arena->base + mark, 0, arena->used - mark);
+	arena->used = mark;
+}
@@ -0,0 +1,38 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Bump allocator scoped to a window
+ *
+ *          A window takes its text and scratch buffers from one heap block
+ *          opened on load and closed on unload: closing wipes what was
+ *          handed out with one memset and frees the block with one free,
+ *          whatever the number of buffers. A mark and a release give back
+ *          the buffers taken since the mark, for scratch strings that only
+ *          live during a callback. Buffers come zeroed and aligned to
+ *          NOTE_ARENA_ALIGN; size an arena with NOTE_ARENA_SIZE of each.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_ARENA__
+#define __NOTE_ARENA__
+
+#include "pebble.h"
+
+#define NOTE_ARENA_ALIGN 4
+// Arena bytes a buffer of len bytes takes
+#define NOTE_ARENA_SIZE(len) (((len) + NOTE_ARENA_ALIGN - 1) & ~(size_t)(NOTE_ARENA_ALIGN - 1))
+
+typedef struct {
+	uint8_t *base;         // Heap block, NULL while closed
+	size_t size;
+	size_t used;           // Bytes handed out, from base
+} NoteArena;
+
+bool note_arena_open(NoteArena *arena, size_t size);
+void note_arena_close(NoteArena *arena);
+bool note_arena_is_open(const NoteArena *arena);
+void *note_arena_alloc(NoteArena *arena, size_t len);
+size_t note_arena_mark(const NoteArena *arena);
+void note_arena_release(NoteArena *arena, size_t mark);
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Stream cipher of the locked notes
+ *******************************************************************************
+ */
+
+#include "note-cipher.h"
+#include <string.h>
+
+#define NOTE_CIPHER_BLOCK_LEN 64
+// Nonce word telling the key derivation block from the note blocks: "PIN!"
+#define NOTE_CIPHER_PIN_NONCE 0x214E4950
+
+#define NOTE_CIPHER_ROTL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define NOTE_CIPHER_QUARTER(a, b, c, d) \
+	a += b; d ^= a; d = NOTE_CIPHER_ROTL(d, 16); \
+	c += d; b ^= c; b = NOTE_CIPHER_ROTL(b, 12); \
+	a += b; d ^= a; d = NOTE_CIPHER_ROTL(d, 8); \
+	c += d; b ^= c; b = NOTE_CIPHER_ROTL(b, 7);
+
+  /**
+   *  One ChaCha20 block (RFC 8439) of key, counter and nonce into out
+   */
+static void note_cipher_block(const uint32_t key[8], uint32_t counter, const uint32_t nonce[3], uint32_t out[16]) {
+	uint32_t in[16] = {
+		0x61707865, 0x3320646E, 0x79622D32, 0x6B206574,
+		key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+		counter, nonce[0], nonce[1], nonce[2],
+	};
+	memcpy(out, in, sizeof(in));
+	for (int i = 0; i < 10; i++) {
+		NOTE_CIPHER_QUARTER(out[0], out[4], out[8], out[12]);
+		NOTE_CIPHER_QUARTER(out[1], out[5], out[9], out[13]);
+		NOTE_CIPHER_QUARTER(out[2], out[6], out[10], out[14]);
+		NOTE_CIPHER_QUARTER(out[3], out[7], out[11], out[15]);
+		NOTE_CIPHER_QUARTER(out[0], out[5], out[10], out[15]);
+		NOTE_CIPHER_QUARTER(out[1], out[6], out[11], out[12]);
+		NOTE_CIPHER_QUARTER(out[2], out[7], out[8], out[13]);
+		NOTE_CIPHER_QUARTER(out[3], out[4], out[9], out[14]);
+	}
+	for (int i = 0; i < 16; i++) out[i] += in[i];
+}
+
+  /**
+   *  Key of the note with content hash from its PIN. Returns the check the
+   *  build kept for the right PIN, see NOTE_PIN_CHECK_MASK.
+   */
+uint32_t note_key_derive(NoteKey *key, const char *pin, size_t pin_len, uint32_t hash) {
+	uint8_t bytes[32] = { 0 };
+	uint32_t words[8];
+	uint32_t out[16];
+
+	if (pin_len > NOTE_PIN_MAX_LEN) pin_len = NOTE_PIN_MAX_LEN;
+	uint32_t nonce[3] = { hash, pin_len, NOTE_CIPHER_PIN_NONCE };
+	memcpy(bytes, pin, pin_len);
+	for (int i = 0; i < 8; i++) {
+		words[i] = bytes[4 * i] | (bytes[4 * i + 1] << 8) | (bytes[4 * i + 2] << 16) | ((uint32_t)bytes[4 * i + 3] << 24);
+	}
+	note_cipher_block(words, 
+					  0, 
+					  nonce, 
+					  out);
+	memcpy(key->key, out, sizeof(key->key));
+	key->nonce = hash;
+	uint32_t check = out[8] & NOTE_PIN_CHECK_MASK;
+
+	memset(bytes, 0, sizeof(bytes));
+	memset(words, 0, sizeof(words));
+	memset(out, 0, sizeof(out));
+	return check;
+}
+
+  /**
+   *  Forgets the key
+   */
+void note_key_wipe(NoteKey *key) {
+	memset(key, 0, sizeof(NoteKey));
+}
+
+  /**
+   *  Encrypts or decrypts, it is the same, len bytes at offset in the note
+   */
+void note_cipher_apply(const NoteKey *key, uint32_t offset, uint8_t *data, size_t len) {
+	uint32_t nonce[3] = { key->nonce, 0, 0 };
+	uint32_t block[16];
+	uint32_t counter = offset / NOTE_CIPHER_BLOCK_LEN;
+	size_t skip = offset % NOTE_CIPHER_BLOCK_LEN;
+
+	while (len > 0) {
+		note_cipher_block(key->key, 
+						  counter++, 
+						  nonce, 
+						  block);
+		for (; skip < NOTE_CIPHER_BLOCK_LEN && len > 0; skip++, len--) {
+			*data++ ^= (uint8_t)(block[skip / 4] >> (8 * (skip % 4)));
+		}
+		skip = 0;
+	}
+	memset(block, 0, sizeof(block));
+}
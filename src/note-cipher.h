@@ -0,0 +1,39 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Stream cipher of the locked notes built by tools/build_notes.py
+ *          (format described in tools/cipher.py)
+ *
+ *          ChaCha20 in counter mode: any byte of a note is found from its
+ *          offset alone, so each block is decrypted as it is read and the
+ *          plain text is never whole in RAM. The key comes from the PIN,
+ *          a sequence of button pushes, and the content hash of the note.
+ *          A PIN is only a few pushes, so this keeps a note from a glance
+ *          at the watch, not from someone who has the app file.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_CIPHER__
+#define __NOTE_CIPHER__
+
+#include "pebble.h"
+
+// PIN pushes, one of NOTE_PIN_UP, NOTE_PIN_DOWN or NOTE_PIN_SELECT each
+#define NOTE_PIN_MIN_LEN 4
+#define NOTE_PIN_MAX_LEN 16
+#define NOTE_PIN_UP 'U'
+#define NOTE_PIN_DOWN 'D'
+#define NOTE_PIN_SELECT 'S'
+// Bits of the check a locked note keeps in the table of contents
+#define NOTE_PIN_CHECK_MASK 0xFFFFFF
+
+typedef struct {
+	uint32_t key[8];
+	uint32_t nonce;        // Content hash of the note
+} NoteKey;
+
+uint32_t note_key_derive(NoteKey *key, const char *pin, size_t pin_len, uint32_t hash);
+void note_key_wipe(NoteKey *key);
+void note_cipher_apply(const NoteKey *key, uint32_t offset, uint8_t *data, size_t len);
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Reader for the per note line tables
+ *******************************************************************************
+ */
+
+#include "note-lines.h"
+#include "note-store.h"
+#include "pebble-stats.h"
+#include "pebble-log.h"
+
+#define NOTE_LINES_HEADER_LEN 12
+
+  /**
+   *  Reads the header of the table starting at base in a resource
+   */
+bool note_lines_open(NoteLines *lines, ResHandle handle, uint32_t base) {
+	uint8_t header[NOTE_LINES_HEADER_LEN];
+	lines->handle = handle;
+	lines->base = base;
+	lines->count = 0;
+	lines->line_height = 1;
+	lines->font_size = 0;
+	
+	if (note_store_read(lines->handle, base, header, NOTE_LINES_HEADER_LEN) != NOTE_LINES_HEADER_LEN ||
+		header[0] != 'N' || header[1] != 'L' || header[2] != 1) {
+		LOG_ERROR("###note_lines_open: Bad line table header###");
+		return false;
+	}
+	lines->font_size = header[3];
+	lines->line_height = header[4] | (header[5] << 8);
+	lines->count = header[8] | (header[9] << 8) | (header[10] << 16) | ((uint32_t)header[11] << 24);
+	if (lines->line_height == 0) lines->line_height = 1;
+	return true;
+}
+
+  /**
+   *  Note offset where line starts
+   */
+uint32_t note_lines_offset(NoteLines *lines, uint32_t line) {
+	uint8_t entry[4] = { 0, 0, 0, 0 };
+	if (lines->count == 0) return 0;
+	if (line >= lines->count) line = lines->count - 1;
+	note_store_read(lines->handle, lines->base + NOTE_LINES_HEADER_LEN + 4 * line, entry, sizeof(entry));
+	return entry[0] | (entry[1] << 8) | (entry[2] << 16) | ((uint32_t)entry[3] << 24);
+}
+
+  /**
+   *  Reads the start offsets of count lines from first in one ranged read.
+   *  Returns the lines actually read.
+   */
+uint32_t note_lines_read(NoteLines *lines, uint32_t first, uint32_t count, uint32_t *offsets) {
+	if (first >= lines->count) return 0;
+	if (count > lines->count - first) count = lines->count - first;
+	
+	size_t read = note_store_read(lines->handle, 
+								  lines->base + NOTE_LINES_HEADER_LEN + 4 * first, 
+								  (uint8_t*)offsets, 
+								  4 * count);
+	count = read / 4;
+	for (uint32_t i = 0; i < count; i++) {
+		uint8_t *entry = (uint8_t*)&offsets[i];
+		offsets[i] = entry[0] | (entry[1] << 8) | (entry[2] << 16) | ((uint32_t)entry[3] << 24);
+	}
+	return count;
+}
+
+  /**
+   *  Line holding a note offset: the last line starting at or before it
+   */
+uint32_t note_lines_find(NoteLines *lines, uint32_t offset) {
+	uint32_t low = 0, high = lines->count;
+	while (high - low > 1) {
+		uint32_t mid = low + (high - low) / 2;
+		if (note_lines_offset(lines, mid) <= offset) low = mid;
+		else high = mid;
+	}
+	return low;
+}
+
+  /**
+   *  Line shown at pixel y of the note
+   */
+uint32_t note_lines_at(NoteLines *lines, int32_t y) {
+	if (y <= 0) return 0;
+	uint32_t line = y / lines->line_height;
+	return (line < lines->count) ? line : lines->count - 1;
+}
+
+int32_t note_lines_y(NoteLines *lines, uint32_t line) {
+	return (int32_t)line * lines->line_height;
+}
+
+int32_t note_lines_height(NoteLines *lines) {
+	return (int32_t)lines->count * lines->line_height;
+}
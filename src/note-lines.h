@@ -0,0 +1,34 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Reader for the per note line tables built by tools/build_notes.py
+ *          (format described in tools/layout.py)
+ *
+ *          Lines all have the same height, so pixel to line is a division and
+ *          line to note offset is one 4-byte ranged read. Note offset to line
+ *          is a binary search over the table.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_LINES__
+#define __NOTE_LINES__
+
+#include "pebble.h"
+
+typedef struct {
+	ResHandle handle;
+	uint32_t base;         // Offset of the table in the resource
+	uint32_t count;        // Wrapped lines in the note
+	uint16_t line_height;  // Pixels per line
+	uint8_t font_size;     // Points of the Gothic font the table was built for
+} NoteLines;
+
+bool note_lines_open(NoteLines *lines, ResHandle handle, uint32_t base);
+uint32_t note_lines_offset(NoteLines *lines, uint32_t line);
+uint32_t note_lines_read(NoteLines *lines, uint32_t first, uint32_t count, uint32_t *offsets);
+uint32_t note_lines_find(NoteLines *lines, uint32_t offset);
+uint32_t note_lines_at(NoteLines *lines, int32_t y);
+int32_t note_lines_y(NoteLines *lines, uint32_t line);
+int32_t note_lines_height(NoteLines *lines);
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Streaming decoder for the compressed note resources
+ *******************************************************************************
+ */
+
+#include "note-lz.h"
+#include "note-store.h"
+#include "pebble-stats.h"
+#include "pebble-log.h"
+
+#define NOTE_LZ_HEADER_LEN 12
+
+// Dictionary shared by all the notes
+static uint8_t note_lz_dict[NOTE_LZ_DICT_LEN];
+static size_t note_lz_dict_len = 0;
+
+// Key of the locked note being read, NULL when none is unlocked
+static const NoteKey *note_lz_key = NULL;
+
+// Compressed bytes of the block being decoded
+static uint8_t note_lz_scratch[NOTE_LZ_SCRATCH_LEN];
+
+static uint32_t note_lz_u32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t note_lz_u16(const uint8_t *p) {
+	return p[0] | (p[1] << 8);
+}
+
+  /**
+   *  Loads the dictionary shared by the notes from a resource range
+   */
+void note_lz_load_dict(ResHandle handle, uint32_t offset, uint32_t length) {
+	if (length > NOTE_LZ_DICT_LEN) {
+		LOG_ERROR("###note_lz_load_dict: Dictionary too big %d###", (int)length);
+		length = 0;
+	}
+	note_lz_dict_len = length ? resource_load_byte_range(handle, offset, note_lz_dict, length) : 0;
+}
+
+  /**
+   *  Key the blocks of locked notes are decrypted with, NULL to lock them
+   *  all again. The key stays the caller's.
+   */
+void note_lz_set_key(const NoteKey *key) {
+	note_lz_key = key;
+}
+
+  /**
+   *  Reads the container header of a note starting at base in a resource
+   */
+bool note_lz_open(NoteLz *note, ResHandle handle, uint32_t base) {
+	uint8_t header[NOTE_LZ_HEADER_LEN];
+	note->handle = handle;
+	note->base = base;
+	note->size = 0;
+	note->block_size = 0;
+	note->num_blocks = 0;
+	note->flags = 0;
+	
+	if (note_store_read(note->handle, base, header, NOTE_LZ_HEADER_LEN) != NOTE_LZ_HEADER_LEN ||
+		header[0] != 'N' || header[1] != 'Z' || header[2] != 1) {
+		LOG_ERROR("###note_lz_open: Bad note header###");
+		return false;
+	}
+	note->size = note_lz_u32(header + 4);
+	note->block_size = note_lz_u16(header + 8);
+	note->num_blocks = note_lz_u16(header + 10);
+	note->flags = header[3];
+	if (note->block_size > NOTE_LZ_MAX_BLOCK) {
+		LOG_ERROR("###note_lz_open: Block too big %d###", note->block_size);
+		note->size = 0;
+		note->num_blocks = 0;
+		return false;
+	}
+	return true;
+}
+
+  /**
+   *  Decodes block into out, stopping once out_max bytes are produced.
+   *  Returns the bytes produced or -1 if the block is corrupt.
+   */
+int note_lz_decode(const uint8_t *in, size_t in_len, char *out, size_t out_max) {
+	const uint8_t *end = in + in_len;
+	size_t produced = 0;
+	
+	while (in < end && produced < out_max) {
+		uint8_t token = *in++;
+		
+		if (token < 0x80) {
+			size_t len = token + 1;
+			if (len > (size_t)(end - in)) return -1;
+			if (len > out_max - produced) len = out_max - produced;
+			memcpy(out + produced, in, len);
+			produced += len;
+			in += token + 1;
+			continue;
+		}
+		
+		if (in >= end) return -1;
+		size_t len = ((token >> 4) & 7) + 3;
+		size_t distance = (((token & 0x0F) << 8) | *in++) + 1;
+		if (len == 10) {
+			if (in >= end) return -1;
+			len += *in++;
+		}
+		if (distance > produced + note_lz_dict_len) return -1;
+		if (len > out_max - produced) len = out_max - produced;
+		
+		// Bytes still in the dictionary, then overlapping copy from the output
+		for (; len > 0 && distance > produced; len--, produced++) {
+			out[produced] = note_lz_dict[note_lz_dict_len - (distance - produced)];
+		}
+		for (; len > 0; len--, produced++) {
+			out[produced] = out[produced - distance];
+		}
+	}
+	return produced;
+}
+
+  /**
+   *  Reads and decodes one block, returns the plain bytes written to out
+   */
+size_t note_lz_read_block(NoteLz *note, uint16_t block, char *out, size_t out_max) {
+	if (block >= note->num_blocks) return 0;
+	
+	uint8_t range[8];
+	note_store_read(note->handle, note->base + NOTE_LZ_HEADER_LEN + 4 * block, range, sizeof(range));
+	uint32_t from = note_lz_u32(range);
+	uint32_t len = note_lz_u32(range + 4) - from;
+	if (len > NOTE_LZ_SCRATCH_LEN) return 0;
+	if ((note->flags & NOTE_LZ_FLAG_LOCKED) && note_lz_key == NULL) {
+		LOG_WARNING("###note_lz_read_block: Block %d is locked###", block);
+		return 0;
+	}
+	
+	len = note_store_read(note->handle, note->base + from, note_lz_scratch, len);
+	if (note->flags & NOTE_LZ_FLAG_LOCKED) {
+		note_cipher_apply(note_lz_key, 
+						  from, 
+						  note_lz_scratch, 
+						  len);
+	}
+	int produced = note_lz_decode(note_lz_scratch, len, out, out_max);
+	if (note->flags & NOTE_LZ_FLAG_LOCKED) memset(note_lz_scratch, 0, len);
+	if (produced < 0) {
+		LOG_ERROR("###note_lz_read_block: Corrupt block %d###", block);
+		return 0;
+	}
+	return produced;
+}
@@ -0,0 +1,42 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Streaming decoder for the compressed note resources built by
+ *          tools/build_notes.py (format described in tools/lz.py)
+ *
+ *          Notes are stored as independent blocks, so any block decodes with
+ *          one ranged read into a fixed NOTE_LZ_SCRATCH_LEN buffer plus the
+ *          shared dictionary, loaded once from the note pack. The blocks of
+ *          a locked note are decrypted there too, with the key given to
+ *          note_lz_set_key.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_LZ__
+#define __NOTE_LZ__
+
+#include "pebble.h"
+#include "note-cipher.h"
+
+#define NOTE_LZ_DICT_LEN 1024
+#define NOTE_LZ_MAX_BLOCK 512
+#define NOTE_LZ_SCRATCH_LEN (NOTE_LZ_MAX_BLOCK + NOTE_LZ_MAX_BLOCK / 128 + 4)
+// The blocks are encrypted, see note-cipher.h
+#define NOTE_LZ_FLAG_LOCKED 1
+
+typedef struct {
+	ResHandle handle;
+	uint32_t base;        // Offset of the note in the resource
+	uint32_t size;        // Plain size in bytes
+	uint16_t block_size;  // Plain bytes per block
+	uint16_t num_blocks;
+	uint8_t flags;
+} NoteLz;
+
+void note_lz_load_dict(ResHandle handle, uint32_t offset, uint32_t length);
+void note_lz_set_key(const NoteKey *key);
+bool note_lz_open(NoteLz *note, ResHandle handle, uint32_t base);
+size_t note_lz_read_block(NoteLz *note, uint16_t block, char *out, size_t out_max);
+int note_lz_decode(const uint8_t *in, size_t in_len, char *out, size_t out_max);
+
+#endif
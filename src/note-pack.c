@@ -0,0 +1,74 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Reader for the note pack
+ *******************************************************************************
+ */
+
+#include "note-pack.h"
+#include "pebble-stats.h"
+#include "pebble-log.h"
+#include "note-lz.h"
+#include <string.h>
+
+#define NOTE_PACK_HEADER_LEN 24
+#define NOTE_PACK_ENTRY_LEN (28 + NOTE_PACK_TITLE_LEN)
+
+static uint32_t note_pack_u32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+  /**
+   *  Reads the pack header and loads the dictionary the notes share
+   */
+bool note_pack_open(NotePack *pack, uint32_t resource_id) {
+	uint8_t header[NOTE_PACK_HEADER_LEN];
+	pack->handle = resource_get_handle(resource_id);
+	pack->count = 0;
+	pack->dict_offset = pack->dict_length = 0;
+	pack->index_offset = pack->index_length = 0;
+	
+	if (resource_load_byte_range(pack->handle, 0, header, NOTE_PACK_HEADER_LEN) != NOTE_PACK_HEADER_LEN ||
+		header[0] != 'N' || header[1] != 'P' || header[2] != 2 || header[3] != NOTE_PACK_TITLE_LEN) {
+		LOG_ERROR("###note_pack_open: Bad pack header###");
+		return false;
+	}
+	pack->count = note_pack_u32(header + 4);
+	pack->dict_offset = note_pack_u32(header + 8);
+	pack->dict_length = note_pack_u32(header + 12);
+	pack->index_offset = note_pack_u32(header + 16);
+	pack->index_length = note_pack_u32(header + 20);
+	
+	note_lz_load_dict(pack->handle, 
+					  pack->dict_offset, 
+					  pack->dict_length);
+	return true;
+}
+
+  /**
+   *  Reads the table of contents entry of a note
+   */
+bool note_pack_entry(NotePack *pack, uint32_t note, NotePackEntry *entry) {
+	uint8_t raw[NOTE_PACK_ENTRY_LEN];
+	memset(entry, 0, sizeof(NotePackEntry));
+	if (note >= pack->count) return false;
+	
+	if (resource_load_byte_range(pack->handle, 
+								 NOTE_PACK_HEADER_LEN + NOTE_PACK_ENTRY_LEN * note, 
+								 raw, 
+								 NOTE_PACK_ENTRY_LEN) != NOTE_PACK_ENTRY_LEN) {
+		return false;
+	}
+	entry->handle = pack->handle;
+	entry->offset = note_pack_u32(raw);
+	entry->length = note_pack_u32(raw + 4);
+	entry->lines_offset = note_pack_u32(raw + 8);
+	entry->lines_length = note_pack_u32(raw + 12);
+	entry->size = note_pack_u32(raw + 16);
+	entry->flags = raw[20];
+	entry->check = raw[21] | (raw[22] << 8) | ((uint32_t)raw[23] << 16);
+	entry->hash = note_pack_u32(raw + 24);
+	memcpy(entry->title, raw + 28, NOTE_PACK_TITLE_LEN);
+	entry->title[NOTE_PACK_TITLE_LEN - 1] = '\0';
+	return true;
+}
@@ -0,0 +1,50 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Reader for the note pack, the single resource holding every note
+ *          built by tools/build_notes.py (format described in tools/pack.py)
+ *
+ *          The table of contents has fixed size entries, so any note is
+ *          found with one ranged read however many notes there are.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_PACK__
+#define __NOTE_PACK__
+
+#include "pebble.h"
+
+#define NOTE_PACK_TITLE_LEN 24
+// The note is a table built from a CSV file, see note-table.h
+#define NOTE_PACK_FLAG_TABLE 1
+// The note was synced from the phone, see note-store.h
+#define NOTE_PACK_FLAG_SYNCED 2
+// The note is encrypted, its PIN unlocks it, see note-cipher.h
+#define NOTE_PACK_FLAG_LOCKED 4
+
+typedef struct {
+	ResHandle handle;
+	uint32_t count;          // Notes in the pack
+	uint32_t dict_offset;    // Dictionary shared by the compressed notes
+	uint32_t dict_length;
+	uint32_t index_offset;   // Search index
+	uint32_t index_length;
+} NotePack;
+
+typedef struct {
+	ResHandle handle;        // Where offsets point: the pack or the store
+	uint32_t offset;         // Compressed note, see note-lz.h
+	uint32_t length;
+	uint32_t lines_offset;   // Line table, see note-lines.h
+	uint32_t lines_length;
+	uint32_t size;           // Plain size in bytes
+	uint8_t flags;
+	uint32_t check;          // PIN check of a locked note
+	uint32_t hash;           // Content hash, the same across rebuilds
+	char title[NOTE_PACK_TITLE_LEN];
+} NotePackEntry;
+
+bool note_pack_open(NotePack *pack, uint32_t resource_id);
+bool note_pack_entry(NotePack *pack, uint32_t note, NotePackEntry *entry);
+
+#endif
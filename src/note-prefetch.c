@@ -0,0 +1,106 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Background prefetch of the note highlighted in the menu
+ *******************************************************************************
+ */
+
+#include "note-prefetch.h"
+#include "note-state.h"
+#include "note-view.h"
+#include "pebble-log.h"
+
+  /**
+   *  One step: open the note and find where it reopens, then a chunk per tick
+   */
+static void note_prefetch_tick(void *data) {
+	NotePrefetch *prefetch = data;
+	prefetch->timer = NULL;
+	
+	if (!prefetch->ready) {
+		NoteState state;
+		note_lines_open(prefetch->lines, prefetch->handle, prefetch->lines_offset);
+		note_stream_prepare(prefetch->stream, prefetch->handle, prefetch->offset);
+		
+		// The window note_view_draw will ask for, at the saved position
+		note_state_load(&state, prefetch->hash);
+		uint32_t line = note_lines_at(prefetch->lines, note_state_top(&state, note_lines_height(prefetch->lines)));
+		line = (line > NOTE_VIEW_MARGIN_LINES) ? line - NOTE_VIEW_MARGIN_LINES : 0;
+		prefetch->first_chunk = note_stream_window_for(prefetch->stream, note_lines_offset(prefetch->lines, line));
+		prefetch->ready = true;
+	}
+	else if (prefetch->stream->length >= prefetch->budget ||
+			 !note_stream_load_next(prefetch->stream, prefetch->first_chunk)) {
+		LOG_DEBUG("###note_prefetch_tick: Row %d, %d bytes ready###", (int)prefetch->row, (int)prefetch->stream->length);
+		return;
+	}
+	prefetch->timer = app_timer_register(NOTE_PREFETCH_STEP_MS, note_prefetch_tick, prefetch);
+}
+
+void note_prefetch_init(NotePrefetch *prefetch, NoteStream *stream, NoteLines *lines, uint32_t budget) {
+	prefetch->stream = stream;
+	prefetch->lines = lines;
+	prefetch->budget = budget;
+	prefetch->timer = NULL;
+	prefetch->row = -1;
+	prefetch->ready = false;
+}
+
+  /**
+   *  Stops the work, what is loaded stays for note_prefetch_take
+   */
+void note_prefetch_stop(NotePrefetch *prefetch) {
+	if (prefetch->timer) {
+		app_timer_cancel(prefetch->timer);
+		prefetch->timer = NULL;
+	}
+}
+
+  /**
+   *  Stops and forgets the prefetch, the stream is the note window's again
+   */
+void note_prefetch_reset(NotePrefetch *prefetch) {
+	note_prefetch_stop(prefetch);
+	if (prefetch->ready) note_stream_close(prefetch->stream);
+	prefetch->row = -1;
+	prefetch->ready = false;
+}
+
+  /**
+   *  Prefetches the note of row once it stays highlighted, dropping any other
+   */
+void note_prefetch_start(NotePrefetch *prefetch, int32_t row, const NotePackEntry *entry) {
+	if (prefetch->row == row && prefetch->hash == entry->hash) {
+		// Back on the same row: carry on from what is loaded
+		if (!prefetch->timer) prefetch->timer = app_timer_register(NOTE_PREFETCH_STEP_MS, note_prefetch_tick, prefetch);
+		return;
+	}
+	note_prefetch_reset(prefetch);
+	// Tables have their own window, locked notes wait for their PIN
+	if (prefetch->budget == 0 || entry->flags & (NOTE_PACK_FLAG_TABLE | NOTE_PACK_FLAG_LOCKED)) return;
+	
+	prefetch->row = row;
+	prefetch->hash = entry->hash;
+	prefetch->handle = entry->handle;
+	prefetch->offset = entry->offset;
+	prefetch->lines_offset = entry->lines_offset;
+	prefetch->timer = app_timer_register(NOTE_PREFETCH_DELAY_MS, note_prefetch_tick, prefetch);
+}
+
+  /**
+   *  True when the stream and line table already hold the note of row, its
+   *  window completed. Otherwise they are left for the caller to open.
+   */
+bool note_prefetch_take(NotePrefetch *prefetch, int32_t row, uint32_t hash) {
+	note_prefetch_stop(prefetch);
+	bool taken = prefetch->ready && prefetch->row == row && prefetch->hash == hash;
+	if (taken) {
+		while (note_stream_load_next(prefetch->stream, prefetch->first_chunk));
+	}
+	else {
+		note_prefetch_reset(prefetch);
+	}
+	prefetch->row = -1;
+	prefetch->ready = false;
+	return taken;
+}
@@ -0,0 +1,51 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Background prefetch of the note highlighted in the menu
+ *
+ *          While a row stays highlighted for NOTE_PREFETCH_DELAY_MS, its line
+ *          table is opened, the position it reopens at is worked out from
+ *          its saved state, and the window the first screen needs is
+ *          decoded, one chunk per timer tick so the menu stays responsive.
+ *          It all goes into the note stream and line table the note window
+ *          uses, idle while the menu shows, so it takes no memory of its
+ *          own; budget caps the bytes decoded ahead of a select that may
+ *          never come. Moving the highlight cancels it. Opening the note
+ *          takes whatever is ready and loads the rest.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_PREFETCH__
+#define __NOTE_PREFETCH__
+
+#include "pebble.h"
+#include "note-pack.h"
+#include "note-stream.h"
+#include "note-lines.h"
+
+// Highlight time before a prefetch starts, scrolling through the menu is free
+#define NOTE_PREFETCH_DELAY_MS 150
+// Time between two chunks
+#define NOTE_PREFETCH_STEP_MS 20
+
+typedef struct {
+	NoteStream *stream;
+	NoteLines *lines;
+	uint32_t budget;         // Bytes decoded ahead at most, 0 disables
+	AppTimer *timer;
+	int32_t row;             // Menu row prefetched, -1 for none
+	uint32_t hash;           // Its content hash, the row may hold another note later
+	ResHandle handle;
+	uint32_t offset;
+	uint32_t lines_offset;
+	uint32_t first_chunk;    // Window the first screen needs, once ready
+	bool ready;              // Stream and line table are open
+} NotePrefetch;
+
+void note_prefetch_init(NotePrefetch *prefetch, NoteStream *stream, NoteLines *lines, uint32_t budget);
+void note_prefetch_start(NotePrefetch *prefetch, int32_t row, const NotePackEntry *entry);
+void note_prefetch_stop(NotePrefetch *prefetch);
+void note_prefetch_reset(NotePrefetch *prefetch);
+bool note_prefetch_take(NotePrefetch *prefetch, int32_t row, uint32_t hash);
+
+#endif
@@ -0,0 +1,178 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Time based scroll engine for the note view
+ *******************************************************************************
+ */
+
+#include "note-scroll.h"
+#include "pebble-stats.h"
+#include "pebble-log.h"
+
+#define NOTE_SCROLL_ONE (1 << NOTE_SCROLL_FRACTION_BITS)
+
+static void note_scroll_tick(void *data);
+
+static uint32_t note_scroll_now(void) {
+	time_t seconds;
+	uint16_t ms;
+	time_ms(&seconds, &ms);
+	return (uint32_t)seconds * 1000 + ms;
+}
+
+  /**
+   *  Speed the engine is heading to, fixed point
+   */
+static int32_t note_scroll_target(const NoteScroll *scroll) {
+	if (scroll->hold) return scroll->hold * scroll->hold_max_speed * NOTE_SCROLL_ONE;
+	if (scroll->automatic) return scroll->auto_speed * NOTE_SCROLL_ONE;
+	return 0;
+}
+
+  /**
+   *  Arms the timer for the next frame: after the fewest whole pixels that
+   *  take at least NOTE_SCROLL_FRAME_MS, so every frame moves evenly
+   */
+static void note_scroll_schedule(NoteScroll *scroll) {
+	if (scroll->timer || scroll->velocity == 0) return;
+	
+	const uint32_t second = 1000 * NOTE_SCROLL_ONE;
+	uint32_t speed = (scroll->velocity < 0) ? -scroll->velocity : scroll->velocity;
+	uint32_t pixels = (NOTE_SCROLL_FRAME_MS * speed + second - 1) / second;
+	uint32_t wait = (pixels * second + speed - 1) / speed;
+	scroll->timer = app_timer_register(wait, note_scroll_tick, scroll);
+}
+
+static void note_scroll_stop(NoteScroll *scroll) {
+	scroll->velocity = 0;
+	if (scroll->timer) {
+		app_timer_cancel(scroll->timer);
+		scroll->timer = NULL;
+	}
+}
+
+  /**
+   *  Integrates the motion since the last step and moves the view once
+   */
+static void note_scroll_step(NoteScroll *scroll) {
+	STATS_BEGIN(STATS_SCROLL_STEP);
+	uint32_t now = note_scroll_now();
+	uint32_t dt = now - scroll->last_ms;
+	scroll->last_ms = now;
+	if (dt > NOTE_SCROLL_MAX_STEP_MS) dt = NOTE_SCROLL_MAX_STEP_MS;
+	
+	// Long pushes speed up towards their top speed
+	if (scroll->hold) {
+		int32_t target = note_scroll_target(scroll);
+		scroll->velocity += scroll->hold * (int32_t)(scroll->hold_accel * NOTE_SCROLL_ONE * dt / 1000);
+		if ((scroll->hold > 0 && scroll->velocity > target) || (scroll->hold < 0 && scroll->velocity < target)) {
+			scroll->velocity = target;
+		}
+	}
+	scroll->position += scroll->velocity * (int32_t)dt / 1000;
+	
+	// Stop at the note bounds, auto scroll ends at the bottom
+	int32_t max = note_view_max_offset(scroll->view) * NOTE_SCROLL_ONE;
+	if (scroll->position <= 0 && scroll->velocity <= 0) {
+		scroll->position = 0;
+		scroll->velocity = 0;
+	}
+	if (scroll->position >= max && scroll->velocity >= 0) {
+		scroll->position = max;
+		scroll->velocity = 0;
+		scroll->automatic = false;
+	}
+	note_view_set_offset(scroll->view, 
+						 scroll->position / NOTE_SCROLL_ONE);
+	LOG_DEFER_DEBUG("###note_scroll_step: dt %d, top %d, speed %d###", (int)dt, 
+					(int)(scroll->position / NOTE_SCROLL_ONE), (int)(scroll->velocity / NOTE_SCROLL_ONE));
+	STATS_END(STATS_SCROLL_STEP);
+}
+
+static void note_scroll_tick(void *data) {
+	NoteScroll *scroll = (NoteScroll*)data;
+	scroll->timer = NULL;
+	note_scroll_step(scroll);
+	note_scroll_schedule(scroll);
+}
+
+  /**
+   *  Sets the speed for the current state and (re)starts the motion
+   */
+static void note_scroll_start(NoteScroll *scroll, int32_t velocity) {
+	if (scroll->velocity == 0) scroll->last_ms = note_scroll_now();
+	scroll->velocity = velocity;
+	if (velocity == 0) {
+		note_scroll_stop(scroll);
+		return;
+	}
+	note_scroll_schedule(scroll);
+}
+
+void note_scroll_init(NoteScroll *scroll, NoteView *view, int32_t auto_speed, 
+					  int32_t hold_speed, int32_t hold_max_speed, int32_t hold_accel) {
+	scroll->view = view;
+	scroll->timer = NULL;
+	scroll->position = note_view_get_offset(view) * NOTE_SCROLL_ONE;
+	scroll->velocity = 0;
+	scroll->last_ms = note_scroll_now();
+	scroll->hold = 0;
+	scroll->automatic = false;
+	scroll->auto_speed = auto_speed;
+	scroll->hold_speed = hold_speed;
+	scroll->hold_max_speed = hold_max_speed;
+	scroll->hold_accel = hold_accel;
+}
+
+void note_scroll_deinit(NoteScroll *scroll) {
+	note_scroll_stop(scroll);
+	scroll->hold = 0;
+	scroll->automatic = false;
+}
+
+  /**
+   *  Jumps to top pixels into the note; any motion goes on from there
+   */
+void note_scroll_to(NoteScroll *scroll, int32_t top) {
+	note_view_set_offset(scroll->view, 
+						 top);
+	scroll->position = note_view_get_offset(scroll->view) * NOTE_SCROLL_ONE;
+}
+
+void note_scroll_by(NoteScroll *scroll, int32_t pixels) {
+	note_scroll_to(scroll, 
+				   scroll->position / NOTE_SCROLL_ONE + pixels);
+}
+
+  /**
+   *  Long push: starts at hold_speed and accelerates while held
+   */
+void note_scroll_hold(NoteScroll *scroll, int8_t direction) {
+	scroll->hold = (direction < 0) ? -1 : 1;
+	note_scroll_start(scroll, 
+					  scroll->hold * scroll->hold_speed * NOTE_SCROLL_ONE);
+}
+
+  /**
+   *  End of a long push: back to auto scroll if it is on, else stop
+   */
+void note_scroll_release(NoteScroll *scroll) {
+	scroll->hold = 0;
+	note_scroll_start(scroll, 
+					  note_scroll_target(scroll));
+}
+
+void note_scroll_set_auto(NoteScroll *scroll, bool automatic) {
+	scroll->automatic = automatic;
+	if (scroll->hold) return;
+	note_scroll_start(scroll, 
+					  note_scroll_target(scroll));
+}
+
+bool note_scroll_get_auto(const NoteScroll *scroll) {
+	return scroll->automatic;
+}
+
+bool note_scroll_moving(const NoteScroll *scroll) {
+	return scroll->velocity != 0;
+}
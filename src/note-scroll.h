@@ -0,0 +1,53 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Time based scroll engine for the note view
+ *
+ *          Motion is integrated from the elapsed time, not from timer ticks,
+ *          so a late tick moves further instead of falling behind. Position
+ *          and velocity are fixed point with NOTE_SCROLL_FRACTION_BITS
+ *          fraction bits. One timer drives every motion and the view is
+ *          only marked dirty when the whole pixel offset changes.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_SCROLL__
+#define __NOTE_SCROLL__
+
+#include "pebble.h"
+#include "note-view.h"
+
+#define NOTE_SCROLL_FRACTION_BITS 8
+// Shortest time between two frames, caps the redraw rate
+#define NOTE_SCROLL_FRAME_MS 50
+// Longest step integrated at once, so a stalled app does not leap
+#define NOTE_SCROLL_MAX_STEP_MS 200
+
+typedef struct {
+	NoteView *view;
+	AppTimer *timer;
+	int32_t position;        // Fixed point pixels into the note
+	int32_t velocity;        // Fixed point pixels per second
+	uint32_t last_ms;        // Time of the last step
+	int8_t hold;             // Long push direction: -1 up, 1 down, 0 none
+	bool automatic;          // Auto scroll is on
+	int32_t auto_speed;      // Pixels per second
+	int32_t hold_speed;      // Pixels per second when a long push starts
+	int32_t hold_max_speed;  // Pixels per second
+	int32_t hold_accel;      // Pixels per second, per second
+} NoteScroll;
+
+void note_scroll_init(NoteScroll *scroll, NoteView *view, int32_t auto_speed, 
+					  int32_t hold_speed, int32_t hold_max_speed, int32_t hold_accel);
+void note_scroll_deinit(NoteScroll *scroll);
+
+void note_scroll_to(NoteScroll *scroll, int32_t top);
+void note_scroll_by(NoteScroll *scroll, int32_t pixels);
+
+void note_scroll_hold(NoteScroll *scroll, int8_t direction);
+void note_scroll_release(NoteScroll *scroll);
+void note_scroll_set_auto(NoteScroll *scroll, bool automatic);
+bool note_scroll_get_auto(const NoteScroll *scroll);
+bool note_scroll_moving(const NoteScroll *scroll);
+
+#endif
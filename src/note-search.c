@@ -0,0 +1,241 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Word search over all the notes
+ *******************************************************************************
+ */
+
+#include "note-search.h"
+#include "note-text.h"
+#include "pebble-stats.h"
+#include "pebble-log.h"
+#include "note-lz.h"
+#include <string.h>
+
+#define NOTE_INDEX_HEADER_LEN 12
+#define NOTE_INDEX_WORD_LEN (NOTE_SEARCH_KEY_LEN + 4)
+#define NOTE_SEARCH_NOTE_SHIFT 20
+#define NOTE_SEARCH_OFFSET_MASK 0x000FFFFF
+// Longest posting varint: a 32 bit delta and the restart bit
+#define NOTE_INDEX_VARINT_MAX 5
+// Posting bytes read at a time while counting them
+#define NOTE_INDEX_COUNT_CHUNK 64
+// Bytes of the line before the word shown in the snippet
+#define NOTE_SEARCH_SNIPPET_LEAD 10
+
+static uint32_t note_index_u32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+  /**
+   *  Reads the header of the index starting at base in a resource
+   */
+bool note_index_open(NoteIndex *index, ResHandle handle, uint32_t base) {
+	uint8_t header[NOTE_INDEX_HEADER_LEN];
+	index->handle = handle;
+	index->base = base;
+	index->words = 0;
+	index->postings = 0;
+
+	if (resource_load_byte_range(index->handle, base, header, NOTE_INDEX_HEADER_LEN) != NOTE_INDEX_HEADER_LEN ||
+		header[0] != 'N' || header[1] != 'X' || header[2] != 3 || header[3] != NOTE_SEARCH_KEY_LEN) {
+		LOG_ERROR("###note_index_open: Bad index header###");
+		return false;
+	}
+	index->words = note_index_u32(header + 4);
+	index->postings = note_index_u32(header + 8);
+	return true;
+}
+
+  /**
+   *  Reads word entry i of the table: its key and its first posting
+   */
+static uint32_t note_index_word(NoteIndex *index, uint32_t i, char *key) {
+	uint8_t entry[NOTE_INDEX_WORD_LEN];
+	memset(entry, 0, sizeof(entry));
+	resource_load_byte_range(index->handle, index->base + NOTE_INDEX_HEADER_LEN + NOTE_INDEX_WORD_LEN * i, entry, NOTE_INDEX_WORD_LEN);
+	if (key) memcpy(key, entry, NOTE_SEARCH_KEY_LEN);
+	return note_index_u32(entry + NOTE_SEARCH_KEY_LEN);
+}
+
+  /**
+   *  Offset in the resource of the posting byte at
+   */
+static uint32_t note_index_postings_at(NoteIndex *index, uint32_t at) {
+	return index->base + NOTE_INDEX_HEADER_LEN + NOTE_INDEX_WORD_LEN * (index->words + 1) + at;
+}
+
+  /**
+   *  Postings in the bytes [first, last): each varint ends on a byte below 0x80
+   */
+static uint32_t note_index_count(NoteIndex *index, uint32_t first, uint32_t last) {
+	uint8_t bytes[NOTE_INDEX_COUNT_CHUNK];
+	uint32_t count = 0;
+	while (first < last) {
+		size_t len = (last - first < NOTE_INDEX_COUNT_CHUNK) ? last - first : NOTE_INDEX_COUNT_CHUNK;
+		len = resource_load_byte_range(index->handle, note_index_postings_at(index, first), bytes, len);
+		if (len == 0) break;
+		for (size_t i = 0; i < len; i++) count += bytes[i] < 0x80;
+		first += len;
+	}
+	return count;
+}
+
+  /**
+   *  Finds the words starting with prefix. Their postings are contiguous:
+   *  stores their bytes [first, last) and returns how many postings they hold.
+   */
+uint32_t note_index_lookup(NoteIndex *index, const char *prefix, uint32_t *first, uint32_t *last) {
+	char wanted[NOTE_SEARCH_KEY_LEN];
+	char key[NOTE_SEARCH_KEY_LEN];
+	size_t len = 0;
+
+	*first = 0;
+	*last = 0;
+	memset(wanted, 0, sizeof(wanted));
+	for (; prefix[len] != '\0' && len < NOTE_SEARCH_KEY_LEN; len++) {
+		char ch = prefix[len];
+		wanted[len] = (ch >= 'A' && ch <= 'Z') ? ch - 'A' + 'a' : ch;
+	}
+	if (len == 0 || index->words == 0) return 0;
+
+	// First word not below the prefix
+	uint32_t low = 0, high = index->words;
+	while (low < high) {
+		uint32_t mid = low + (high - low) / 2;
+		note_index_word(index, mid, key);
+		if (memcmp(key, wanted, NOTE_SEARCH_KEY_LEN) < 0) low = mid + 1;
+		else high = mid;
+	}
+	uint32_t from = low;
+
+	// First word past the ones starting with the prefix
+	high = index->words;
+	while (low < high) {
+		uint32_t mid = low + (high - low) / 2;
+		note_index_word(index, mid, key);
+		if (memcmp(key, wanted, len) <= 0) low = mid + 1;
+		else high = mid;
+	}
+	if (low == from) return 0;
+
+	*first = note_index_word(index, from, NULL);
+	*last = note_index_word(index, low, NULL);
+	return note_index_count(index, *first, *last);
+}
+
+  /**
+   *  Looks up query and fills up to max_hits hits, ordered by note and
+   *  offset. When the query is the prefix of several words, the hits kept
+   *  are those of the alphabetically first words. total gets every match.
+   */
+uint32_t note_search_run(NoteIndex *index, const char *query, NoteSearchHit *hits, uint32_t max_hits, uint32_t *total) {
+	uint32_t postings[NOTE_SEARCH_MAX_HITS];
+	uint8_t bytes[NOTE_SEARCH_MAX_HITS * NOTE_INDEX_VARINT_MAX];
+	uint32_t first, last;
+
+	*total = note_index_lookup(index, query, &first, &last);
+	if (max_hits > NOTE_SEARCH_MAX_HITS) max_hits = NOTE_SEARCH_MAX_HITS;
+	if (*total == 0 || max_hits == 0) return 0;
+
+	// The first max_hits varints, each a delta from the posting before
+	// unless it restarts a word
+	size_t read = (last - first < sizeof(bytes)) ? last - first : sizeof(bytes);
+	read = resource_load_byte_range(index->handle,
+									note_index_postings_at(index, first),
+									bytes,
+									read);
+	uint32_t count = 0;
+	uint64_t value = 0;
+	uint8_t shift = 0;
+	uint32_t posting = 0;
+	for (size_t i = 0; i < read && count < max_hits; i++) {
+		value |= (uint64_t)(bytes[i] & 0x7F) << shift;
+		shift += 7;
+		if (bytes[i] & 0x80) continue;
+		posting = ((value & 1) ? 0 : posting) + (uint32_t)(value >> 1);
+		postings[count++] = posting;
+		value = 0;
+		shift = 0;
+	}
+
+	// Postings are note << 20 | offset, so sorting them sorts the hits
+	for (uint32_t i = 1; i < count; i++) {
+		uint32_t posting = postings[i];
+		uint32_t j = i;
+		for (; j > 0 && postings[j - 1] > posting; j--) postings[j] = postings[j - 1];
+		postings[j] = posting;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		hits[i].note = postings[i] >> NOTE_SEARCH_NOTE_SHIFT;
+		hits[i].offset = postings[i] & NOTE_SEARCH_OFFSET_MASK;
+		hits[i].percent = 0;
+		hits[i].snippet[0] = '\0';
+	}
+	return count;
+}
+
+  /**
+   *  Copies the line around pos into a one line snippet, starting at the
+   *  line start if it is close. at_start tells block starts the note.
+   */
+static void note_search_clean_snippet(char *snippet, const char *block, size_t block_len, size_t pos, bool at_start) {
+	size_t start = pos;
+	while (start > 0 && pos - start < NOTE_SEARCH_SNIPPET_LEAD && block[start - 1] != '\n') start--;
+	if (start > 0 ? block[start - 1] != '\n' : !at_start) start = pos;
+
+	const char *end = memchr(block + start, '\n', block_len - start);
+	note_text_one_line(snippet,
+					   NOTE_SEARCH_SNIPPET_LEN,
+					   block + start,
+					   end ? (size_t)(end - (block + start)) : block_len - start);
+}
+
+  /**
+   *  Fills the snippet and position of each hit, decoding into block of
+   *  NOTE_SEARCH_BLOCK_LEN bytes from the caller. Hits come sorted, so every
+   *  note block is decoded once no matter how many hits it holds.
+   */
+void note_search_snippets(NoteSearchHit *hits, uint32_t count, NotePack *pack, char *block) {
+	if (count == 0 || !block) return;
+
+	NoteLz note;
+	NotePackEntry entry;
+	int open_note = -1;
+	int32_t open_block = -1;
+	size_t block_len = 0;
+	bool block_tail = false;
+
+	for (uint32_t i = 0; i < count; i++) {
+		NoteSearchHit *hit = &hits[i];
+		if (hit->note != open_note) {
+			open_note = hit->note;
+			open_block = -1;
+			if (!note_pack_entry(pack, open_note, &entry) || 
+				!note_lz_open(&note, pack->handle, entry.offset)) {
+				note.size = 0;
+				note.block_size = 0;
+			}
+		}
+		if (note.block_size == 0 || hit->offset >= note.size) continue;
+
+		int32_t wanted = hit->offset / note.block_size;
+		if (wanted != open_block) {
+			block_len = note_lz_read_block(&note, wanted, block, NOTE_LZ_MAX_BLOCK);
+			open_block = wanted;
+			block_tail = false;
+		}
+		size_t pos = hit->offset - wanted * note.block_size;
+		if (!block_tail && pos + NOTE_SEARCH_SNIPPET_LEN > block_len && wanted + 1 < note.num_blocks) {
+			block_len += note_lz_read_block(&note, wanted + 1, block + block_len, NOTE_SEARCH_SNIPPET_LEN);
+			block_tail = true;
+		}
+		hit->percent = (uint8_t)((uint64_t)hit->offset * 100 / note.size);
+		note_search_clean_snippet(hit->snippet,
+								  block,
+								  block_len,
+								  pos,
+								  wanted == 0);
+	}
+}
@@ -0,0 +1,47 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Word search over all the notes using the inverted index built by
+ *          tools/build_notes.py (format described in tools/index.py)
+ *
+ *          A lookup is two binary searches over the sorted word table plus
+ *          ranged reads of the postings, delta coded varints counted by
+ *          their end bytes, so it never touches the note text.
+ *          Only the hits that are shown get a snippet decoded.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_SEARCH__
+#define __NOTE_SEARCH__
+
+#include "pebble.h"
+#include "note-pack.h"
+#include "note-lz.h"
+
+#define NOTE_SEARCH_KEY_LEN 12
+#define NOTE_SEARCH_MAX_HITS 16
+#define NOTE_SEARCH_SNIPPET_LEN 28
+// Scratch of note_search_snippets: a block and the head of the next one
+#define NOTE_SEARCH_BLOCK_LEN (NOTE_LZ_MAX_BLOCK + NOTE_SEARCH_SNIPPET_LEN)
+
+typedef struct {
+	ResHandle handle;
+	uint32_t base;        // Offset of the index in the resource
+	uint32_t words;       // Words in the table
+	uint32_t postings;    // Postings in the whole index
+} NoteIndex;
+
+typedef struct {
+	uint16_t note;        // Note row
+	uint32_t offset;      // Byte offset of the word in the note
+	uint8_t percent;      // How far into the note, for the results list
+	char snippet[NOTE_SEARCH_SNIPPET_LEN];
+} NoteSearchHit;
+
+bool note_index_open(NoteIndex *index, ResHandle handle, uint32_t base);
+uint32_t note_index_lookup(NoteIndex *index, const char *prefix, uint32_t *first, uint32_t *last);
+
+uint32_t note_search_run(NoteIndex *index, const char *query, NoteSearchHit *hits, uint32_t max_hits, uint32_t *total);
+void note_search_snippets(NoteSearchHit *hits, uint32_t count, NotePack *pack, char *block);
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Reading position of each note
+ *******************************************************************************
+ */
+
+#include "note-state.h"
+#include "pebble-log.h"
+
+static uint32_t note_state_key(uint32_t hash) {
+	return NOTE_STATE_KEY + hash % NOTE_STATE_SLOTS;
+}
+
+  /**
+   *  Reads the saved state of the note with hash. Without one (or with the
+   *  slot taken by another note) the state starts at the top.
+   */
+bool note_state_load(NoteState *state, uint32_t hash) {
+	NoteState saved;
+	state->hash = hash;
+	state->top = 0;
+	state->height = 0;
+	
+	if (persist_read_data(note_state_key(hash), &saved, sizeof(saved)) != sizeof(saved) ||
+		saved.hash != hash) {
+		return false;
+	}
+	*state = saved;
+	LOG_DEBUG("###note_state_load: %x at %d of %d###", (unsigned)hash, (int)saved.top, (int)saved.height);
+	return true;
+}
+
+  /**
+   *  Saved position for a layout height pixels high, scaled when the note
+   *  was laid out differently when it was saved
+   */
+int32_t note_state_top(const NoteState *state, int32_t height) {
+	if (state->height <= 0 || state->height == height) return state->top;
+	return (int32_t)((int64_t)state->top * height / state->height);
+}
+
+  /**
+   *  Saves the position, writing only when it moved: storage is flash and
+   *  a note opened and closed in place costs nothing
+   */
+void note_state_save(NoteState *state, int32_t top, int32_t height) {
+	if (top == state->top && (height == state->height || (top == 0 && state->height == 0))) return;
+	
+	state->top = top;
+	state->height = height;
+	status_t status = persist_write_data(note_state_key(state->hash), state, sizeof(NoteState));
+	if (status < 0) {
+		LOG_ERROR("###note_state_save: Write failed %d###", (int)status);
+	}
+}
@@ -0,0 +1,35 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Reading position of each note, kept in persistent storage so a
+ *          note reopens where it was left, even after the app is closed
+ *
+ *          Notes are named by the content hash of the pack, so a position
+ *          follows its note when others are added or renamed and is dropped
+ *          when the text changes. Records are direct mapped by hash over
+ *          NOTE_STATE_SLOTS keys: a note that lands on a taken slot takes it.
+ *          The layout height is saved with the position, so a layout built
+ *          for another font scales it instead of landing on the wrong line.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_STATE__
+#define __NOTE_STATE__
+
+#include "pebble.h"
+
+// Persistent storage keys NOTE_STATE_KEY to NOTE_STATE_KEY + NOTE_STATE_SLOTS - 1
+#define NOTE_STATE_KEY 1000
+#define NOTE_STATE_SLOTS 32
+
+typedef struct {
+	uint32_t hash;         // Content hash of the note
+	int32_t top;           // Pixels scrolled into the note
+	int32_t height;        // Pixels of the whole note, 0 when never saved
+} NoteState;
+
+bool note_state_load(NoteState *state, uint32_t hash);
+int32_t note_state_top(const NoteState *state, int32_t height);
+void note_state_save(NoteState *state, int32_t top, int32_t height);
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Notes synced from the phone, kept in persistent storage
+ *******************************************************************************
+ */
+
+#include "note-store.h"
+#include "pebble-stats.h"
+#include "pebble-log.h"
+#include <string.h>
+
+#define NOTE_STORE_VERSION 1
+
+typedef struct {
+	uint8_t version;
+	NoteStoreSlot slot[NOTE_STORE_SLOTS];
+} NoteStoreInventory;
+
+static NoteStoreInventory note_store;
+static const char note_store_marker = 0;
+const ResHandle note_store_handle = (ResHandle)&note_store_marker;
+
+// Last chunk read, records are read a few bytes at a time
+static uint8_t note_store_cache[NOTE_STORE_CHUNK_LEN];
+static uint32_t note_store_cache_key = 0;
+
+static uint32_t note_store_key(uint8_t slot, uint8_t chunk) {
+	return NOTE_STORE_KEY + 1 + slot * NOTE_STORE_CHUNKS + chunk;
+}
+
+static uint8_t note_store_chunks(uint16_t size) {
+	return (size + NOTE_STORE_CHUNK_LEN - 1) / NOTE_STORE_CHUNK_LEN;
+}
+
+  /**
+   *  Bytes of chunk in a record of size, 0 past its end
+   */
+static size_t note_store_chunk_len(uint16_t size, uint8_t chunk) {
+	uint32_t from = NOTE_STORE_CHUNK_LEN * chunk;
+	if (from >= size) return 0;
+	return (size - from < NOTE_STORE_CHUNK_LEN) ? size - from : NOTE_STORE_CHUNK_LEN;
+}
+
+  /**
+   *  Loads the inventory, starting empty when there is none or it is from
+   *  another layout
+   */
+void note_store_init(void) {
+	if (persist_read_data(NOTE_STORE_KEY, &note_store, sizeof(note_store)) != sizeof(note_store) ||
+		note_store.version != NOTE_STORE_VERSION) {
+		memset(&note_store, 0, sizeof(note_store));
+		note_store.version = NOTE_STORE_VERSION;
+	}
+	note_store_cache_key = 0;
+}
+
+void note_store_save(void) {
+	status_t status = persist_write_data(NOTE_STORE_KEY, &note_store, sizeof(note_store));
+	if (status < 0) {
+		LOG_ERROR("###note_store_save: Write failed %d###", (int)status);
+	}
+}
+
+const NoteStoreSlot *note_store_slot(uint8_t slot) {
+	return (slot < NOTE_STORE_SLOTS) ? &note_store.slot[slot] : NULL;
+}
+
+  /**
+   *  CRC-16/CCITT of a chunk, the phone sends the same with it
+   */
+uint16_t note_store_crc(const uint8_t *data, size_t length) {
+	uint16_t crc = 0xFFFF;
+	for (size_t i = 0; i < length; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+	}
+	return crc;
+}
+
+  /**
+   *  Starts (or resumes) receiving the record with hash into slot. Chunks
+   *  already there keep their bytes unless the new size cuts them, the
+   *  phone skips those whose checksum matches.
+   */
+void note_store_begin(uint8_t slot, uint32_t hash, uint16_t size) {
+	if (slot >= NOTE_STORE_SLOTS || size > NOTE_STORE_MAX_LEN) {
+		LOG_WARNING("###note_store_begin: Bad slot %d or size %d###", slot, size);
+		return;
+	}
+	NoteStoreSlot *s = &note_store.slot[slot];
+	for (uint8_t chunk = 0; chunk < NOTE_STORE_CHUNKS; chunk++) {
+		if (note_store_chunk_len(s->size, chunk) != note_store_chunk_len(size, chunk)) s->valid &= ~(1 << chunk);
+	}
+	s->hash = hash;
+	s->size = size;
+	s->complete = false;
+	// Saved now, so a record cut short is never listed after a restart
+	note_store_save();
+}
+
+  /**
+   *  Stores one chunk when its checksum matches. A bad or unexpected chunk
+   *  is dropped and stays missing in the inventory.
+   */
+bool note_store_chunk(uint8_t slot, uint8_t chunk, const uint8_t *data, size_t length, uint16_t crc) {
+	if (slot >= NOTE_STORE_SLOTS) return false;
+	NoteStoreSlot *s = &note_store.slot[slot];
+	if (chunk >= NOTE_STORE_CHUNKS || length == 0 || length != note_store_chunk_len(s->size, chunk) ||
+		note_store_crc(data, length) != crc) {
+		LOG_WARNING("###note_store_chunk: Dropped chunk %d of slot %d###", chunk, slot);
+		return false;
+	}
+	
+	// Overwriting bytes the saved inventory vouches for: disown them first,
+	// a restart in between must not take the new bytes for the old
+	if (s->valid & (1 << chunk)) {
+		s->valid &= ~(1 << chunk);
+		note_store_save();
+	}
+	uint32_t key = note_store_key(slot, chunk);
+	if (persist_write_data(key, data, length) < 0) {
+		LOG_ERROR("###note_store_chunk: Write failed###");
+		return false;
+	}
+	if (key == note_store_cache_key) note_store_cache_key = 0;
+	s->valid |= 1 << chunk;
+	s->crc[chunk] = crc;
+	return true;
+}
+
+  /**
+   *  Ends a transfer: the record shows once every chunk is there
+   */
+bool note_store_end(uint8_t slot) {
+	if (slot >= NOTE_STORE_SLOTS) return false;
+	NoteStoreSlot *s = &note_store.slot[slot];
+	uint8_t chunks = note_store_chunks(s->size);
+	uint8_t all = (chunks < 8) ? (1 << chunks) - 1 : 0xFF;
+	s->complete = s->size > 0 && (s->valid & all) == all;
+	note_store_save();
+	return s->complete;
+}
+
+void note_store_delete(uint8_t slot) {
+	if (slot >= NOTE_STORE_SLOTS) return;
+	NoteStoreSlot *s = &note_store.slot[slot];
+	for (uint8_t chunk = 0; chunk < NOTE_STORE_CHUNKS; chunk++) {
+		if (s->valid & (1 << chunk)) persist_delete(note_store_key(slot, chunk));
+	}
+	memset(s, 0, sizeof(NoteStoreSlot));
+	note_store_cache_key = 0;
+	note_store_save();
+}
+
+  /**
+   *  Complete records, the ones the menu lists
+   */
+uint32_t note_store_count(void) {
+	uint32_t count = 0;
+	for (uint8_t slot = 0; slot < NOTE_STORE_SLOTS; slot++) {
+		if (note_store.slot[slot].complete) count++;
+	}
+	return count;
+}
+
+  /**
+   *  Table of contents entry of the note-th complete record, read from its
+   *  header like a pack entry
+   */
+bool note_store_entry(uint32_t note, NotePackEntry *entry) {
+	uint8_t header[NOTE_STORE_RECORD_HEADER_LEN + 8];
+	memset(entry, 0, sizeof(NotePackEntry));
+	
+	uint8_t slot = 0;
+	for (; slot < NOTE_STORE_SLOTS; slot++) {
+		if (note_store.slot[slot].complete && note-- == 0) break;
+	}
+	if (slot == NOTE_STORE_SLOTS) return false;
+	
+	uint32_t base = slot * NOTE_STORE_SPAN;
+	if (note_store_read(note_store_handle, base, header, sizeof(header)) != sizeof(header) ||
+		header[0] != 'N' || header[1] != 'S' || header[2] != 1) {
+		LOG_ERROR("###note_store_entry: Bad record in slot %d###", slot);
+		return false;
+	}
+	entry->handle = note_store_handle;
+	entry->offset = base + NOTE_STORE_RECORD_HEADER_LEN;
+	entry->length = header[8] | (header[9] << 8);
+	entry->lines_offset = entry->offset + entry->length;
+	entry->lines_length = header[10] | (header[11] << 8);
+	// Plain size from the header of the compressed note, right after
+	entry->size = header[NOTE_STORE_RECORD_HEADER_LEN + 4] | (header[NOTE_STORE_RECORD_HEADER_LEN + 5] << 8) |
+				  (header[NOTE_STORE_RECORD_HEADER_LEN + 6] << 16) | ((uint32_t)header[NOTE_STORE_RECORD_HEADER_LEN + 7] << 24);
+	entry->flags = NOTE_PACK_FLAG_SYNCED;
+	entry->hash = note_store.slot[slot].hash;
+	memcpy(entry->title, header + 12, NOTE_PACK_TITLE_LEN);
+	entry->title[NOTE_PACK_TITLE_LEN - 1] = '\0';
+	return true;
+}
+
+  /**
+   *  Ranged read for every note reader: from a record through
+   *  note_store_handle, else from the resource
+   */
+size_t note_store_read(ResHandle handle, uint32_t offset, uint8_t *buffer, size_t length) {
+	if (handle != note_store_handle) {
+		return resource_load_byte_range(handle, offset, buffer, length);
+	}
+	
+	uint8_t slot = offset / NOTE_STORE_SPAN;
+	uint32_t at = offset % NOTE_STORE_SPAN;
+	if (slot >= NOTE_STORE_SLOTS || at >= note_store.slot[slot].size) return 0;
+	const NoteStoreSlot *s = &note_store.slot[slot];
+	if (length > s->size - at) length = s->size - at;
+	
+	size_t done = 0;
+	while (done < length) {
+		uint8_t chunk = (at + done) / NOTE_STORE_CHUNK_LEN;
+		uint32_t from = (at + done) % NOTE_STORE_CHUNK_LEN;
+		uint32_t key = note_store_key(slot, chunk);
+		if (!(s->valid & (1 << chunk))) break;
+		if (key != note_store_cache_key) {
+			if (persist_read_data(key, note_store_cache, NOTE_STORE_CHUNK_LEN) <= 0) break;
+			note_store_cache_key = key;
+		}
+		size_t take = NOTE_STORE_CHUNK_LEN - from;
+		if (take > length - done) take = length - done;
+		memcpy(buffer + done, note_store_cache + from, take);
+		done += take;
+	}
+	return done;
+}
@@ -0,0 +1,57 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Notes synced from the phone (see note-sync.h), kept in persistent
+ *          storage as the records built by tools/sync.py
+ *
+ *          A record lives in a slot of NOTE_STORE_CHUNKS persist keys of
+ *          NOTE_STORE_CHUNK_LEN bytes, the unit of transfer. The inventory,
+ *          one more key, tells for every slot which chunks hold their bytes
+ *          and their checksums, so a sync resumes where it stopped and only
+ *          sends the chunks that differ. Records are read through
+ *          note_store_handle like a resource, by the same readers as the
+ *          pack notes: note_store_read serves both.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_STORE__
+#define __NOTE_STORE__
+
+#include "pebble.h"
+#include "note-pack.h"
+
+#define NOTE_STORE_SLOTS 3
+#define NOTE_STORE_CHUNKS 8
+#define NOTE_STORE_CHUNK_LEN 128
+#define NOTE_STORE_MAX_LEN (NOTE_STORE_CHUNKS * NOTE_STORE_CHUNK_LEN)
+// Persistent storage keys: the inventory, then the chunks slot by slot
+#define NOTE_STORE_KEY 2000
+// Bytes of a slot as seen through note_store_handle
+#define NOTE_STORE_SPAN 0x10000
+#define NOTE_STORE_RECORD_HEADER_LEN (12 + NOTE_PACK_TITLE_LEN)
+
+typedef struct {
+	uint32_t hash;         // Content hash of the record, 0 for a free slot
+	uint16_t size;         // Record bytes
+	uint8_t valid;         // Bit per chunk holding its bytes
+	bool complete;         // Every chunk arrived since the last begin
+	uint16_t crc[NOTE_STORE_CHUNKS];
+} NoteStoreSlot;
+
+extern const ResHandle note_store_handle;
+
+void note_store_init(void);
+void note_store_save(void);
+const NoteStoreSlot *note_store_slot(uint8_t slot);
+uint16_t note_store_crc(const uint8_t *data, size_t length);
+
+void note_store_begin(uint8_t slot, uint32_t hash, uint16_t size);
+bool note_store_chunk(uint8_t slot, uint8_t chunk, const uint8_t *data, size_t length, uint16_t crc);
+bool note_store_end(uint8_t slot);
+void note_store_delete(uint8_t slot);
+
+uint32_t note_store_count(void);
+bool note_store_entry(uint32_t note, NotePackEntry *entry);
+size_t note_store_read(ResHandle handle, uint32_t offset, uint8_t *buffer, size_t length);
+
+#endif
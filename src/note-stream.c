@@ -0,0 +1,206 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Chunked, windowed reader for note resources
+ *******************************************************************************
+ */
+
+#include "note-stream.h"
+#include "pebble-stats.h"
+#include "pebble-log.h"
+#include <string.h>
+
+  /**
+   *  Reads and decodes one chunk of the note into dest, returns its length.
+   *  Window offsets are chunk multiples, so a chunk that reads short, corrupt
+   *  or locked without its key, is zero filled to the length it should have.
+   */
+static uint32_t note_stream_load_chunk(NoteStream *stream, uint32_t chunk, char *dest) {
+	uint32_t start = chunk * NOTE_CHUNK_LEN;
+	uint32_t len = (stream->size > start) ? stream->size - start : 0;
+	if (len > NOTE_CHUNK_LEN) len = NOTE_CHUNK_LEN;
+	uint32_t read = note_lz_read_block(&stream->note, chunk, dest, len);
+	if (read < len) {
+		LOG_ERROR("###note_stream_load_chunk: Chunk %d read %d of %d bytes###", (int)chunk, (int)read, (int)len);
+		memset(dest + read, 0, len - read);
+	}
+	return len;
+}
+
+  /**
+   *  Gives the stream its window buffer, or takes it back with NULL. The
+   *  window holds nothing afterwards, the owner wipes a buffer it takes back.
+   */
+void note_stream_attach(NoteStream *stream, char *window) {
+	stream->window = window;
+	stream->size = 0;
+	stream->num_chunks = 0;
+	stream->first_chunk = 0;
+	stream->length = 0;
+}
+
+  /**
+   *  Opens the note starting at base in a resource and loads its first window
+   */
+void note_stream_open(NoteStream *stream, ResHandle handle, uint32_t base) {
+	note_stream_prepare(stream, handle, base);
+	note_stream_seek(stream, 0);
+}
+
+  /**
+   *  Opens the note starting at base with an empty window, for
+   *  note_stream_load_next to fill a chunk at a time
+   */
+void note_stream_prepare(NoteStream *stream, ResHandle handle, uint32_t base) {
+	stream->size = 0;
+	stream->num_chunks = 0;
+	if (stream->window == NULL) {
+		LOG_ERROR("###note_stream_prepare: No window buffer###");
+	}
+	else if (note_lz_open(&stream->note, handle, base)) {
+		if (stream->note.block_size == NOTE_CHUNK_LEN) {
+			stream->size = stream->note.size;
+			stream->num_chunks = stream->note.num_blocks;
+		}
+		else {
+			LOG_ERROR("###note_stream_prepare: Block size %d is not %d###", stream->note.block_size, NOTE_CHUNK_LEN);
+		}
+	}
+	stream->first_chunk = 0;
+	stream->length = 0;
+}
+
+  /**
+   *  Wipes the loaded bytes, sized to what was actually loaded
+   */
+void note_stream_close(NoteStream *stream) {
+	if (stream->window) memset(stream->window, 0, stream->length);
+	stream->length = 0;
+}
+
+  /**
+   *  Index of the first chunk of the last window of the note
+   */
+uint32_t note_stream_last_window(const NoteStream *stream) {
+	return (stream->num_chunks > NOTE_WINDOW_CHUNKS) ? stream->num_chunks - NOTE_WINDOW_CHUNKS : 0;
+}
+
+bool note_stream_at_start(const NoteStream *stream) {
+	return stream->first_chunk == 0;
+}
+
+bool note_stream_at_end(const NoteStream *stream) {
+	return stream->first_chunk + NOTE_WINDOW_CHUNKS >= stream->num_chunks;
+}
+
+  /**
+   *  Loads a whole window starting at first_chunk
+   */
+bool note_stream_seek(NoteStream *stream, uint32_t first_chunk) {
+	uint32_t last = note_stream_last_window(stream);
+	if (first_chunk > last) first_chunk = last;
+
+	stream->first_chunk = first_chunk;
+	stream->length = 0;
+	for (uint32_t i = 0; i < NOTE_WINDOW_CHUNKS && first_chunk + i < stream->num_chunks; i++) {
+		stream->length += note_stream_load_chunk(stream, first_chunk + i, stream->window + stream->length);
+	}
+	return true;
+}
+
+  /**
+   *  Slides the window one chunk towards the end of the note
+   */
+bool note_stream_forward(NoteStream *stream) {
+	if (note_stream_at_end(stream)) return false;
+
+	memmove(stream->window, stream->window + NOTE_CHUNK_LEN, stream->length - NOTE_CHUNK_LEN);
+	stream->length -= NOTE_CHUNK_LEN;
+	stream->first_chunk++;
+	stream->length += note_stream_load_chunk(stream,
+											 stream->first_chunk + NOTE_WINDOW_CHUNKS - 1,
+											 stream->window + stream->length);
+	return true;
+}
+
+  /**
+   *  Slides the window one chunk towards the start of the note
+   */
+bool note_stream_backward(NoteStream *stream) {
+	if (note_stream_at_start(stream)) return false;
+
+	const uint32_t keep_max = NOTE_WINDOW_LEN - NOTE_CHUNK_LEN;
+	uint32_t keep = (stream->length < keep_max) ? stream->length : keep_max;
+
+	memmove(stream->window + NOTE_CHUNK_LEN, stream->window, keep);
+	stream->first_chunk--;
+	stream->length = note_stream_load_chunk(stream, stream->first_chunk, stream->window) + keep;
+	return true;
+}
+
+  /**
+   *  Moves the window so it holds the note bytes in [from, to), keeping a
+   *  spare chunk above them. Nearby moves slide, far ones reload the window.
+   */
+void note_stream_cover(NoteStream *stream, uint32_t from, uint32_t to) {
+	if (note_stream_holds(stream, from, to)) return;
+	
+	uint32_t wanted = note_stream_window_for(stream, from);
+	if (wanted + NOTE_WINDOW_CHUNKS <= stream->first_chunk || 
+		wanted >= stream->first_chunk + NOTE_WINDOW_CHUNKS) {
+		note_stream_seek(stream, wanted);
+		return;
+	}
+	while (stream->first_chunk < wanted && note_stream_forward(stream));
+	while (stream->first_chunk > wanted && note_stream_backward(stream));
+}
+
+  /**
+   *  First chunk of the window note_stream_cover loads for text from from
+   */
+uint32_t note_stream_window_for(const NoteStream *stream, uint32_t from) {
+	uint32_t wanted = from / NOTE_CHUNK_LEN;
+	if (wanted > 0) wanted--;
+	return (wanted > note_stream_last_window(stream)) ? note_stream_last_window(stream) : wanted;
+}
+
+  /**
+   *  Loads the next chunk of the window starting at first_chunk, emptying
+   *  the window first if it starts elsewhere. False once the window is full.
+   */
+bool note_stream_load_next(NoteStream *stream, uint32_t first_chunk) {
+	if (stream->first_chunk != first_chunk) {
+		stream->first_chunk = first_chunk;
+		stream->length = 0;
+	}
+	uint32_t loaded = (stream->length + NOTE_CHUNK_LEN - 1) / NOTE_CHUNK_LEN;
+	if (loaded >= NOTE_WINDOW_CHUNKS || first_chunk + loaded >= stream->num_chunks) return false;
+	
+	stream->length += note_stream_load_chunk(stream, first_chunk + loaded, stream->window + stream->length);
+	return true;
+}
+
+  /**
+   *  Note offset of the first byte held in the window
+   */
+uint32_t note_stream_start_offset(const NoteStream *stream) {
+	return stream->first_chunk * NOTE_CHUNK_LEN;
+}
+
+  /**
+   *  Note offset just past the last byte held in the window
+   */
+uint32_t note_stream_end_offset(const NoteStream *stream) {
+	return stream->first_chunk * NOTE_CHUNK_LEN + stream->length;
+}
+
+bool note_stream_holds(const NoteStream *stream, uint32_t from, uint32_t to) {
+	return from >= note_stream_start_offset(stream) && to <= note_stream_end_offset(stream);
+}
+
+  /**
+   *  Pointer to a note offset currently held in the window
+   */
+const char *note_stream_at(const NoteStream *stream, uint32_t offset) {
+	return stream->window + (offset - stream->first_chunk * NOTE_CHUNK_LEN);
+}
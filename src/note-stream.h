@@ -0,0 +1,55 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Chunked, windowed reader for note resources
+ *
+ *          Only NOTE_WINDOW_CHUNKS chunks of NOTE_CHUNK_LEN bytes are kept in
+ *          RAM at once. The window slides one chunk at a time as the user
+ *          scrolls, so memory use does not depend on the note size. Chunks
+ *          are the blocks of the compressed note, see note-lz.h. The window
+ *          buffer is the owner's, attached with note_stream_attach: without
+ *          one a note opens empty.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_STREAM__
+#define __NOTE_STREAM__
+
+#include "pebble.h"
+#include "note-lz.h"
+
+#define NOTE_CHUNK_LEN 512
+#define NOTE_WINDOW_CHUNKS 4
+#define NOTE_WINDOW_LEN (NOTE_CHUNK_LEN * NOTE_WINDOW_CHUNKS)
+
+typedef struct {
+	NoteLz note;             // Compressed note resource
+	uint32_t size;           // Whole note size in bytes
+	uint32_t num_chunks;     // Whole note size in chunks
+	uint32_t first_chunk;    // First chunk held in the window
+	uint32_t length;         // Valid bytes held in the window
+	char *window;            // NOTE_WINDOW_LEN bytes, NULL while detached
+} NoteStream;
+
+void note_stream_attach(NoteStream *stream, char *window);
+void note_stream_open(NoteStream *stream, ResHandle handle, uint32_t base);
+void note_stream_prepare(NoteStream *stream, ResHandle handle, uint32_t base);
+void note_stream_close(NoteStream *stream);
+
+bool note_stream_seek(NoteStream *stream, uint32_t first_chunk);
+bool note_stream_forward(NoteStream *stream);
+bool note_stream_backward(NoteStream *stream);
+void note_stream_cover(NoteStream *stream, uint32_t from, uint32_t to);
+uint32_t note_stream_window_for(const NoteStream *stream, uint32_t from);
+bool note_stream_load_next(NoteStream *stream, uint32_t first_chunk);
+
+bool note_stream_at_start(const NoteStream *stream);
+bool note_stream_at_end(const NoteStream *stream);
+uint32_t note_stream_last_window(const NoteStream *stream);
+
+uint32_t note_stream_start_offset(const NoteStream *stream);
+uint32_t note_stream_end_offset(const NoteStream *stream);
+bool note_stream_holds(const NoteStream *stream, uint32_t from, uint32_t to);
+const char *note_stream_at(const NoteStream *stream, uint32_t offset);
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Note sync from the phone over AppMessage
+ *******************************************************************************
+ */
+
+#include "note-sync.h"
+#include "note-store.h"
+#include "pebble-log.h"
+
+static NoteSyncChanged note_sync_changed = NULL;
+// The inventory waits here when the outbox is busy
+static bool note_sync_pending = false;
+
+  /**
+   *  Sends the inventory to the phone, or leaves it pending
+   */
+static void note_sync_hello(void) {
+	uint8_t inventory[NOTE_SYNC_SLOT_LEN * NOTE_STORE_SLOTS];
+	DictionaryIterator *iter;
+	
+	if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+		note_sync_pending = true;
+		return;
+	}
+	for (uint8_t slot = 0; slot < NOTE_STORE_SLOTS; slot++) {
+		const NoteStoreSlot *s = note_store_slot(slot);
+		uint8_t *p = inventory + NOTE_SYNC_SLOT_LEN * slot;
+		p[0] = s->hash;
+		p[1] = s->hash >> 8;
+		p[2] = s->hash >> 16;
+		p[3] = s->hash >> 24;
+		p[4] = s->size;
+		p[5] = s->size >> 8;
+		p[6] = s->valid;
+		p[7] = s->complete;
+		for (uint8_t chunk = 0; chunk < NOTE_STORE_CHUNKS; chunk++) {
+			p[8 + 2 * chunk] = s->crc[chunk];
+			p[9 + 2 * chunk] = s->crc[chunk] >> 8;
+		}
+	}
+	dict_write_uint8(iter, NOTE_SYNC_KEY_OP, NOTE_SYNC_HELLO);
+	dict_write_data(iter, NOTE_SYNC_KEY_INVENTORY, inventory, sizeof(inventory));
+	note_sync_pending = (app_message_outbox_send() != APP_MSG_OK);
+}
+
+static uint32_t note_sync_uint(DictionaryIterator *iter, uint32_t key) {
+	Tuple *tuple = dict_find(iter, key);
+	if (!tuple) return 0;
+	switch (tuple->length) {
+		case 1: return tuple->value->uint8;
+		case 2: return tuple->value->uint16;
+		default: return tuple->value->uint32;
+	}
+}
+
+  /**
+   *  One phone message, applied to the store as it comes
+   */
+static void note_sync_received(DictionaryIterator *iter, void *context) {
+	uint8_t op = note_sync_uint(iter, NOTE_SYNC_KEY_OP);
+	uint8_t slot = note_sync_uint(iter, NOTE_SYNC_KEY_SLOT);
+	const NoteStoreSlot *s = note_store_slot(slot);
+	bool listed = s && s->complete;
+	
+	switch (op) {
+		case NOTE_SYNC_HELLO:
+			note_sync_hello();
+			return;
+		case NOTE_SYNC_BEGIN:
+			note_store_begin(slot, 
+							 note_sync_uint(iter, NOTE_SYNC_KEY_HASH), 
+							 note_sync_uint(iter, NOTE_SYNC_KEY_SIZE));
+			break;
+		case NOTE_SYNC_CHUNK: {
+			Tuple *data = dict_find(iter, NOTE_SYNC_KEY_DATA);
+			if (data) {
+				note_store_chunk(slot, 
+								 note_sync_uint(iter, NOTE_SYNC_KEY_INDEX), 
+								 data->value->data, 
+								 data->length, 
+								 note_sync_uint(iter, NOTE_SYNC_KEY_CRC));
+			}
+			break;
+		}
+		case NOTE_SYNC_END:
+			LOG_INFO("###note_sync_received: Slot %d %s###", slot, note_store_end(slot) ? "complete" : "missing chunks");
+			break;
+		case NOTE_SYNC_DELETE:
+			note_store_delete(slot);
+			break;
+		default:
+			LOG_WARNING("###note_sync_received: Unknown op %d###", op);
+			return;
+	}
+	
+	if (note_sync_pending) note_sync_hello();
+	if (s && s->complete != listed && note_sync_changed) note_sync_changed();
+}
+
+static void note_sync_dropped(AppMessageResult reason, void *context) {
+	LOG_WARNING("###note_sync_dropped: Message dropped %d###", reason);
+}
+
+static void note_sync_sent(DictionaryIterator *iter, void *context) {
+	if (note_sync_pending) note_sync_hello();
+}
+
+  /**
+   *  The phone gets the inventory again with its next HELLO
+   */
+static void note_sync_failed(DictionaryIterator *iter, AppMessageResult reason, void *context) {
+	LOG_DEBUG("###note_sync_failed: Inventory not sent %d###", reason);
+}
+
+  /**
+   *  Loads the store and listens to the phone. changed is called when the
+   *  synced notes come or go.
+   */
+void note_sync_init(NoteSyncChanged changed) {
+	note_sync_changed = changed;
+	note_sync_pending = false;
+	note_store_init();
+	
+	app_message_register_inbox_received(note_sync_received);
+	app_message_register_inbox_dropped(note_sync_dropped);
+	app_message_register_outbox_sent(note_sync_sent);
+	app_message_register_outbox_failed(note_sync_failed);
+	app_message_open(NOTE_SYNC_INBOX_LEN, 
+					 NOTE_SYNC_OUTBOX_LEN);
+	
+	// A phone already there starts syncing right away
+	note_sync_hello();
+}
+
+  /**
+   *  Keeps the chunks that arrived for a sync cut short
+   */
+void note_sync_deinit(void) {
+	app_message_deregister_callbacks();
+	note_store_save();
+	note_sync_changed = NULL;
+}
@@ -0,0 +1,64 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Note sync from the phone over AppMessage, into note-store.h
+ *
+ *          The phone drives it. It says HELLO, the watch answers with its
+ *          inventory: for every slot the record hash, size, the chunks it
+ *          holds and their checksums. The phone then sends, for every slot
+ *          whose record differs, BEGIN, only the CHUNKs whose checksum does
+ *          not match, and END; DELETE frees a slot. Once the watch acked
+ *          them all the phone says HELLO again, so a dropped or corrupt
+ *          chunk shows missing and is sent again, until nothing differs.
+ *          Chunks are kept as they arrive: a sync cut short resumes where
+ *          it stopped on the next HELLO.
+ *
+ *          Message keys, as in appinfo.json:
+ *              NOTE_SYNC_KEY_OP         u8  NoteSyncOp
+ *              NOTE_SYNC_KEY_SLOT       u8  BEGIN, CHUNK, END, DELETE
+ *              NOTE_SYNC_KEY_INDEX      u8  CHUNK: chunk of the record
+ *              NOTE_SYNC_KEY_DATA       bytes CHUNK: its bytes
+ *              NOTE_SYNC_KEY_CRC        u16 CHUNK: CRC-16/CCITT of them
+ *              NOTE_SYNC_KEY_HASH       u32 BEGIN: content hash of the record
+ *              NOTE_SYNC_KEY_SIZE       u16 BEGIN: record bytes
+ *              NOTE_SYNC_KEY_INVENTORY  bytes HELLO from the watch:
+ *                  NOTE_SYNC_SLOT_LEN per slot, little endian: u32 hash,
+ *                  u16 size, u8 chunks held (bit per chunk), u8 complete,
+ *                  u16 crc per chunk
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_SYNC__
+#define __NOTE_SYNC__
+
+#include "pebble.h"
+
+#define NOTE_SYNC_KEY_OP 0
+#define NOTE_SYNC_KEY_SLOT 1
+#define NOTE_SYNC_KEY_INDEX 2
+#define NOTE_SYNC_KEY_DATA 3
+#define NOTE_SYNC_KEY_CRC 4
+#define NOTE_SYNC_KEY_HASH 5
+#define NOTE_SYNC_KEY_SIZE 6
+#define NOTE_SYNC_KEY_INVENTORY 7
+
+// Room for a chunk and its keys in, the inventory out
+#define NOTE_SYNC_INBOX_LEN 256
+#define NOTE_SYNC_OUTBOX_LEN 128
+#define NOTE_SYNC_SLOT_LEN 24
+
+typedef enum {
+	NOTE_SYNC_HELLO = 1,
+	NOTE_SYNC_BEGIN = 2,
+	NOTE_SYNC_CHUNK = 3,
+	NOTE_SYNC_END = 4,
+	NOTE_SYNC_DELETE = 5,
+} NoteSyncOp;
+
+// Called when the synced notes the menu lists change
+typedef void (*NoteSyncChanged)(void);
+
+void note_sync_init(NoteSyncChanged changed);
+void note_sync_deinit(void);
+
+#endif
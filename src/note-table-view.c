@@ -0,0 +1,178 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Table layer for CSV notes
+ *******************************************************************************
+ */
+
+#include "note-table-view.h"
+#include "pebble-stats.h"
+
+static char note_table_view_cells[NOTE_TABLE_MAX_RUN][NOTE_TABLE_CELL_LEN];
+
+  /**
+   *  Columns from first that fit across width, at least one
+   */
+static uint8_t note_table_view_fit(NoteTable *table, uint8_t first, int16_t width) {
+	uint8_t count = 0;
+	int16_t x = 0;
+	for (uint8_t c = first; c < table->columns; c++) {
+		if (count > 0 && x + table->column[c].width > width) break;
+		x += table->column[c].width;
+		count++;
+	}
+	return count;
+}
+
+  /**
+   *  Header, then one column at a time: a ranged read of the rows on
+   *  screen and a text draw per cell
+   */
+static void note_table_view_draw(NoteTableView *view, Layer *layer, GContext *ctx) {
+	GRect bounds = layer_get_bounds(layer);
+	NoteTable *table = view->table;
+	int16_t row_height = table->row_height;
+	uint32_t rows = note_table_view_page_rows(view);
+	uint8_t columns = note_table_view_fit(table, view->column, bounds.size.w);
+
+	graphics_context_set_text_color(ctx, GColorBlack);
+	graphics_context_set_stroke_color(ctx, GColorBlack);
+	graphics_draw_line(ctx,
+					   GPoint(0, row_height),
+					   GPoint(bounds.size.w, row_height));
+	
+	// The marked row goes under the cells, black across the whole width
+	int32_t marked = -1;
+	if (view->marked >= (int32_t)view->top && view->marked < (int32_t)(view->top + rows)) {
+		marked = view->marked - view->top;
+		graphics_context_set_fill_color(ctx, GColorBlack);
+		graphics_fill_rect(ctx,
+						   GRect(0, row_height * (marked + 1), bounds.size.w, row_height),
+						   0,
+						   GCornerNone);
+	}
+
+	int16_t x = 0;
+	for (uint8_t c = view->column; c < view->column + columns; c++) {
+		NoteTableColumn *column = &table->column[c];
+		// Numbers line up on the right, text on the left
+		GTextAlignment align = (column->type == NOTE_TABLE_NUMBER) ? GTextAlignmentRight : GTextAlignmentLeft;
+		int16_t w = column->width - 3;
+		if (w > bounds.size.w - x) w = bounds.size.w - x;
+
+		graphics_draw_text(ctx,
+						   column->name,
+						   view->font,
+						   GRect(x, -2, w, row_height),
+						   GTextOverflowModeTrailingEllipsis,
+						   align,
+						   NULL);
+		uint32_t count = note_table_read(table,
+										 c,
+										 view->top,
+										 rows,
+										 note_table_view_cells);
+		for (uint32_t i = 0; i < count; i++) {
+			graphics_context_set_text_color(ctx, ((int32_t)i == marked) ? GColorWhite : GColorBlack);
+			graphics_draw_text(ctx,
+							   note_table_view_cells[i],
+							   view->font,
+							   GRect(x, row_height * (i + 1), w, row_height),
+							   GTextOverflowModeTrailingEllipsis,
+							   align,
+							   NULL);
+		}
+		graphics_context_set_text_color(ctx, GColorBlack);
+		x += column->width;
+	}
+}
+
+static void note_table_view_update_proc(Layer *layer, GContext *ctx) {
+	STATS_BEGIN(STATS_NOTE_VIEW_DRAW);
+	note_table_view_draw(*(NoteTableView**)layer_get_data(layer), layer, ctx);
+	STATS_END(STATS_NOTE_VIEW_DRAW);
+}
+
+  /**
+   *  Creates the layer of the view over an opened table
+   */
+void note_table_view_init(NoteTableView *view, GRect frame, NoteTable *table, GFont font) {
+	view->table = table;
+	view->font = font;
+	view->top = 0;
+	view->column = 0;
+	view->marked = -1;
+	view->layer = layer_create_with_data(frame, sizeof(NoteTableView*));
+	*(NoteTableView**)layer_get_data(view->layer) = view;
+	layer_set_update_proc(view->layer, note_table_view_update_proc);
+}
+
+void note_table_view_deinit(NoteTableView *view) {
+	layer_destroy(view->layer);
+	view->layer = NULL;
+}
+
+  /**
+   *  Points the existing layer at a newly opened table, first row and column
+   */
+void note_table_view_bind(NoteTableView *view, NoteTable *table) {
+	view->table = table;
+	view->top = 0;
+	view->column = 0;
+	view->marked = -1;
+	layer_mark_dirty(view->layer);
+}
+
+Layer *note_table_view_get_layer(NoteTableView *view) {
+	return view->layer;
+}
+
+  /**
+   *  Rows that fit under the header
+   */
+uint32_t note_table_view_page_rows(NoteTableView *view) {
+	int16_t height = layer_get_bounds(view->layer).size.h - view->table->row_height;
+	uint32_t rows = (height > 0) ? height / view->table->row_height : 1;
+	if (rows == 0) rows = 1;
+	return (rows > NOTE_TABLE_MAX_RUN) ? NOTE_TABLE_MAX_RUN : rows;
+}
+
+  /**
+   *  Moves rows down (or up when negative), keeping the last page full
+   */
+void note_table_view_scroll(NoteTableView *view, int32_t rows) {
+	uint32_t page = note_table_view_page_rows(view);
+	int32_t max = (view->table->rows > page) ? view->table->rows - page : 0;
+	int32_t top = (int32_t)view->top + rows;
+	if (top > max) top = max;
+	if (top < 0) top = 0;
+	if ((uint32_t)top == view->top) return;
+
+	view->top = top;
+	layer_mark_dirty(view->layer);
+}
+
+  /**
+   *  Pages to the columns after the ones on screen, back to the first after
+   *  the last
+   */
+void note_table_view_next_columns(NoteTableView *view) {
+	uint8_t shown = note_table_view_fit(view->table, view->column, layer_get_bounds(view->layer).size.w);
+	uint8_t next = view->column + shown;
+	if (next >= view->table->columns) next = 0;
+	if (next == view->column) return;
+
+	view->column = next;
+	layer_mark_dirty(view->layer);
+}
+
+  /**
+   *  Marks row and scrolls it to the top of the page, or as near as the
+   *  last page allows
+   */
+void note_table_view_show_row(NoteTableView *view, uint32_t row) {
+	if (row >= view->table->rows) return;
+	view->marked = row;
+	note_table_view_scroll(view, (int32_t)row - (int32_t)view->top);
+	layer_mark_dirty(view->layer);
+}
@@ -0,0 +1,36 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Table layer for CSV notes. Shows a header with the column names
+ *          and the rows that fit under it, for the page of columns that
+ *          fits across the screen. Only those cells are read and decoded,
+ *          a column at a time. A row found by key is drawn inverted.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_TABLE_VIEW__
+#define __NOTE_TABLE_VIEW__
+
+#include "pebble.h"
+#include "note-table.h"
+
+typedef struct {
+	Layer *layer;
+	NoteTable *table;
+	GFont font;
+	uint32_t top;          // First row on screen
+	uint8_t column;        // First column on screen
+	int32_t marked;        // Row drawn inverted, -1 for none
+} NoteTableView;
+
+void note_table_view_init(NoteTableView *view, GRect frame, NoteTable *table, GFont font);
+void note_table_view_deinit(NoteTableView *view);
+void note_table_view_bind(NoteTableView *view, NoteTable *table);
+Layer *note_table_view_get_layer(NoteTableView *view);
+
+uint32_t note_table_view_page_rows(NoteTableView *view);
+void note_table_view_scroll(NoteTableView *view, int32_t rows);
+void note_table_view_next_columns(NoteTableView *view);
+void note_table_view_show_row(NoteTableView *view, uint32_t row);
+
+#endif
@@ -0,0 +1,297 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Reader for the columnar tables of CSV notes
+ *******************************************************************************
+ */
+
+#include "note-table.h"
+#include "pebble-stats.h"
+#include "pebble-log.h"
+#include "mini-printf.h"
+#include <string.h>
+
+#define NOTE_TABLE_HEADER_LEN 8
+#define NOTE_TABLE_COLUMN_LEN (16 + NOTE_TABLE_NAME_LEN)
+#define NOTE_TABLE_KEY_DESC_LEN 12
+#define NOTE_TABLE_SIGNED 1
+// Strings of neighbour rows sit together in the pool, read them in one go
+// when they span at most this
+#define NOTE_TABLE_SPAN_LEN 256
+
+static uint8_t note_table_span[NOTE_TABLE_SPAN_LEN];
+
+static uint32_t note_table_u32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+  /**
+   *  Key hash of tools/table.py: FNV-1a from a seeded basis, then a fold
+   */
+static uint32_t note_table_hash(const char *key, size_t len, uint32_t seed) {
+	uint32_t h = 2166136261u ^ seed;
+	for (size_t i = 0; i < len; i++) {
+		h ^= (uint8_t)key[i];
+		h *= 16777619u;
+	}
+	return h ^ (h >> 15);
+}
+
+  /**
+   *  Reads the header and every column descriptor, in one read each
+   */
+bool note_table_open(NoteTable *table, ResHandle handle, uint32_t base) {
+	uint8_t header[NOTE_TABLE_HEADER_LEN];
+	uint8_t columns[NOTE_TABLE_COLUMN_LEN * NOTE_TABLE_MAX_COLUMNS];
+	table->handle = handle;
+	table->base = base;
+	table->rows = 0;
+	table->columns = 0;
+	table->row_height = 16;
+	table->keys = 0;
+
+	if (resource_load_byte_range(handle, base, header, NOTE_TABLE_HEADER_LEN) != NOTE_TABLE_HEADER_LEN ||
+		header[0] != 'N' || header[1] != 'T' || header[2] != 2 ||
+		header[3] == 0 || header[3] > NOTE_TABLE_MAX_COLUMNS || header[7] > NOTE_TABLE_MAX_KEYS) {
+		LOG_ERROR("###note_table_open: Bad table header###");
+		return false;
+	}
+	size_t length = NOTE_TABLE_COLUMN_LEN * header[3];
+	if (resource_load_byte_range(handle, base + NOTE_TABLE_HEADER_LEN, columns, length) != length) {
+		LOG_ERROR("###note_table_open: Short column table###");
+		return false;
+	}
+
+	for (uint8_t c = 0; c < header[3]; c++) {
+		const uint8_t *p = columns + NOTE_TABLE_COLUMN_LEN * c;
+		NoteTableColumn *column = &table->column[c];
+		column->type = p[0];
+		column->bytes = p[1];
+		column->is_signed = (p[2] & NOTE_TABLE_SIGNED) != 0;
+		column->scale = p[3];
+		column->width = p[4];
+		column->values = note_table_u32(p + 8);
+		column->pool = note_table_u32(p + 12);
+		memcpy(column->name, p + 16, NOTE_TABLE_NAME_LEN);
+		column->name[NOTE_TABLE_NAME_LEN - 1] = '\0';
+		if (column->bytes != 1 && column->bytes != 2 && column->bytes != 4) {
+			LOG_ERROR("###note_table_open: Bad column %d###", c);
+			return false;
+		}
+	}
+
+	// Key descriptors follow the columns, read them over the same buffer
+	length = NOTE_TABLE_KEY_DESC_LEN * header[7];
+	if (length > 0 &&
+		resource_load_byte_range(handle, base + NOTE_TABLE_HEADER_LEN + NOTE_TABLE_COLUMN_LEN * header[3], columns, length) != length) {
+		LOG_ERROR("###note_table_open: Short key table###");
+		return false;
+	}
+	for (uint8_t k = 0; k < header[7]; k++) {
+		const uint8_t *p = columns + NOTE_TABLE_KEY_DESC_LEN * k;
+		NoteTableKey *key = &table->key[k];
+		key->column = p[0];
+		key->length = p[1];
+		key->buckets = p[2] | (p[3] << 8);
+		key->seeds = note_table_u32(p + 4);
+		key->slots = note_table_u32(p + 8);
+		key->seed = NULL;
+		if (key->column >= header[3] || key->length == 0 || key->length > NOTE_TABLE_KEY_LEN || key->buckets == 0) {
+			LOG_ERROR("###note_table_open: Bad key %d###", k);
+			return false;
+		}
+	}
+	table->columns = header[3];
+	table->keys = header[7];
+	table->rows = header[4] | (header[5] << 8);
+	if (header[6] > 0) table->row_height = header[6];
+	return true;
+}
+
+  /**
+   *  Rows of the table at base, from its header alone
+   */
+uint16_t note_table_count_rows(ResHandle handle, uint32_t base) {
+	uint8_t header[NOTE_TABLE_HEADER_LEN];
+	if (resource_load_byte_range(handle, base, header, NOTE_TABLE_HEADER_LEN) != NOTE_TABLE_HEADER_LEN ||
+		header[0] != 'N' || header[1] != 'T') {
+		return 0;
+	}
+	return header[4] | (header[5] << 8);
+}
+
+  /**
+   *  Value i of a run of little endian values, sign extended when needed
+   */
+static int32_t note_table_value(const NoteTableColumn *column, const uint8_t *values, uint32_t i) {
+	const uint8_t *p = values + column->bytes * i;
+	switch (column->bytes) {
+		case 1: return column->is_signed ? (int8_t)p[0] : p[0];
+		case 2: return column->is_signed ? (int16_t)(p[0] | (p[1] << 8)) : (p[0] | (p[1] << 8));
+		default: return (int32_t)note_table_u32(p);
+	}
+}
+
+  /**
+   *  Fixed point to text, trailing zeros of the decimals dropped
+   */
+static void note_table_format(const NoteTableColumn *column, int32_t value, char *cell) {
+	bool negative = column->is_signed && value < 0;
+	uint32_t magnitude = negative ? 0U - (uint32_t)value : (uint32_t)value;
+	uint32_t unit = 1;
+	for (uint8_t i = 0; i < column->scale; i++) unit *= 10;
+
+	int len = mini_snprintf(cell, NOTE_TABLE_CELL_LEN, "%s%u", negative ? "-" : "", (unsigned)(magnitude / unit));
+	uint32_t fraction = magnitude % unit;
+	if (fraction == 0 || len >= NOTE_TABLE_CELL_LEN - 2) return;
+
+	uint8_t digits = column->scale;
+	while (fraction % 10 == 0) {
+		fraction /= 10;
+		digits--;
+	}
+	char text[12];
+	int fraction_len = mini_snprintf(text, sizeof(text), "%u", (unsigned)fraction);
+	cell[len++] = '.';
+	for (int zeros = digits - fraction_len; zeros > 0 && len < NOTE_TABLE_CELL_LEN - 1; zeros--) cell[len++] = '0';
+	for (int i = 0; i < fraction_len && len < NOTE_TABLE_CELL_LEN - 1; i++) cell[len++] = text[i];
+	cell[len] = '\0';
+}
+
+  /**
+   *  Fills cells with the text of count rows of column from first. One read
+   *  for the values; a text column adds one read for the strings when they
+   *  sit close together, else one per cell. Returns the rows read.
+   */
+uint32_t note_table_read(NoteTable *table, uint8_t column, uint32_t first, uint32_t count,
+						 char cells[][NOTE_TABLE_CELL_LEN]) {
+	uint8_t values[4 * NOTE_TABLE_MAX_RUN];
+	if (column >= table->columns || first >= table->rows) return 0;
+	if (count > NOTE_TABLE_MAX_RUN) count = NOTE_TABLE_MAX_RUN;
+	if (count > table->rows - first) count = table->rows - first;
+
+	const NoteTableColumn *col = &table->column[column];
+	size_t read = resource_load_byte_range(table->handle,
+										   table->base + col->values + col->bytes * first,
+										   values,
+										   col->bytes * count);
+	count = read / col->bytes;
+
+	if (col->type == NOTE_TABLE_NUMBER) {
+		for (uint32_t i = 0; i < count; i++) {
+			note_table_format(col, note_table_value(col, values, i), cells[i]);
+		}
+		return count;
+	}
+
+	// Text: values are offsets into the pool
+	uint32_t low = UINT32_MAX, high = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t offset = (uint32_t)note_table_value(col, values, i);
+		if (offset < low) low = offset;
+		if (offset > high) high = offset;
+	}
+	size_t span = 0;
+	if (count > 0 && high - low + NOTE_TABLE_CELL_LEN <= NOTE_TABLE_SPAN_LEN) {
+		span = resource_load_byte_range(table->handle,
+										table->base + col->pool + low,
+										note_table_span,
+										high - low + NOTE_TABLE_CELL_LEN);
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t offset = (uint32_t)note_table_value(col, values, i);
+		if (span > 0) {
+			size_t at = offset - low;
+			size_t len = (span > at) ? span - at : 0;
+			if (len > NOTE_TABLE_CELL_LEN - 1) len = NOTE_TABLE_CELL_LEN - 1;
+			memcpy(cells[i], note_table_span + at, len);
+			cells[i][len] = '\0';
+		}
+		else {
+			size_t len = resource_load_byte_range(table->handle,
+												  table->base + col->pool + offset,
+												  (uint8_t*)cells[i],
+												  NOTE_TABLE_CELL_LEN - 1);
+			cells[i][len] = '\0';
+		}
+	}
+	return count;
+}
+
+  /**
+   *  Bytes of the bucket seeds of every key column, 0 when there are none
+   *  or they go over NOTE_TABLE_MAX_SEEDS and lookups read them instead
+   */
+size_t note_table_keys_len(const NoteTable *table) {
+	uint32_t total = 0;
+	for (uint8_t k = 0; k < table->keys; k++) total += table->key[k].buckets;
+	return (total > NOTE_TABLE_MAX_SEEDS) ? 0 : 2 * total;
+}
+
+  /**
+   *  Keeps the bucket seeds of every key column in RAM, in seeds of
+   *  note_table_keys_len bytes from the owner, so a lookup is one read.
+   *  Without seeds lookups read their seed too.
+   */
+void note_table_load_keys(NoteTable *table, uint16_t *seeds) {
+	if (!seeds || note_table_keys_len(table) == 0) return;
+	for (uint8_t k = 0; k < table->keys; k++) {
+		NoteTableKey *key = &table->key[k];
+		resource_load_byte_range(table->handle,
+								 table->base + key->seeds,
+								 (uint8_t*)seeds,
+								 2 * key->buckets);
+		for (uint16_t b = 0; b < key->buckets; b++) {
+			uint8_t *p = (uint8_t*)&seeds[b];
+			seeds[b] = p[0] | (p[1] << 8);
+		}
+		key->seed = seeds;
+		seeds += key->buckets;
+	}
+}
+
+  /**
+   *  Forgets the seeds before the owner takes their buffer back
+   */
+void note_table_unload_keys(NoteTable *table) {
+	for (uint8_t k = 0; k < table->keys; k++) table->key[k].seed = NULL;
+}
+
+  /**
+   *  Row whose cell in a key column is key (lowercase), trying the key
+   *  columns in order, or -1. Stores the column it was found in.
+   */
+int32_t note_table_find(NoteTable *table, const char *key, uint8_t *column) {
+	uint8_t slot[NOTE_TABLE_KEY_LEN + 2];
+	size_t len = strlen(key);
+	if (len == 0 || table->rows == 0) return -1;
+
+	for (uint8_t k = 0; k < table->keys; k++) {
+		NoteTableKey *index = &table->key[k];
+		if (len > index->length) continue;
+
+		uint16_t bucket = note_table_hash(key, len, 0) % index->buckets;
+		uint16_t seed;
+		if (index->seed) {
+			seed = index->seed[bucket];
+		}
+		else {
+			uint8_t p[2] = { 0, 0 };
+			resource_load_byte_range(table->handle, table->base + index->seeds + 2 * bucket, p, 2);
+			seed = p[0] | (p[1] << 8);
+		}
+		uint32_t at = note_table_hash(key, len, seed) % table->rows;
+		if (resource_load_byte_range(table->handle,
+									 table->base + index->slots + (index->length + 2) * at,
+									 slot,
+									 index->length + 2) != (size_t)(index->length + 2)) {
+			continue;
+		}
+		// Keys are NUL padded, so a shorter stored key never matches
+		if (memcmp(slot, key, len) != 0 || (len < index->length && slot[len] != '\0')) continue;
+
+		if (column) *column = index->column;
+		return slot[index->length] | (slot[index->length + 1] << 8);
+	}
+	return -1;
+}
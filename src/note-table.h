@@ -0,0 +1,78 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Reader for the columnar tables built from CSV notes by
+ *          tools/build_notes.py (format described in tools/table.py)
+ *
+ *          Opening reads the header and the column descriptors only, so it
+ *          costs the same for 10 rows or 10000. A run of cells of one
+ *          column is one ranged read of its values, plus one read of the
+ *          strings for a text column.
+ *
+ *          Key columns have a minimal perfect hash from key to row. With
+ *          the bucket seeds loaded, finding a row by key is one ranged read
+ *          of its slot per key column, whatever the row count.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_TABLE__
+#define __NOTE_TABLE__
+
+#include "pebble.h"
+
+#define NOTE_TABLE_MAX_COLUMNS 8
+#define NOTE_TABLE_NAME_LEN 12
+#define NOTE_TABLE_CELL_LEN 24
+#define NOTE_TABLE_MAX_RUN 16
+#define NOTE_TABLE_MAX_KEYS 4
+#define NOTE_TABLE_KEY_LEN 12
+// Seeds kept in RAM by note_table_load_keys, for all the key columns
+#define NOTE_TABLE_MAX_SEEDS 512
+
+typedef enum {
+	NOTE_TABLE_NUMBER = 0,
+	NOTE_TABLE_TEXT = 1,
+} NoteTableType;
+
+typedef struct {
+	uint8_t type;          // NoteTableType
+	uint8_t bytes;         // Bytes per value: 1, 2 or 4
+	bool is_signed;
+	uint8_t scale;         // Decimal digits after the point
+	uint8_t width;         // Pixels the widest cell takes
+	uint32_t values;       // Offset of the values in the table
+	uint32_t pool;         // Offset of the strings, text columns
+	char name[NOTE_TABLE_NAME_LEN];
+} NoteTableColumn;
+
+typedef struct {
+	uint8_t column;        // Column the keys come from
+	uint8_t length;        // Bytes per key in the slots
+	uint16_t buckets;
+	uint32_t seeds;        // Offset of the bucket seeds in the table
+	uint32_t slots;        // Offset of the slots: key then u16 row
+	uint16_t *seed;        // Seeds in RAM, NULL to read them
+} NoteTableKey;
+
+typedef struct {
+	ResHandle handle;
+	uint32_t base;         // Offset of the table in the resource
+	uint16_t rows;
+	uint8_t columns;
+	uint8_t row_height;    // Pixels per row, for the font of the build
+	uint8_t keys;
+	NoteTableColumn column[NOTE_TABLE_MAX_COLUMNS];
+	NoteTableKey key[NOTE_TABLE_MAX_KEYS];
+} NoteTable;
+
+bool note_table_open(NoteTable *table, ResHandle handle, uint32_t base);
+uint16_t note_table_count_rows(ResHandle handle, uint32_t base);
+uint32_t note_table_read(NoteTable *table, uint8_t column, uint32_t first, uint32_t count,
+						 char cells[][NOTE_TABLE_CELL_LEN]);
+
+size_t note_table_keys_len(const NoteTable *table);
+void note_table_load_keys(NoteTable *table, uint16_t *seeds);
+void note_table_unload_keys(NoteTable *table);
+int32_t note_table_find(NoteTable *table, const char *key, uint8_t *column);
+
+#endif
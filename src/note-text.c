@@ -0,0 +1,38 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: One line views of note text
+ *******************************************************************************
+ */
+
+#include "note-text.h"
+
+  /**
+   *  Folds len bytes of text into out as one line: control characters,
+   *  line breaks included, become spaces, runs of spaces one, and a
+   *  multibyte character is never cut in half. Stops at a NUL. Returns the
+   *  length of out, always NUL terminated.
+   */
+size_t note_text_one_line(char *out, size_t out_len, const char *text, size_t len) {
+	size_t o = 0;
+	if (out_len == 0) return 0;
+	
+	for (size_t i = 0; i < len && o < out_len - 1; i++) {
+		char ch = text[i];
+		if (ch == '\0') break;
+		if ((uint8_t)ch < 0x20) ch = ' ';
+		if (ch == ' ' && (o == 0 || out[o - 1] == ' ')) continue;
+		out[o++] = ch;
+	}
+	
+	// Drop a trailing partial UTF-8 sequence
+	size_t lead = o;
+	while (lead > 0 && ((uint8_t)out[lead - 1] & 0xC0) == 0x80) lead--;
+	if (lead > 0 && ((uint8_t)out[lead - 1] & 0x80)) {
+		uint8_t first = (uint8_t)out[lead - 1];
+		size_t need = (first >= 0xF0) ? 4 : (first >= 0xE0) ? 3 : 2;
+		if (o - (lead - 1) < need) o = lead - 1;
+	}
+	out[o] = '\0';
+	return o;
+}
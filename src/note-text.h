@@ -0,0 +1,20 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: One line views of note text, for the menu previews and the
+ *          search snippets
+ *
+ *          Notes are normalized at build time (tools/normalize.py), so all
+ *          there is to clean is line breaks, other control characters and
+ *          a multibyte character cut by the end of the buffer.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_TEXT__
+#define __NOTE_TEXT__
+
+#include "pebble.h"
+
+size_t note_text_one_line(char *out, size_t out_len, const char *text, size_t len);
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Virtualized note layer
+ *******************************************************************************
+ */
+
+#include "note-view.h"
+#include "pebble-stats.h"
+
+// One line of text, NUL terminated for graphics_draw_text
+static char note_view_line[NOTE_VIEW_LINE_LEN];
+
+  /**
+   *  Lines touched by the frame at the current offset, margin included
+   */
+static void note_view_visible(NoteView *view, uint32_t *first, uint32_t *count) {
+	int16_t height = layer_get_bounds(view->layer).size.h;
+	uint32_t from = note_lines_at(view->lines, view->top);
+	uint32_t to = note_lines_at(view->lines, view->top + height - 1);
+	
+	from = (from > NOTE_VIEW_MARGIN_LINES) ? from - NOTE_VIEW_MARGIN_LINES : 0;
+	to += NOTE_VIEW_MARGIN_LINES;
+	
+	*first = from;
+	*count = to - from + 1;
+	if (*count > NOTE_VIEW_MAX_LINES - 2) *count = NOTE_VIEW_MAX_LINES - 2; // Room for the next line start
+}
+
+  /**
+   *  Draws the visible lines; everything else in the note is never touched
+   */
+static void note_view_draw(NoteView *view, Layer *layer, GContext *ctx) {
+	GRect bounds = layer_get_bounds(layer);
+	uint32_t offsets[NOTE_VIEW_MAX_LINES];
+	uint32_t first, count;
+	
+	note_view_visible(view, &first, &count);
+	
+	// One read for the starts of the lines plus the start of the next one
+	count = note_lines_read(view->lines, first, count + 1, offsets);
+	if (count == 0) return;
+	if (first + count >= view->lines->count) {
+		offsets[count] = view->stream->size;
+	}
+	else {
+		count--;
+	}
+	note_stream_cover(view->stream, offsets[0], offsets[count]);
+	
+	graphics_context_set_text_color(ctx, GColorBlack);
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t from = offsets[i];
+		uint32_t to = offsets[i + 1];
+		if (!note_stream_holds(view->stream, from, to)) continue;
+		
+		const char *text = note_stream_at(view->stream, from);
+		uint32_t len = to - from;
+		if (len > 0 && text[len - 1] == '\n') len--;
+		if (len > NOTE_VIEW_LINE_LEN - 1) len = NOTE_VIEW_LINE_LEN - 1;
+		memcpy(note_view_line, text, len);
+		note_view_line[len] = '\0';
+		
+		int32_t y = note_lines_y(view->lines, first + i) - view->top;
+		graphics_draw_text(ctx, 
+						   note_view_line, 
+						   view->font, 
+						   GRect(0, y, bounds.size.w, view->lines->line_height), 
+						   GTextOverflowModeWordWrap, 
+						   GTextAlignmentLeft, 
+						   NULL);
+	}
+}
+
+static void note_view_update_proc(Layer *layer, GContext *ctx) {
+	STATS_BEGIN(STATS_NOTE_VIEW_DRAW);
+	note_view_draw(*(NoteView**)layer_get_data(layer), layer, ctx);
+	STATS_END(STATS_NOTE_VIEW_DRAW);
+}
+
+  /**
+   *  Creates the layer of the view over an opened stream and line table
+   */
+void note_view_init(NoteView *view, GRect frame, NoteStream *stream, NoteLines *lines, GFont font) {
+	view->stream = stream;
+	view->lines = lines;
+	view->font = font;
+	view->top = 0;
+	view->layer = layer_create_with_data(frame, sizeof(NoteView*));
+	*(NoteView**)layer_get_data(view->layer) = view;
+	layer_set_update_proc(view->layer, note_view_update_proc);
+}
+
+  /**
+   *  Points the existing layer at a newly opened note, back at its top
+   */
+void note_view_bind(NoteView *view, NoteStream *stream, NoteLines *lines) {
+	view->stream = stream;
+	view->lines = lines;
+	view->top = 0;
+	layer_mark_dirty(view->layer);
+}
+
+void note_view_deinit(NoteView *view) {
+	layer_destroy(view->layer);
+	view->layer = NULL;
+}
+
+  /**
+   *  Zeroes the last line drawn, which may be decrypted text, when the
+   *  note is closed
+   */
+void note_view_wipe(NoteView *view) {
+	memset(note_view_line, 0, sizeof(note_view_line));
+}
+
+Layer *note_view_get_layer(NoteView *view) {
+	return view->layer;
+}
+
+  /**
+   *  Lowest the note can be scrolled: its last line at the bottom of the
+   *  frame, rounded up to a whole line so the top line is never cut
+   */
+int32_t note_view_max_offset(NoteView *view) {
+	int32_t line_height = view->lines->line_height;
+	int32_t max = note_lines_height(view->lines) - layer_get_bounds(view->layer).size.h;
+	return (max > 0) ? (max + line_height - 1) / line_height * line_height : 0;
+}
+
+  /**
+   *  Scrolls to top pixels into the note, clamped to the note bounds
+   */
+void note_view_set_offset(NoteView *view, int32_t top) {
+	int32_t max = note_view_max_offset(view);
+	if (top > max) top = max;
+	if (top < 0) top = 0;
+	if (top == view->top) return;
+	
+	view->top = top;
+	layer_mark_dirty(view->layer);
+}
+
+int32_t note_view_get_offset(const NoteView *view) {
+	return view->top;
+}
+
+  /**
+   *  Whole lines the frame shows
+   */
+uint32_t note_view_page_lines(NoteView *view) {
+	uint32_t lines = layer_get_bounds(view->layer).size.h / view->lines->line_height;
+	return (lines > 0) ? lines : 1;
+}
+
+uint32_t note_view_pages(NoteView *view) {
+	uint32_t per_page = note_view_page_lines(view);
+	return (view->lines->count + per_page - 1) / per_page;
+}
+
+  /**
+   *  Page holding the first whole line on screen
+   */
+uint32_t note_view_page(NoteView *view) {
+	uint32_t line = (view->top + view->lines->line_height - 1) / view->lines->line_height;
+	return line / note_view_page_lines(view);
+}
+
+  /**
+   *  Offset that shows page at the top
+   */
+int32_t note_view_page_top(NoteView *view, uint32_t page) {
+	return note_lines_y(view->lines, page * note_view_page_lines(view));
+}
+
+  /**
+   *  Offset one screen of whole lines up (direction < 0) or down from the
+   *  first whole line on screen, so no line is cut or shown twice
+   */
+int32_t note_view_flip(NoteView *view, int8_t direction) {
+	int32_t line = (view->top + view->lines->line_height - 1) / view->lines->line_height;
+	int32_t per_page = note_view_page_lines(view);
+	line += (direction < 0) ? -per_page : per_page;
+	return note_lines_y(view->lines, (line > 0) ? line : 0);
+}
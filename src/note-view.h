@@ -0,0 +1,50 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Virtualized note layer. Draws only the lines inside its frame
+ *          (plus NOTE_VIEW_MARGIN_LINES above and below), taking their
+ *          positions from the line table and their bytes from the stream.
+ *          Redraw cost depends on the screen size, not on the note length.
+ *
+ *          Pages are screens of whole lines. Lines all have the height of
+ *          the line table, so page n starts at line n * note_view_page_lines
+ *          and finding any page is arithmetic, with no table to build.
+ *******************************************************************************
+ */
+
+#ifndef __NOTE_VIEW__
+#define __NOTE_VIEW__
+
+#include "pebble.h"
+#include "note-stream.h"
+#include "note-lines.h"
+
+#define NOTE_VIEW_MARGIN_LINES 1
+#define NOTE_VIEW_MAX_LINES 32
+#define NOTE_VIEW_LINE_LEN 128
+
+typedef struct {
+	Layer *layer;
+	NoteStream *stream;
+	NoteLines *lines;
+	GFont font;
+	int32_t top;          // Pixels scrolled into the note
+} NoteView;
+
+void note_view_init(NoteView *view, GRect frame, NoteStream *stream, NoteLines *lines, GFont font);
+void note_view_bind(NoteView *view, NoteStream *stream, NoteLines *lines);
+void note_view_deinit(NoteView *view);
+void note_view_wipe(NoteView *view);
+Layer *note_view_get_layer(NoteView *view);
+
+void note_view_set_offset(NoteView *view, int32_t top);
+int32_t note_view_get_offset(const NoteView *view);
+int32_t note_view_max_offset(NoteView *view);
+
+uint32_t note_view_page_lines(NoteView *view);
+uint32_t note_view_pages(NoteView *view);
+uint32_t note_view_page(NoteView *view);
+int32_t note_view_page_top(NoteView *view, uint32_t page);
+int32_t note_view_flip(NoteView *view, int8_t direction);
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Immediate and deferred logging, formatted with mini-printf
+ *******************************************************************************
+ */
+
+#include "pebble-log.h"
+#include "mini-printf.h"
+
+typedef struct {
+	const char *fmt;      // String literal, doubles as the message id
+	const char *file;
+	int16_t line;
+	uint8_t level;
+	int32_t args[LOG_DEFER_ARGS];
+} LogEntry;
+
+static uint8_t log_level = APP_LOG_LEVEL_DEBUG_VERBOSE;
+static LogEntry log_ring[LOG_RING_LEN];
+static uint32_t log_head;      // Entries ever written
+static uint32_t log_tail;      // Entries ever drained or dropped
+static uint32_t log_dropped;
+
+void setLogLevel(uint8_t level) {
+	log_level = level;
+}
+
+  /**
+   *  Formats now and hands the line to the system log
+   */
+void logThis(uint8_t level, const char *file, int line, const char* fmt, ...) {
+	if (level > log_level) return;
+
+	char text[LOG_LINE_LEN];
+	va_list va;
+	va_start(va, fmt);
+	mini_vsnprintf(text, sizeof(text), fmt, va);
+	va_end(va);
+	app_log(level, file, line, "%s", text);
+}
+
+  /**
+   *  Stores the message for logDrain(): no formatting, no system call
+   */
+void logDefer(uint8_t level, const char *file, int line, const char *fmt,
+			  int32_t a, int32_t b, int32_t c, int32_t d) {
+	if (level > log_level) return;
+
+	if (log_head - log_tail == LOG_RING_LEN) {
+		log_tail++;
+		log_dropped++;
+	}
+	LogEntry *entry = &log_ring[log_head % LOG_RING_LEN];
+	entry->fmt = fmt;
+	entry->file = file;
+	entry->line = line;
+	entry->level = level;
+	entry->args[0] = a;
+	entry->args[1] = b;
+	entry->args[2] = c;
+	entry->args[3] = d;
+	log_head++;
+}
+
+  /**
+   *  Formats and logs every deferred message, oldest first. Returns how
+   *  many were logged.
+   */
+uint32_t logDrain(void) {
+	char text[LOG_LINE_LEN];
+	uint32_t drained = 0;
+
+	for (; log_tail != log_head; log_tail++, drained++) {
+		LogEntry *entry = &log_ring[log_tail % LOG_RING_LEN];
+		// Conversions past the ones in fmt are never read
+		mini_snprintf(text, sizeof(text), entry->fmt,
+					  (int)entry->args[0], (int)entry->args[1], (int)entry->args[2], (int)entry->args[3]);
+		app_log(entry->level, entry->file, entry->line, "%s", text);
+	}
+	if (log_dropped > 0) {
+		app_log(APP_LOG_LEVEL_WARNING, __FILE__, __LINE__, "###logDrain: %d messages dropped###", (int)log_dropped);
+		log_dropped = 0;
+	}
+	return drained;
+}
+
+uint32_t logDropped(void) {
+	return log_dropped;
+}
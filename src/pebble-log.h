@@ -1,5 +1,58 @@
-
-#include "pebble.h"
-
-void setLogLevel(uint8_t log_level);
-void logThis(uint8_t log_level, const char* fmt, ...);
\ No newline at end of file
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Logging with two filters and two modes
+ *
+ *          LOG_LEVEL is the compile time filter: LOG_* calls above it are
+ *          dead code and compile to nothing, arguments included. Build with
+ *          -DLOG_LEVEL=APP_LOG_LEVEL_DEBUG (or edit the default below) to
+ *          get the debug messages back. setLogLevel() filters further at
+ *          run time.
+ *
+ *          LOG_* format right away. LOG_DEFER_* only copy the format
+ *          pointer and up to LOG_DEFER_ARGS integers into a ring, which
+ *          logDrain() formats later, so they fit timer and draw callbacks.
+ *          Deferred formats must be string literals and take integer
+ *          conversions only (%d %i %u %x %X %c): pointers may be gone by
+ *          the time the ring is drained. When the ring is full the oldest
+ *          entry is overwritten and counted as dropped.
+ *******************************************************************************
+ */
+
+#ifndef __PEBBLE_LOG__
+#define __PEBBLE_LOG__
+
+#include "pebble.h"
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL APP_LOG_LEVEL_INFO
+#endif
+
+#define LOG_RING_LEN 32
+#define LOG_DEFER_ARGS 4
+#define LOG_LINE_LEN 128
+
+void setLogLevel(uint8_t log_level);
+void logThis(uint8_t log_level, const char *file, int line, const char* fmt, ...);
+void logDefer(uint8_t log_level, const char *file, int line, const char *fmt,
+			  int32_t a, int32_t b, int32_t c, int32_t d);
+uint32_t logDrain(void);
+uint32_t logDropped(void);
+
+#define LOG(level, fmt, args...) \
+	do { if ((level) <= LOG_LEVEL) logThis(level, __FILE__, __LINE__, fmt, ## args); } while (0)
+
+// Pads the arguments with zeros and keeps the first LOG_DEFER_ARGS
+#define LOG_DEFER_PICK(level, fmt, a, b, c, d, ...) \
+	do { if ((level) <= LOG_LEVEL) logDefer(level, __FILE__, __LINE__, fmt, a, b, c, d); } while (0)
+#define LOG_DEFER(level, ...) LOG_DEFER_PICK(level, __VA_ARGS__, 0, 0, 0, 0, 0)
+
+#define LOG_ERROR(args...) LOG(APP_LOG_LEVEL_ERROR, args)
+#define LOG_WARNING(args...) LOG(APP_LOG_LEVEL_WARNING, args)
+#define LOG_INFO(args...) LOG(APP_LOG_LEVEL_INFO, args)
+#define LOG_DEBUG(args...) LOG(APP_LOG_LEVEL_DEBUG, args)
+
+#define LOG_DEFER_INFO(args...) LOG_DEFER(APP_LOG_LEVEL_INFO, args)
+#define LOG_DEFER_DEBUG(args...) LOG_DEFER(APP_LOG_LEVEL_DEBUG, args)
+
+#endif
@@ -0,0 +1,336 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Hot path timings, their log dump and the hidden stats window
+ *******************************************************************************
+ */
+
+#include "pebble-stats.h"
+
+#if STATS_ENABLED
+
+#include "pebble-log.h"
+#include "mini-printf.h"
+#include <string.h>
+
+// The wrapper below calls the real one
+#undef resource_load_byte_range
+
+#define STATS_LINE_LEN 32
+
+static const char *stats_names[STATS_SITES] = {
+	"note load",
+	"menu row",
+	"note draw",
+	"scroll step",
+	"search",
+	"resource",
+};
+
+static const char *stats_screen_names[STATS_SCREENS] = {
+	"main",
+	"note",
+	"pin",
+	"table",
+	"search",
+	"results",
+	"clock",
+	"stats",
+};
+
+static StatsEntry stats[STATS_SITES];
+static StatsHeap stats_heaps[STATS_SCREENS];
+// Heap in use when each screen began its last load
+static uint32_t stats_heap_base[STATS_SCREENS];
+// Loaded screens, the last one on top
+static StatsScreen stats_heap_stack[STATS_SCREENS];
+static int stats_heap_depth = 0;
+
+static Window *stats_window;
+static MenuLayer *stats_layer;
+
+uint32_t stats_now(void) {
+	time_t seconds;
+	uint16_t ms;
+	time_ms(&seconds, &ms);
+	return (uint32_t)seconds * 1000 + ms;
+}
+
+  /**
+   *  Heap in use and free now, counted to the screen on top
+   */
+static void stats_heap_sample(void) {
+	if (stats_heap_depth == 0) return;
+	StatsHeap *heap = &stats_heaps[stats_heap_stack[stats_heap_depth - 1]];
+	uint32_t used = heap_bytes_used();
+	uint32_t free_bytes = heap_bytes_free();
+
+	if (used > heap->peak_used) heap->peak_used = used;
+	if (heap->samples == 0 || free_bytes < heap->min_free) heap->min_free = free_bytes;
+	heap->samples++;
+}
+
+  /**
+   *  Takes screen off the loaded ones: windows may leave out of order, a
+   *  removed one is not always on top
+   */
+static void stats_heap_leave(StatsScreen screen) {
+	int i = stats_heap_depth;
+	while (i > 0 && stats_heap_stack[i - 1] != screen) i--;
+	if (i > 0) {
+		memmove(&stats_heap_stack[i - 1], &stats_heap_stack[i], (stats_heap_depth - i) * sizeof(StatsScreen));
+		stats_heap_depth--;
+	}
+}
+
+  /**
+   *  A screen window reached point of its load or unload
+   */
+void stats_heap(StatsScreen screen, StatsHeapPoint point) {
+	StatsHeap *heap = &stats_heaps[screen];
+	uint32_t used = heap_bytes_used();
+	uint32_t grown = (used > stats_heap_base[screen]) ? used - stats_heap_base[screen] : 0;
+
+	switch (point) {
+		case STATS_LOAD_BEGIN:
+			heap->loads++;
+			stats_heap_base[screen] = used;
+			stats_heap_leave(screen);
+			stats_heap_stack[stats_heap_depth++] = screen;
+			break;
+		case STATS_LOAD_END:
+			if (grown > heap->load_bytes) heap->load_bytes = grown;
+			break;
+		case STATS_UNLOAD_BEGIN:
+			break;
+		case STATS_UNLOAD_END:
+			if (grown > heap->kept_bytes) heap->kept_bytes = grown;
+			break;
+	}
+	stats_heap_sample();
+	if (point == STATS_UNLOAD_END) stats_heap_leave(screen);
+}
+
+const StatsHeap *stats_heap_get(StatsScreen screen) {
+	return &stats_heaps[screen];
+}
+
+const char *stats_screen_name(StatsScreen screen) {
+	return stats_screen_names[screen];
+}
+
+  /**
+   *  Adds one run of site that started at start
+   */
+void stats_record(StatsSite site, uint32_t start) {
+	StatsEntry *entry = &stats[site];
+	stats_heap_sample();
+	uint32_t ms = stats_now() - start;
+
+	if (entry->count == 0 || ms < entry->min_ms) entry->min_ms = ms;
+	if (ms > entry->max_ms) entry->max_ms = ms;
+	entry->count++;
+	entry->total_ms += ms;
+
+	uint32_t bucket = 0;
+	for (uint32_t limit = 1; bucket < STATS_BUCKETS - 1 && ms >= limit; limit <<= 1) bucket++;
+	if (entry->buckets[bucket] < UINT16_MAX) entry->buckets[bucket]++;
+}
+
+void stats_bytes(StatsSite site, uint32_t bytes) {
+	stats[site].bytes += bytes;
+}
+
+const StatsEntry *stats_get(StatsSite site) {
+	return &stats[site];
+}
+
+const char *stats_name(StatsSite site) {
+	return stats_names[site];
+}
+
+  /**
+   *  Forgets the timings and the heap figures, not which screens are loaded
+   */
+void stats_reset(void) {
+	memset(stats, 0, sizeof(stats));
+	memset(stats_heaps, 0, sizeof(stats_heaps));
+}
+
+size_t stats_resource_load_byte_range(ResHandle h, uint32_t start_offset, uint8_t *buffer, size_t num_bytes) {
+	STATS_BEGIN(STATS_RESOURCE_LOAD);
+	size_t read = resource_load_byte_range(h, start_offset, buffer, num_bytes);
+	STATS_END(STATS_RESOURCE_LOAD);
+	STATS_BYTES(STATS_RESOURCE_LOAD, read);
+	return read;
+}
+
+  /**
+   *  Mean in microseconds, from the millisecond total
+   */
+static uint32_t stats_mean_us(const StatsEntry *entry) {
+	return entry->count ? (uint32_t)((uint64_t)entry->total_ms * 1000 / entry->count) : 0;
+}
+
+  /**
+   *  Logs every site that ran: counts, times and the histogram
+   */
+void stats_dump(void) {
+	for (int site = 0; site < STATS_SITES; site++) {
+		const StatsEntry *entry = &stats[site];
+		if (entry->count == 0) continue;
+		LOG_INFO("###stats_dump: %s n %d mean %dus min %d max %dms %dB###",
+				 stats_names[site], (int)entry->count, (int)stats_mean_us(entry),
+				 (int)entry->min_ms, (int)entry->max_ms, (int)entry->bytes);
+		LOG_INFO("###stats_dump: %s ms 0:%d 1:%d 2:%d 4:%d 8:%d 16:%d 32:%d 64+:%d###",
+				 stats_names[site], entry->buckets[0], entry->buckets[1], entry->buckets[2], entry->buckets[3],
+				 entry->buckets[4], entry->buckets[5], entry->buckets[6], entry->buckets[7]);
+	}
+	for (int screen = 0; screen < STATS_SCREENS; screen++) {
+		const StatsHeap *heap = &stats_heaps[screen];
+		if (heap->samples == 0) continue;
+		LOG_INFO("###stats_dump: heap %s loads %d load %dB peak %dB free %dB kept %dB###",
+				 stats_screen_names[screen], (int)heap->loads, (int)heap->load_bytes,
+				 (int)heap->peak_used, (int)heap->min_free, (int)heap->kept_bytes);
+	}
+}
+
+///////////////////////////STATS WINDOW///////////////////////////
+
+static uint16_t stats_get_num_sections_callback(MenuLayer *me, void *data) {
+	return 2;
+}
+
+static uint16_t stats_get_num_rows_callback(MenuLayer *me, uint16_t section_index, void *data) {
+	return (section_index == 0) ? STATS_SITES : STATS_SCREENS;
+}
+
+static int16_t stats_get_header_height_callback(MenuLayer *me, uint16_t section_index, void *data) {
+	return MENU_CELL_BASIC_HEADER_HEIGHT;
+}
+
+static void stats_draw_header_callback(GContext* ctx, const Layer *cell_layer, uint16_t section_index, void *data) {
+	menu_cell_basic_header_draw(ctx,
+								cell_layer,
+								(section_index == 0) ? "Stats, Select resets" : "Heap by screen");
+}
+
+  /**
+   *  One screen per row: loads and the heap a load took, then the peak in
+   *  use, the least free and what unloading left behind
+   */
+static void stats_draw_heap_row(GContext* ctx, const Layer *cell_layer, StatsScreen screen) {
+	char title[STATS_LINE_LEN];
+	char subtitle[STATS_LINE_LEN];
+	const StatsHeap *heap = &stats_heaps[screen];
+
+	mini_snprintf(title,
+				  STATS_LINE_LEN,
+				  "%s %d +%dB",
+				  stats_screen_names[screen],
+				  (int)heap->loads,
+				  (int)heap->load_bytes);
+	mini_snprintf(subtitle,
+				  STATS_LINE_LEN,
+				  "pk %dB fr %dB kp %dB",
+				  (int)heap->peak_used,
+				  (int)heap->min_free,
+				  (int)heap->kept_bytes);
+	menu_cell_basic_draw(ctx,
+						 cell_layer,
+						 title,
+						 subtitle,
+						 NULL);
+}
+
+  /**
+   *  One site per row: runs and bytes, then mean and max time
+   */
+static void stats_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuIndex *cell_index, void *data) {
+	char title[STATS_LINE_LEN];
+	char subtitle[STATS_LINE_LEN];
+
+	if (cell_index->section == 1) {
+		stats_draw_heap_row(ctx,
+							cell_layer,
+							cell_index->row);
+		return;
+	}
+	// Heap rows go past the sites, so only a site row indexes them
+	const StatsEntry *entry = &stats[cell_index->row];
+	mini_snprintf(title,
+				  STATS_LINE_LEN,
+				  "%s %d",
+				  stats_names[cell_index->row],
+				  (int)entry->count);
+	if (entry->bytes > 0) {
+		mini_snprintf(subtitle,
+					  STATS_LINE_LEN,
+					  "%dus max %dms %dKB",
+					  (int)stats_mean_us(entry),
+					  (int)entry->max_ms,
+					  (int)(entry->bytes >> 10));
+	}
+	else {
+		mini_snprintf(subtitle,
+					  STATS_LINE_LEN,
+					  "%dus max %dms",
+					  (int)stats_mean_us(entry),
+					  (int)entry->max_ms);
+	}
+	menu_cell_basic_draw(ctx,
+						 cell_layer,
+						 title,
+						 subtitle,
+						 NULL);
+}
+
+static void stats_select_callback(MenuLayer *me, MenuIndex *cell_index, void *data) {
+	stats_dump();
+	stats_reset();
+	menu_layer_reload_data(stats_layer);
+}
+
+static void stats_window_load(Window *me) {
+	STATS_HEAP(STATS_SCREEN_STATS, STATS_LOAD_BEGIN);
+	Layer *stats_window_layer = window_get_root_layer(me);
+
+	stats_layer = menu_layer_create(layer_get_bounds(stats_window_layer));
+	menu_layer_set_callbacks(stats_layer,
+							 NULL,
+							 (MenuLayerCallbacks){
+								.get_num_sections = stats_get_num_sections_callback,
+								.get_num_rows = stats_get_num_rows_callback,
+								.get_header_height = stats_get_header_height_callback,
+								.draw_header = stats_draw_header_callback,
+								.draw_row = stats_draw_row_callback,
+								.select_click = stats_select_callback,
+	                         }
+							);
+	menu_layer_set_click_config_onto_window(stats_layer,
+											me);
+	layer_add_child(stats_window_layer,
+					menu_layer_get_layer(stats_layer));
+	STATS_HEAP(STATS_SCREEN_STATS, STATS_LOAD_END);
+}
+
+static void stats_window_unload(Window *me) {
+	STATS_HEAP(STATS_SCREEN_STATS, STATS_UNLOAD_BEGIN);
+	menu_layer_destroy(stats_layer);
+	STATS_HEAP(STATS_SCREEN_STATS, STATS_UNLOAD_END);
+	window_destroy(stats_window);
+}
+
+void stats_window_show(void) {
+	stats_window = window_create();
+	window_set_window_handlers(stats_window,
+							   (WindowHandlers){
+									.load = stats_window_load,
+								    .unload = stats_window_unload,
+                               }
+							  );
+	window_stack_push(stats_window,
+					  true);
+}
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ *******************************************************************************
+ * Program: notepad
+ * Descrip: Timings and byte counters for the hot paths
+ *
+ *          Each site keeps how many times it ran, min/max/total time and a
+ *          histogram of power of two millisecond buckets, plus the bytes it
+ *          read. Time comes from time_ms(), so one run of a fast site reads
+ *          as 0 or 1 ms, but the mean over many runs is still right.
+ *
+ *          Each screen keeps what its window load took from the heap, the
+ *          most heap in use and the least left free while it was on top,
+ *          and what its unload left behind. STATS_HEAP marks the start and
+ *          the end of the load and unload handlers, the unload end before
+ *          the window itself is destroyed; the heap is also sampled at every
+ *          timed site.
+ *
+ *          With STATS_ENABLED 0 (the default) every STATS_* macro is empty
+ *          and resource reads are not wrapped, so field builds carry no
+ *          cost. Build with -DSTATS_ENABLED=1 to collect: a long push on
+ *          Select in the notes menu opens the stats window, and
+ *          stats_dump() logs every site.
+ *******************************************************************************
+ */
+
+#ifndef __PEBBLE_STATS__
+#define __PEBBLE_STATS__
+
+#include "pebble.h"
+
+#ifndef STATS_ENABLED
+#define STATS_ENABLED 0
+#endif
+
+#define STATS_BUCKETS 8
+
+typedef enum {
+	STATS_NOTE_WINDOW_LOAD,
+	STATS_MENU_DRAW_ROW,
+	STATS_NOTE_VIEW_DRAW,
+	STATS_SCROLL_STEP,
+	STATS_SEARCH,
+	STATS_RESOURCE_LOAD,
+	STATS_SITES
+} StatsSite;
+
+typedef enum {
+	STATS_SCREEN_MAIN,
+	STATS_SCREEN_NOTE,
+	STATS_SCREEN_PIN,
+	STATS_SCREEN_TABLE,
+	STATS_SCREEN_SEARCH,
+	STATS_SCREEN_RESULTS,
+	STATS_SCREEN_CLOCK,
+	STATS_SCREEN_STATS,
+	STATS_SCREENS
+} StatsScreen;
+
+typedef enum {
+	STATS_LOAD_BEGIN,
+	STATS_LOAD_END,
+	STATS_UNLOAD_BEGIN,
+	STATS_UNLOAD_END
+} StatsHeapPoint;
+
+typedef struct {
+	uint32_t count;
+	uint32_t total_ms;
+	uint32_t min_ms;
+	uint32_t max_ms;
+	uint32_t bytes;
+	uint16_t buckets[STATS_BUCKETS];  // 0, 1, 2-3, 4-7 ... 64+ ms
+} StatsEntry;
+
+typedef struct {
+	uint32_t loads;
+	uint32_t samples;
+	uint32_t load_bytes;         // Most heap one load took
+	uint32_t peak_used;          // Most heap in use while on top
+	uint32_t min_free;           // Least heap free while on top
+	uint32_t kept_bytes;         // Most heap one load and unload left behind
+} StatsHeap;
+
+#if STATS_ENABLED
+
+uint32_t stats_now(void);
+void stats_record(StatsSite site, uint32_t start);
+void stats_bytes(StatsSite site, uint32_t bytes);
+const StatsEntry *stats_get(StatsSite site);
+const char *stats_name(StatsSite site);
+void stats_heap(StatsScreen screen, StatsHeapPoint point);
+const StatsHeap *stats_heap_get(StatsScreen screen);
+const char *stats_screen_name(StatsScreen screen);
+void stats_reset(void);
+void stats_dump(void);
+void stats_window_show(void);
+
+size_t stats_resource_load_byte_range(ResHandle h, uint32_t start_offset, uint8_t *buffer, size_t num_bytes);
+#define resource_load_byte_range stats_resource_load_byte_range
+
+#define STATS_BEGIN(site) uint32_t stats_start_##site = stats_now()
+#define STATS_END(site) stats_record(site, stats_start_##site)
+#define STATS_BYTES(site, bytes) stats_bytes(site, bytes)
+#define STATS_HEAP(screen, point) stats_heap(screen, point)
+#define STATS_DUMP() stats_dump()
+
+#else
+
+#define STATS_BEGIN(site)
+#define STATS_END(site)
+#define STATS_BYTES(site, bytes)
+#define STATS_HEAP(screen, point)
+#define STATS_DUMP()
+
+#endif
+
+#endif
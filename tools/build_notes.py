@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""
+Builds the note pack resource packaged by appinfo.json from plain text notes.
+
+    tools/build_notes.py [--out DIR] [--font FONT] NOTE_OR_DIR...
+
+Every directory stands for the *.txt and *.csv files in it, in name order,
+which is the order of the notes in the menu. Every note is normalized first
+(see normalize.py), so the watch only ever sees clean UTF-8. Writes
+DIR/notes.pack (see
+pack.py): the text notes compressed with their shared dictionary, their line
+tables for FONT and the search index over all of them, and the CSV notes as
+columnar tables (see table.py). Then prints the report.
+
+A note NAME.txt may come with a NAME.def file of "key = value" lines:
+    title = Bank         menu title, instead of the first line of the note
+    pin = UUDS           locks the note behind this PIN (see cipher.py)
+A locked note is titled by its file name unless the .def gives a title.
+All the notes share one font, FONT.
+"""
+
+import argparse
+import os
+import sys
+import time
+
+import cipher
+import index
+import layout
+import lz
+import normalize
+import pack
+import table
+
+BLOCK_SIZE = 512     # Must match NOTE_CHUNK_LEN in src/note-stream.h
+DICT_SIZE = 1024     # Must fit NOTE_LZ_DICT_LEN in src/note-lz.h
+
+
+def note_paths(args):
+    paths = []
+    for arg in args:
+        if os.path.isdir(arg):
+            paths.extend(os.path.join(arg, name) for name in sorted(os.listdir(arg)) if name.endswith((".txt", ".csv")))
+        else:
+            paths.append(arg)
+    return paths
+
+
+def note_def(path):
+    """{key: value} of the .def file of the note at path, empty without one."""
+    fields = {}
+    try:
+        with open(os.path.splitext(path)[0] + ".def", encoding="utf-8") as f:
+            for number, line in enumerate(f, 1):
+                line = line.strip()
+                if not line or line.startswith("#"):
+                    continue
+                key, sep, value = line.partition("=")
+                key = key.strip()
+                if not sep or key not in ("title", "pin"):
+                    raise ValueError("line %d: expected title = ... or pin = ..." % number)
+                fields[key] = value.strip()
+    except FileNotFoundError:
+        pass
+    if "pin" in fields:
+        cipher.check_pin(fields["pin"])
+    return fields
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--out", default="resources/generated")
+    parser.add_argument("--font", default="GOTHIC_14", choices=sorted(layout.FONTS),
+                        help="must match FONT_TYPE in src/main.c")
+    parser.add_argument("notes", nargs="+")
+    args = parser.parse_args(argv)
+
+    paths = note_paths(args.notes)
+    if not paths:
+        sys.exit("build_notes: no notes found")
+    texts = []
+    fixes = []
+    defs = []
+    raw_size = 0
+    start = time.perf_counter()
+    for path in paths:
+        with open(path, "rb") as f:
+            raw = f.read()
+        text, report = normalize.normalize(raw)
+        try:
+            defs.append(note_def(path))
+        except ValueError as e:
+            sys.exit("build_notes: %s.def: %s" % (os.path.splitext(path)[0], e))
+        texts.append(text)
+        fixes.append(normalize.describe(report))
+        raw_size += len(raw)
+    normalize_ms = (time.perf_counter() - start) * 1e3
+
+    # Tables keep their row in the pack but take no part in the text steps,
+    # and locked notes share no phrase and no word with the others
+    is_table = [path.endswith(".csv") for path in paths]
+    hidden = [csv or "pin" in fields for csv, fields in zip(is_table, defs)]
+    prose = [b"" if hide else text for hide, text in zip(hidden, texts)]
+    # Postings address the first MAX_OFFSET bytes of a note: a longer note
+    # is still packed, only left out of search
+    for i, path in enumerate(paths):
+        if len(prose[i]) > index.MAX_OFFSET:
+            print("build_notes: %s is over %d bytes, left out of search" % (path, index.MAX_OFFSET), file=sys.stderr)
+            prose[i] = b""
+    dictionary = lz.build_dictionary([text for hide, text in zip(hidden, texts) if not hide], DICT_SIZE)
+    search = index.build_index(prose)
+    if not index.check(search, prose):
+        sys.exit("build_notes: search index does not match the notes")
+
+    notes = []
+    total_plain = total_packed = 0
+    print("%-28s %8s %8s %7s %7s  %s" % ("note", "plain", "packed", "ratio", "lines", "title"))
+    for path, text, csv, fix, fields in zip(paths, texts, is_table, fixes, defs):
+        name = os.path.splitext(os.path.basename(path))[0]
+        given = fields["title"].encode("utf-8") if "title" in fields else b""
+        if csv:
+            if "pin" in fields:
+                sys.exit("build_notes: %s: tables cannot be locked" % path)
+            try:
+                columns, warnings = table.build_table(text, args.font)
+            except ValueError as e:
+                sys.exit("build_notes: %s: %s" % (path, e))
+            if not table.check(columns, text):
+                sys.exit("build_notes: %s does not read back as a table" % path)
+            title = pack.title_of(given, name)
+            notes.append((title, len(text), columns, b"", pack.TABLE, pack.content_hash(text), 0))
+            total_plain += len(text)
+            total_packed += len(columns)
+            rows = table.HEADER.unpack_from(columns)[3]
+            print("%-28s %8d %8d %6.1f%% %7s  %s" % (path, len(text), len(columns), 100.0 * len(columns) / max(1, len(text)),
+                                                    "%d rows" % rows, title.decode("utf-8")))
+            for warning in [fix] * bool(fix) + warnings:
+                print("%-28s %s" % ("", warning))
+            continue
+        packed = lz.compress_note(text, dictionary, BLOCK_SIZE)
+        if lz.decompress_note(packed, dictionary) != text:
+            sys.exit("build_notes: %s does not round trip" % path)
+        lines = layout.line_table(text, args.font)
+        content = pack.content_hash(text)
+        flags = check = 0
+        if "pin" in fields:
+            key, check = cipher.derive(fields["pin"], content)
+            packed = cipher.lock_note(packed, key, content)
+            if lz.decompress_note(cipher.unlock_note(packed, key, content), dictionary) != text:
+                sys.exit("build_notes: %s does not unlock" % path)
+            flags = pack.LOCKED
+            title = pack.title_of(given, name)
+            fix = "; ".join(filter(None, [fix, "locked, PIN of %d pushes" % len(fields["pin"])]))
+        else:
+            title = pack.title_of(given or text, name)
+        notes.append((title, len(text), packed, lines, flags, content, check))
+        total_plain += len(text)
+        total_packed += len(packed)
+        print("%-28s %8d %8d %6.1f%% %7d  %s" % (path, len(text), len(packed), 100.0 * len(packed) / max(1, len(text)),
+                                                (len(lines) - layout.HEADER.size) // 4, title.decode("utf-8")))
+        if fix:
+            print("%-28s %s" % ("", fix))
+
+    packed_notes = pack.build_pack(notes, dictionary, search)
+    if list(pack.entries(packed_notes)) != notes:
+        sys.exit("build_notes: note pack does not read back")
+    os.makedirs(args.out, exist_ok=True)
+    with open(os.path.join(args.out, "notes.pack"), "wb") as f:
+        f.write(packed_notes)
+
+    total_packed += len(dictionary)
+    print("%-28s %8d %8s  (%.1f ms)" % ("normalized", raw_size, "", normalize_ms))
+    print("%-28s %8s %8d" % ("shared dictionary", "", len(dictionary)))
+    print("%-28s %8d %8d %6.1f%%" % ("total", total_plain, total_packed, 100.0 * total_packed / max(1, total_plain)))
+    print("%-28s %8s %8d  (%d notes, %d byte index)" % ("notes.pack", "", len(packed_notes), len(notes), len(search)))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,107 @@
+"""
+Locked notes: a note with a PIN (see build_notes.py) is encrypted after it is
+compressed, and decrypted block by block on the watch by src/note-cipher.c
+as the blocks are read.
+
+PIN: 4 to 16 button pushes, U (up), D (down) or S (select), like "UUDS".
+
+Key: ChaCha20 (RFC 8439) block 0 with
+    key         the PIN letters, NUL padded to 32 bytes
+    nonce       u32 content hash, u32 PIN length, "PIN!"
+The first 32 bytes are the note key, the low 24 bits of the next u32 are the
+check kept in the table of contents (see pack.py), so the watch tells a
+wrong PIN before decrypting anything.
+
+Cipher: ChaCha20 with the note key and nonce (content hash, 0, 0), the
+counter being the byte offset in the note container / 64. Only the blocks
+are encrypted, the container header and block offsets stay plain, and the
+LOCKED flag of the container is set (see lz.py).
+
+A PIN is only a few pushes: this keeps a note from a glance at the watch,
+not from someone who has the app file.
+"""
+
+import struct
+
+import lz
+
+PIN_LETTERS = "UDS"
+PIN_MIN_LEN = 4      # Must match NOTE_PIN_MIN_LEN in src/note-cipher.h
+PIN_MAX_LEN = 16     # Must match NOTE_PIN_MAX_LEN in src/note-cipher.h
+CHECK_MASK = 0xFFFFFF
+PIN_NONCE = 0x214E4950
+BLOCK = 64
+
+CONSTANTS = (0x61707865, 0x3320646E, 0x79622D32, 0x6B206574)
+
+
+def _rotl(v, n):
+    return ((v << n) | (v >> (32 - n))) & 0xFFFFFFFF
+
+
+def _quarter(s, a, b, c, d):
+    s[a] = (s[a] + s[b]) & 0xFFFFFFFF; s[d] = _rotl(s[d] ^ s[a], 16)
+    s[c] = (s[c] + s[d]) & 0xFFFFFFFF; s[b] = _rotl(s[b] ^ s[c], 12)
+    s[a] = (s[a] + s[b]) & 0xFFFFFFFF; s[d] = _rotl(s[d] ^ s[a], 8)
+    s[c] = (s[c] + s[d]) & 0xFFFFFFFF; s[b] = _rotl(s[b] ^ s[c], 7)
+
+
+def block(key, counter, nonce):
+    """One ChaCha20 block as 16 words, key 8 words, nonce 3 words."""
+    state = list(CONSTANTS) + list(key) + [counter & 0xFFFFFFFF] + list(nonce)
+    s = state[:]
+    for _ in range(10):
+        _quarter(s, 0, 4, 8, 12)
+        _quarter(s, 1, 5, 9, 13)
+        _quarter(s, 2, 6, 10, 14)
+        _quarter(s, 3, 7, 11, 15)
+        _quarter(s, 0, 5, 10, 15)
+        _quarter(s, 1, 6, 11, 12)
+        _quarter(s, 2, 7, 8, 13)
+        _quarter(s, 3, 4, 9, 14)
+    return [(x + y) & 0xFFFFFFFF for x, y in zip(s, state)]
+
+
+def check_pin(pin):
+    """Raises ValueError unless pin is a PIN the watch can enter."""
+    if not PIN_MIN_LEN <= len(pin) <= PIN_MAX_LEN or any(c not in PIN_LETTERS for c in pin):
+        raise ValueError("a PIN is %d to %d pushes of %s, not %r" % (PIN_MIN_LEN, PIN_MAX_LEN, ", ".join(PIN_LETTERS), pin))
+
+
+def derive(pin, content_hash):
+    """(note key, check) of the note with content_hash, mirrors
+    note_key_derive in src/note-cipher.c."""
+    words = struct.unpack("<8I", pin.encode("ascii").ljust(32, b"\0"))
+    out = block(words, 0, (content_hash, len(pin), PIN_NONCE))
+    return out[:8], out[8] & CHECK_MASK
+
+
+def apply(key, content_hash, offset, data):
+    """Encrypts or decrypts data found at offset in the note container."""
+    out = bytearray(data)
+    nonce = (content_hash, 0, 0)
+    pos = 0
+    while pos < len(out):
+        counter, skip = divmod(offset + pos, BLOCK)
+        stream = struct.pack("<16I", *block(key, counter, nonce))
+        for i in range(skip, min(BLOCK, skip + len(out) - pos)):
+            out[pos] ^= stream[i]
+            pos += 1
+    return bytes(out)
+
+
+def _flip_note(blob, key, content_hash, flags):
+    magic, version, _, size, block_size, count = lz.HEADER.unpack_from(blob)
+    start = lz.HEADER.size + 4 * (count + 1)
+    header = lz.HEADER.pack(magic, version, flags, size, block_size, count)
+    return header + blob[lz.HEADER.size:start] + apply(key, content_hash, start, blob[start:])
+
+
+def lock_note(blob, key, content_hash):
+    """Encrypts the blocks of a compressed note (see lz.py) and flags it."""
+    return _flip_note(blob, key, content_hash, blob[3] | lz.LOCKED)
+
+
+def unlock_note(blob, key, content_hash):
+    """Decrypts what lock_note encrypted."""
+    return _flip_note(blob, key, content_hash, blob[3] & ~lz.LOCKED)
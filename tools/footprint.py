@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+Static footprint: what the app takes of RAM and flash before its first
+malloc, by section and by symbol, from the symbol table of the build.
+
+    tools/footprint.py [--nm NM] [--top N] [--max-text B] [--max-data B]
+                       [--max-bss B] [--max-ram B] [--baseline JSON]
+                       [--save JSON] FILE...
+
+FILE is the app ELF (build/pebble-app.elf, --nm arm-none-eabi-nm) or the
+host objects. Symbols are sorted into
+    text    code and read only data (T, t, W, w, R, r, V, v)
+    data    initialized globals (D, d, G, g), flash and RAM both
+    bss     zeroed globals (B, b, C, S, s), RAM only
+and ram is data + bss: what the watch takes from the app RAM, the heap
+having what is left (see heap_bytes_free).
+
+Prints the totals and the largest symbols of each section. With --baseline,
+the growth of every section and of the symbols that grew, against a report
+kept before with --save. Exits 1 when a section is over its --max-*, so a
+footprint regression fails the build before a release.
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+
+SECTIONS = ("text", "data", "bss")
+KINDS = {
+    "text": "TtWwRrVv",
+    "data": "DdGg",
+    "bss": "BbCSs",
+}
+
+
+def section_of(kind):
+    for section in SECTIONS:
+        if kind in KINDS[section]:
+            return section
+    return None
+
+
+def read_symbols(nm, path):
+    """{(section, name): size} of the sized symbols of path."""
+    out = subprocess.run([nm, "-S", "--size-sort", path], check=True, capture_output=True, text=True).stdout
+    symbols = {}
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) != 4:
+            continue
+        section = section_of(fields[2])
+        if section is None:
+            continue
+        key = (section, fields[3])
+        symbols[key] = symbols.get(key, 0) + int(fields[1], 16)
+    return symbols
+
+
+def totals(symbols):
+    sums = dict.fromkeys(SECTIONS, 0)
+    for (section, _), size in symbols.items():
+        sums[section] += size
+    sums["ram"] = sums["data"] + sums["bss"]
+    return sums
+
+
+def report(symbols, top):
+    sums = totals(symbols)
+    print("%-8s %8s" % ("section", "bytes"))
+    for section in SECTIONS + ("ram",):
+        print("%-8s %8d" % (section, sums[section]))
+    for section in SECTIONS:
+        largest = sorted(((size, name) for (s, name), size in symbols.items() if s == section), reverse=True)[:top]
+        if not largest:
+            continue
+        print("\nlargest %s" % section)
+        for size, name in largest:
+            print("  %8d  %s" % (size, name))
+    return sums
+
+
+def compare(symbols, baseline):
+    """Prints what grew since baseline, a report kept with --save."""
+    old = {(s, name): size for s, name, size in baseline["symbols"]}
+    now, before = totals(symbols), totals(old)
+    print("\nsince baseline")
+    for section in SECTIONS + ("ram",):
+        print("%-8s %8d %+8d" % (section, now[section], now[section] - before[section]))
+    grown = sorted(((size - old.get(key, 0), key) for key, size in symbols.items() if size > old.get(key, 0)),
+                   reverse=True)
+    for growth, (section, name) in grown:
+        print("  %+8d  %-5s %s%s" % (growth, section, name, "" if (section, name) in old else " (new)"))
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--nm", default="nm", help="nm of the toolchain that built FILE")
+    parser.add_argument("--top", type=int, default=8, help="symbols listed per section")
+    for limit in SECTIONS + ("ram",):
+        parser.add_argument("--max-" + limit, type=int, metavar="BYTES")
+    parser.add_argument("--baseline", help="report kept with --save to compare with")
+    parser.add_argument("--save", help="keep this report, for a later --baseline")
+    parser.add_argument("files", nargs="+")
+    args = parser.parse_args(argv)
+
+    symbols = {}
+    for path in args.files:
+        for key, size in read_symbols(args.nm, path).items():
+            symbols[key] = symbols.get(key, 0) + size
+
+    sums = report(symbols, args.top)
+    if args.baseline:
+        with open(args.baseline) as f:
+            compare(symbols, json.load(f))
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump({"symbols": sorted([s, name, size] for (s, name), size in symbols.items())}, f, indent=0)
+
+    over = 0
+    for section in SECTIONS + ("ram",):
+        limit = getattr(args, "max_" + section)
+        if limit is not None and sums[section] > limit:
+            print("footprint: %s takes %d bytes, over its %d" % (section, sums[section], limit), file=sys.stderr)
+            over += 1
+    return 1 if over else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
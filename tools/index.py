@@ -0,0 +1,146 @@
+"""
+Build-time inverted index over all the notes, so the watch can search them
+without reading their text.
+
+Words are runs of ASCII letters and digits, lowercased. Words longer than
+KEY_LEN bytes are cut to KEY_LEN, so a query of up to KEY_LEN characters
+still finds them by prefix.
+
+Index (little endian), read by src/note-search.c:
+    0   "NX"        magic
+    2   u8          version (3)
+    3   u8          key length (KEY_LEN)
+    4   u32         word count (n)
+    8   u32         posting count
+    12  word[n+1]   sorted words: char key[KEY_LEN] (NUL padded), u32 byte
+                    offset of its first posting. The last entry is a sentinel
+                    holding the posting bytes, so word i owns the bytes
+                    [first_i, first_i+1)
+    ..  varint[]    postings: note index << 20 | byte offset of the word,
+                    sorted by note then offset within every word. Each is
+                    a little endian base 128 varint of delta << 1 | restart:
+                    the first posting of a word restarts, its delta is from
+                    0, the others are from the posting before. A varint
+                    ends on a byte below 0x80, so counting those counts the
+                    postings of any run of words.
+
+Postings of the shipped notes take 917 bytes as varints against 1684 as
+u32s; the word table, 16 bytes a word, is most of the index.
+"""
+
+import struct
+
+MAGIC = b"NX"
+VERSION = 3
+HEADER = struct.Struct("<2sBBII")
+KEY_LEN = 12
+WORD = struct.Struct("<%dsI" % KEY_LEN)
+NOTE_SHIFT = 20
+MAX_OFFSET = (1 << NOTE_SHIFT) - 1
+MAX_NOTES = 1 << (32 - NOTE_SHIFT)
+
+
+def words(text):
+    """Yields (offset, word) for every word of text."""
+    start = None
+    for i, byte in enumerate(text + b" "):
+        if (0x30 <= byte <= 0x39) or (0x41 <= byte <= 0x5A) or (0x61 <= byte <= 0x7A):
+            if start is None:
+                start = i
+        elif start is not None:
+            yield start, text[start:i].lower()[:KEY_LEN]
+            start = None
+
+
+def varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append(value & 0x7F | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def encode_postings(postings):
+    """Varints of one word's sorted postings, the first one restarting."""
+    out = bytearray()
+    previous = None
+    for posting in postings:
+        if previous is None:
+            out += varint(posting << 1 | 1)
+        else:
+            out += varint((posting - previous) << 1)
+        previous = posting
+    return bytes(out)
+
+
+def decode_postings(data):
+    """Postings of a run of varints, across as many words as it holds."""
+    postings = []
+    value = shift = 0
+    previous = 0
+    for byte in data:
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte & 0x80:
+            continue
+        previous = (0 if value & 1 else previous) + (value >> 1)
+        postings.append(previous)
+        value = shift = 0
+    return postings
+
+
+def build_index(texts):
+    if len(texts) > MAX_NOTES:
+        raise ValueError("index: at most %d notes" % MAX_NOTES)
+    postings = {}
+    for note, text in enumerate(texts):
+        if len(text) > MAX_OFFSET:
+            raise ValueError("index: note %d is over %d bytes" % (note, MAX_OFFSET))
+        for offset, word in words(text):
+            postings.setdefault(word, []).append(note << NOTE_SHIFT | offset)
+
+    keys = sorted(postings)
+    table = []
+    encoded = bytearray()
+    for key in keys:
+        table.append(WORD.pack(key, len(encoded)))
+        encoded += encode_postings(postings[key])
+    table.append(WORD.pack(b"", len(encoded)))
+
+    total = sum(len(found) for found in postings.values())
+    header = HEADER.pack(MAGIC, VERSION, KEY_LEN, len(keys), total)
+    return header + b"".join(table) + bytes(encoded)
+
+
+def check(index, texts):
+    """True when every posting points at its word and no word is missing."""
+    _, _, key_len, count, total = HEADER.unpack_from(index)
+    base = HEADER.size + WORD.size * (count + 1)
+    for i in range(count):
+        key, first = WORD.unpack_from(index, HEADER.size + WORD.size * i)
+        _, last = WORD.unpack_from(index, HEADER.size + WORD.size * (i + 1))
+        key = key.rstrip(b"\0")
+        found = decode_postings(index[base + first:base + last])
+        if found != sorted(found):
+            return False
+        for posting in found:
+            text = texts[posting >> NOTE_SHIFT]
+            offset = posting & MAX_OFFSET
+            if text[offset:offset + len(key)].lower() != key:
+                return False
+    return total == sum(1 for text in texts for _ in words(text))
+
+
+def lookup(index, prefix):
+    """Reference lookup: the postings of every word starting with prefix."""
+    _, _, key_len, count, _ = HEADER.unpack_from(index)
+    prefix = prefix.lower()[:key_len]
+    base = HEADER.size + WORD.size * (count + 1)
+    hits = []
+    for i in range(count):
+        key, first = WORD.unpack_from(index, HEADER.size + WORD.size * i)
+        if key.rstrip(b"\0").startswith(prefix):
+            _, last = WORD.unpack_from(index, HEADER.size + WORD.size * (i + 1))
+            hits.extend(decode_postings(index[base + first:base + last]))
+    return hits
@@ -0,0 +1,111 @@
+"""
+Build-time line breaking for the system Gothic fonts, so the watch never has
+to lay out a whole note to know how tall it is or where a line starts.
+
+The advance widths below approximate the firmware Gothic glyphs (pixels, by
+character class). They err on the wide side: a line we think is full may end
+a few pixels early on the watch, but never wraps there.
+
+Line table (little endian), read by src/note-lines.c:
+    0   "NL"        magic
+    2   u8          version (1)
+    3   u8          font size in points (14, 18, 24, 28)
+    4   u16         line height in pixels
+    6   u16         wrap width in pixels
+    8   u32         line count
+    12  u32[n]      note offset where each wrapped line starts
+
+Every line has the same height, so line i sits at y = i * line height.
+"""
+
+import struct
+
+MAGIC = b"NL"
+VERSION = 1
+HEADER = struct.Struct("<2sBBHHI")
+WIDTH = 144
+
+# Gothic 14 advances; bigger sizes are scaled from these
+_NARROW = set("il.,:;'|!`")
+_SLIM = set("fjrtI()[]{}\"/\\ ")
+_WIDE = set("mwMW@%")
+_UPPER = set("ABCDEFGHJKLNOPQRSTUVXYZ&#")
+
+FONTS = {
+    # name: (points, line height)
+    "GOTHIC_14": (14, 16),
+    "GOTHIC_18": (18, 20),
+    "GOTHIC_24": (24, 26),
+    "GOTHIC_28": (28, 30),
+}
+
+
+def _advance14(ch):
+    if ch in _NARROW:
+        return 3
+    if ch in _SLIM:
+        return 4
+    if ch in _WIDE:
+        return 9
+    if ch in _UPPER:
+        return 7
+    return 6
+
+
+def advance(ch, points):
+    return (_advance14(ch) * points + 13) // 14
+
+
+def wrap(text, font):
+    """Returns the byte offsets where each wrapped line of text starts."""
+    points, _ = FONTS[font]
+    widths = {}
+    starts = [0]
+    x = 0
+    word_start = 0   # Byte offset where the current word starts
+    word_x = 0       # Pixels taken by the current word so far
+    i = 0
+    n = len(text)
+    while i < n:
+        byte = text[i]
+        if byte == 0x0A:
+            i += 1
+            if i < n:
+                starts.append(i)
+            x = word_x = 0
+            word_start = i
+            continue
+        # One UTF-8 sequence is one glyph
+        size = 1 if byte < 0xC0 else 2 if byte < 0xE0 else 3 if byte < 0xF0 else 4
+        glyph = text[i:i + size].decode("utf-8", "replace")
+        if glyph not in widths:
+            widths[glyph] = 0 if glyph == "\r" else advance(" " if glyph == "\t" else glyph, points)
+        w = widths[glyph]
+
+        if glyph in (" ", "\t"):
+            x += w
+            i += size
+            word_start = i
+            word_x = 0
+            continue
+        if x + w > WIDTH and x > 0:
+            if word_start > starts[-1] and word_x + w <= WIDTH:
+                # Move the whole word to the next line
+                starts.append(word_start)
+                x = word_x
+            else:
+                # Word wider than the screen, break it here
+                starts.append(i)
+                x = word_x = 0
+                word_start = i
+        x += w
+        word_x += w
+        i += size
+    return starts
+
+
+def line_table(text, font):
+    points, line_height = FONTS[font]
+    starts = wrap(text, font)
+    header = HEADER.pack(MAGIC, VERSION, points, line_height, WIDTH, len(starts))
+    return header + struct.pack("<%dI" % len(starts), *starts)
@@ -0,0 +1,175 @@
+"""
+Small-window LZ compressor for note resources, decoded on the watch by
+src/note-lz.c. Notes are cut in fixed size blocks that decode on their own,
+so the watch can open any block with one ranged read. Every block may copy
+from a dictionary shared by all the notes.
+
+Container (little endian):
+    0   "NZ"        magic
+    2   u8          version (1)
+    3   u8          flags, LOCKED (1): the blocks are encrypted (see
+                    cipher.py), header and block offsets are not
+    4   u32         plain size
+    8   u16         block size
+    10  u16         block count
+    12  u32[n + 1]  block offsets from the start of the container
+    ..  blocks
+
+Block tokens:
+    0xxxxxxx                    literal run of x + 1 bytes, bytes follow
+    1lllDDDD dddddddd [L]       match, distance DDDDdddddddd + 1 back into
+                                dictionary + block output, length lll + 3,
+                                or 10 + L when lll is 7
+"""
+
+import struct
+from collections import Counter, defaultdict
+
+MAGIC = b"NZ"
+VERSION = 1
+LOCKED = 1
+HEADER = struct.Struct("<2sBBIHH")
+
+MIN_MATCH = 3
+MAX_MATCH = 10 + 255
+MAX_DISTANCE = 4096
+MAX_LITERALS = 128
+MAX_CHAIN = 64
+
+
+def build_dictionary(texts, size):
+    """Greedy pick of the phrases found in the most notes. Repeats inside a
+    single note are left to the block itself."""
+    counts = Counter()
+    for text in texts:
+        phrases = set()
+        for line in text.split(b"\n"):
+            line = line.rstrip(b"\r")
+            for start in range(len(line)):
+                if start and line[start - 1] not in b" \t":
+                    continue
+                for length in range(4, min(32, len(line) - start) + 1):
+                    phrases.add(line[start:start + length])
+        counts.update(phrases)
+
+    picked = []
+    used = 0
+    ranked = sorted(counts.items(), key=lambda kv: ((kv[1] - 1) * (len(kv[0]) - 2), kv[0]), reverse=True)
+    for phrase, count in ranked:
+        if count < 2 or used + len(phrase) > size:
+            continue
+        if any(phrase in other for other in picked):
+            continue
+        picked.append(phrase)
+        used += len(phrase)
+    # Most valuable phrases last, closest to the block
+    return b"".join(reversed(picked))
+
+
+def _emit_literals(out, literals):
+    while literals:
+        run = literals[:MAX_LITERALS]
+        out.append(len(run) - 1)
+        out += run
+        literals = literals[MAX_LITERALS:]
+
+
+def _emit_match(out, length, distance):
+    distance -= 1
+    if length < 10:
+        out.append(0x80 | ((length - 3) << 4) | (distance >> 8))
+        out.append(distance & 0xFF)
+    else:
+        out.append(0x80 | (7 << 4) | (distance >> 8))
+        out.append(distance & 0xFF)
+        out.append(length - 10)
+
+
+def compress_block(block, dictionary):
+    """Compresses one block against the tail of the dictionary."""
+    history = dictionary[-(MAX_DISTANCE - len(block)):] if dictionary else b""
+    data = history + block
+    base = len(history)
+    chains = defaultdict(list)
+    for i in range(base - MIN_MATCH + 1):
+        chains[data[i:i + MIN_MATCH]].append(i)
+
+    out = bytearray()
+    literals = bytearray()
+    pos = base
+    while pos < len(data):
+        best_len = 0
+        best_pos = 0
+        key = data[pos:pos + MIN_MATCH]
+        if len(key) == MIN_MATCH:
+            for cand in reversed(chains[key][-MAX_CHAIN:]):
+                if pos - cand > MAX_DISTANCE:
+                    break
+                length = 0
+                limit = min(MAX_MATCH, len(data) - pos)
+                while length < limit and data[cand + length] == data[pos + length]:
+                    length += 1
+                if length > best_len:
+                    best_len, best_pos = length, cand
+                    if length == limit:
+                        break
+        if best_len >= MIN_MATCH:
+            _emit_literals(out, bytes(literals))
+            literals = bytearray()
+            _emit_match(out, best_len, pos - best_pos)
+            step = best_len
+        else:
+            literals.append(data[pos])
+            step = 1
+        for i in range(pos, pos + step):
+            if i + MIN_MATCH <= len(data):
+                chains[data[i:i + MIN_MATCH]].append(i)
+        pos += step
+    _emit_literals(out, bytes(literals))
+    return bytes(out)
+
+
+def decompress_block(payload, dictionary, limit):
+    """Reference decoder, mirrors note_lz_decode in src/note-lz.c."""
+    out = bytearray()
+    i = 0
+    while i < len(payload) and len(out) < limit:
+        token = payload[i]
+        i += 1
+        if token < 0x80:
+            out += payload[i:i + token + 1]
+            i += token + 1
+            continue
+        length = ((token >> 4) & 7) + 3
+        distance = (((token & 0x0F) << 8) | payload[i]) + 1
+        i += 1
+        if length == 10:
+            length += payload[i]
+            i += 1
+        for _ in range(length):
+            back = len(out) - distance
+            out.append(out[back] if back >= 0 else dictionary[len(dictionary) + back])
+    return bytes(out[:limit])
+
+
+def compress_note(text, dictionary, block_size):
+    blocks = [compress_block(text[i:i + block_size], dictionary)
+              for i in range(0, len(text), block_size)]
+    offset = HEADER.size + 4 * (len(blocks) + 1)
+    offsets = []
+    for block in blocks:
+        offsets.append(offset)
+        offset += len(block)
+    offsets.append(offset)
+    header = HEADER.pack(MAGIC, VERSION, 0, len(text), block_size, len(blocks))
+    return header + struct.pack("<%dI" % len(offsets), *offsets) + b"".join(blocks)
+
+
+def decompress_note(blob, dictionary):
+    magic, version, flags, size, block_size, count = HEADER.unpack_from(blob)
+    assert magic == MAGIC and version == VERSION
+    offsets = struct.unpack_from("<%dI" % (count + 1), blob, HEADER.size)
+    out = b""
+    for k in range(count):
+        out += decompress_block(blob[offsets[k]:offsets[k + 1]], dictionary, block_size)
+    return out[:size]
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+Build-time text normalization, run on every note before it is packed, so
+the watch draws, wraps, searches and previews the bytes as they are and
+never cleans text up.
+
+    tools/normalize.py [--check] FILE...
+
+Every note comes out as UTF-8 the system fonts can draw:
+    - the byte order mark goes (UTF-8, or UTF-16 which is decoded)
+    - text that is not valid UTF-8 is read as Windows-1252, with a warning
+    - CRLF and lone CR line ends become LF
+    - tabs become spaces up to the next TAB_STOP column
+    - other control characters and trailing spaces of a line go
+    - characters outside printable ASCII and Latin-1 (what the Gothic fonts
+      hold) are mapped to a close match: typographic quotes and dashes,
+      ellipsis, minus, bullets, no-break and zero width spaces, then accents
+      dropped by decomposition, else REPLACEMENT
+
+The work is done by str and bytes methods (count, replace, expandtabs,
+translate) that run in C. Text that fits Latin-1 is checked by deleting the
+drawable bytes and looking at what is left, and only text beyond it takes a
+regular expression pass, so clean notes cost a few copies. Run alone, it prints what it would change in each
+FILE and how fast it went; --check fails when any FILE needs changing.
+"""
+
+import argparse
+import re
+import sys
+import time
+import unicodedata
+
+TAB_STOP = 4
+REPLACEMENT = "?"
+
+# What the Gothic fonts draw besides printable ASCII
+_DRAWABLE = re.compile(r"[^\n\x20-\x7e\xa1-\xff]")
+_DRAWABLE_BYTES = b"\n" + bytes(range(0x20, 0x7F)) + bytes(range(0xA1, 0x100))
+
+# Close matches for characters the fonts lack, "" to drop
+_FALLBACK = {
+    # Spaces, and invisible characters dropped
+    "\u00a0": " ", "\u2002": " ", "\u2003": " ", "\u2009": " ", "\u202f": " ",
+    "\u200b": "", "\u200c": "", "\u200d": "", "\u2060": "", "\ufeff": "", "\u00ad": "",
+    # Typographic punctuation
+    "\u2018": "'", "\u2019": "'", "\u201a": ",", "\u201b": "'", "\u2032": "'",
+    "\u201c": '"', "\u201d": '"', "\u201e": '"', "\u2033": '"',
+    "\u2010": "-", "\u2011": "-", "\u2012": "-", "\u2013": "-", "\u2014": "-", "\u2015": "-",
+    "\u2212": "-", "\u2026": "...", "\u2022": "*", "\u2023": ">", "\u2043": "-",
+    # Arrows, maths and symbols
+    "\u2190": "<-", "\u2192": "->", "\u2194": "<->", "\u21d2": "=>",
+    "\u2264": "<=", "\u2265": ">=", "\u2260": "!=", "\u2248": "~", "\u221e": "inf",
+    "\u20ac": "EUR", "\u2122": "TM",
+    # Letters that do not decompose to a base letter
+    "\u0141": "L", "\u0142": "l", "\u0110": "D", "\u0111": "d", "\u0152": "OE", "\u0153": "oe",
+    "\u0131": "i",
+}
+
+
+def _map(ch):
+    """Drawable stand-in for ch: the table, then ch without its accents."""
+    if ch in _FALLBACK:
+        return _FALLBACK[ch]
+    if unicodedata.category(ch)[0] == "C":
+        return ""
+    base = "".join(c for c in unicodedata.normalize("NFKD", ch) if not unicodedata.combining(c))
+    if base and not _DRAWABLE.search(base):
+        return base
+    return REPLACEMENT
+
+
+def _decode(raw, report):
+    if raw.startswith(b"\xef\xbb\xbf"):
+        report["bom"] = 1
+        raw = raw[3:]
+    elif raw.startswith((b"\xff\xfe", b"\xfe\xff")):
+        report["bom"] = 1
+        return raw.decode("utf-16")
+    try:
+        return raw.decode("utf-8")
+    except UnicodeDecodeError as e:
+        report["not utf-8"] = e.start
+        return raw.decode("cp1252", "replace")
+
+
+def normalize(raw):
+    """Returns the normalized bytes of raw and a report {change: count}."""
+    report = {}
+    text = _decode(raw, report)
+
+    crlf = text.count("\r\n")
+    if crlf:
+        text = text.replace("\r\n", "\n")
+        report["crlf"] = crlf
+    cr = text.count("\r")
+    if cr:
+        text = text.replace("\r", "\n")
+        report["cr"] = cr
+    tabs = text.count("\t")
+    if tabs:
+        text = text.expandtabs(TAB_STOP)
+        report["tabs"] = tabs
+
+    try:
+        odd = text.encode("latin-1").translate(None, _DRAWABLE_BYTES).decode("latin-1")
+    except UnicodeEncodeError:
+        odd = _DRAWABLE.findall(text)
+    if odd:
+        report["mapped"] = len(odd)
+        report["mapped chars"] = "".join(sorted(set(odd)))
+        # Few distinct characters, each replace is one pass in C
+        for ch in report["mapped chars"]:
+            text = text.replace(ch, _map(ch))
+
+    if " \n" in text or text.endswith(" "):
+        trimmed = len(text)
+        text = "\n".join(line.rstrip(" ") for line in text.split("\n"))
+        report["trailing"] = trimmed - len(text)
+    return text.encode("utf-8"), report
+
+
+def describe(report):
+    """One line summary of a report, "" when nothing changed."""
+    parts = []
+    if "bom" in report:
+        parts.append("BOM stripped")
+    if "not utf-8" in report:
+        parts.append("not UTF-8 at byte %d, read as Windows-1252" % report["not utf-8"])
+    if "crlf" in report or "cr" in report:
+        parts.append("%d line ends" % (report.get("crlf", 0) + report.get("cr", 0)))
+    if "tabs" in report:
+        parts.append("%d tabs" % report["tabs"])
+    if "mapped" in report:
+        shown = report["mapped chars"].encode("ascii", "backslashreplace").decode("ascii")
+        parts.append("%d mapped (%s)" % (report["mapped"], shown))
+    if "trailing" in report:
+        parts.append("%d trailing spaces" % report["trailing"])
+    return ", ".join(parts)
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--check", action="store_true", help="fail when a file needs changing")
+    parser.add_argument("files", nargs="+")
+    args = parser.parse_args(argv)
+
+    total = 0
+    seconds = 0.0
+    dirty = 0
+    for path in args.files:
+        with open(path, "rb") as f:
+            raw = f.read()
+        start = time.perf_counter()
+        _, report = normalize(raw)
+        seconds += time.perf_counter() - start
+        total += len(raw)
+        dirty += bool(report)
+        print("%-36s %s" % (path, describe(report) or "clean"))
+    print("%d files, %d bytes in %.1f ms (%.0f MB/s)" % (len(args.files), total, seconds * 1e3,
+                                                         total / max(seconds, 1e-9) / 1e6))
+    return 1 if args.check and dirty else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,102 @@
+"""
+Note pack: every note of the app in a single resource, so adding a note is
+dropping a text file in resources/notes and rebuilding, not editing code.
+
+Pack (little endian), read by src/note-pack.c:
+    0   "NP"        magic
+    2   u8          version (2)
+    3   u8          title length (TITLE_LEN)
+    4   u32         note count (n)
+    8   u32         dictionary offset
+    12  u32         dictionary length
+    16  u32         search index offset
+    20  u32         search index length
+    24  entry[n]    table of contents, ENTRY bytes each:
+                        u32 note offset, u32 note length (see lz.py)
+                        u32 line table offset, u32 length (see layout.py)
+                        u32 plain size
+                        u8 flags, u24 PIN check of a LOCKED note
+                        u32 content hash, FNV-1a of the plain text
+                        char title[TITLE_LEN], NUL padded and terminated
+    ..              dictionary, search index (see index.py), then note bodies
+
+Flags:
+    TABLE (1)       a CSV note: the note range holds a table (see table.py)
+                    and there is no line table. Tables are not compressed
+                    nor indexed.
+    LOCKED (4)      the note blocks are encrypted (see cipher.py). Its title
+                    is not taken from its text, and it is left out of the
+                    shared dictionary and the search index.
+
+The content hash names a note across rebuilds: the watch keeps its reading
+position under it, so it follows the note when others are added or renamed
+and is dropped when the text changes.
+
+All offsets are from the start of the pack, so note i is found with one
+ranged read at 24 + i * ENTRY.
+"""
+
+import struct
+
+MAGIC = b"NP"
+VERSION = 2
+HEADER = struct.Struct("<2sBBIIIII")
+TITLE_LEN = 24
+ENTRY = struct.Struct("<IIIIIB3sI%ds" % TITLE_LEN)
+TABLE = 1
+LOCKED = 4
+
+
+def content_hash(text):
+    """32 bit FNV-1a of the plain text, as stored in the table of contents."""
+    h = 2166136261
+    for byte in text:
+        h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def title_of(text, fallback):
+    """First non blank line of the note, cut to fit TITLE_LEN with its NUL."""
+    if text.startswith(b"\xef\xbb\xbf"):
+        text = text[3:]
+    for line in text.split(b"\n"):
+        line = b" ".join(line.replace(b"\t", b" ").split())
+        if line:
+            break
+    else:
+        line = fallback.encode("utf-8")
+    line = line[:TITLE_LEN - 1]
+    # Never keep half a UTF-8 character
+    return line.decode("utf-8", "ignore").encode("utf-8")
+
+
+def build_pack(notes, dictionary, index):
+    """notes is a list of (title, plain size, packed note, line table, flags,
+    content hash, PIN check)."""
+    toc_end = HEADER.size + ENTRY.size * len(notes)
+    dict_offset = toc_end
+    index_offset = dict_offset + len(dictionary)
+    body = index_offset + len(index)
+
+    entries = []
+    bodies = []
+    for title, size, packed, lines, flags, content, check in notes:
+        lines_offset = body + len(packed) if lines else 0
+        entries.append(ENTRY.pack(body, len(packed), lines_offset, len(lines), size, flags,
+                                  check.to_bytes(3, "little"), content, title))
+        bodies.append(packed + lines)
+        body += len(packed) + len(lines)
+
+    header = HEADER.pack(MAGIC, VERSION, TITLE_LEN, len(notes), dict_offset, len(dictionary),
+                         index_offset, len(index))
+    return header + b"".join(entries) + dictionary + index + b"".join(bodies)
+
+
+def entries(pack):
+    """Yields (title, plain size, packed note, line table, flags, content hash,
+    PIN check) back from a pack."""
+    _, _, _, count, _, _, _, _ = HEADER.unpack_from(pack)
+    for i in range(count):
+        offset, length, lines, lines_len, size, flags, check, content, title = ENTRY.unpack_from(pack, HEADER.size + ENTRY.size * i)
+        yield (title.rstrip(b"\0"), size, pack[offset:offset + length], pack[lines:lines + lines_len], flags, content,
+               int.from_bytes(check, "little"))
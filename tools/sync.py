@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+Sync records: one text note the way the phone sends it to the watch over
+AppMessage (see src/note-sync.h), so notes can change without reinstalling
+the app. The watch keeps records in persistent storage (src/note-store.c)
+and reads them like pack notes.
+
+    tools/sync.py [--font FONT] OUT NOTE...
+
+Writes OUT/<name>.ns for every NOTE, normalized (see normalize.py) like the
+notes of the pack.
+
+Record (little endian):
+    0   "NS"        magic
+    2   u8          version (1)
+    3   u8          flags (0)
+    4   u32         content hash (see pack.py)
+    8   u16         note length
+    10  u16         line table length
+    12  char title[TITLE_LEN], NUL padded and terminated
+    36  note        (see lz.py), compressed without the pack dictionary so
+                    it reads the same whatever pack the watch has
+    ..  line table  (see layout.py)
+
+A record must fit MAX_LEN, the storage the watch gives a synced note.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+import layout
+import lz
+import normalize
+import pack
+
+MAGIC = b"NS"
+VERSION = 1
+HEADER = struct.Struct("<2sBBIHH%ds" % pack.TITLE_LEN)
+BLOCK_SIZE = 512     # Must match NOTE_CHUNK_LEN in src/note-stream.h
+MAX_LEN = 8 * 128    # Must match NOTE_STORE_CHUNKS * NOTE_STORE_CHUNK_LEN in src/note-store.h
+
+
+def build_record(text, fallback, font):
+    """Record of the normalized text, titled like the pack would."""
+    packed = lz.compress_note(text, b"", BLOCK_SIZE)
+    lines = layout.line_table(text, font)
+    title = pack.title_of(text, fallback)
+    header = HEADER.pack(MAGIC, VERSION, 0, pack.content_hash(text), len(packed), len(lines), title)
+    return header + packed + lines
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--font", default="GOTHIC_14", choices=sorted(layout.FONTS),
+                        help="must match FONT_TYPE in src/main.c")
+    parser.add_argument("out")
+    parser.add_argument("notes", nargs="+")
+    args = parser.parse_args(argv)
+
+    os.makedirs(args.out, exist_ok=True)
+    for path in args.notes:
+        with open(path, "rb") as f:
+            text, _ = normalize.normalize(f.read())
+        name = os.path.splitext(os.path.basename(path))[0]
+        record = build_record(text, name, args.font)
+        if len(record) > MAX_LEN:
+            sys.exit("sync: %s takes %d bytes, at most %d fit on the watch" % (path, len(record), MAX_LEN))
+        with open(os.path.join(args.out, name + ".ns"), "wb") as f:
+            f.write(record)
+        print("%-36s %8d %8d" % (path, len(text), len(record)))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,337 @@
+"""
+Columnar tables for CSV notes, so the watch reads only the cells on screen
+instead of laying out the CSV as text.
+
+Every column is stored on its own, typed: whole numbers and decimals become
+integers (decimals in fixed point, value * 10^scale) in the fewest bytes that
+hold the column, and text becomes offsets into the column's pool of strings,
+each distinct string stored once. The cells of the rows on screen are one
+ranged read per column.
+
+The first row is taken as the column names when it has text over a number
+column; otherwise columns are named A, B, C...
+
+Every column whose cells are distinct, short and typeable on the watch
+(letters and digits, compared lowercase) also gets a key index: a minimal
+perfect hash from key to row. The watch finds a row by its key with the
+bucket seed and one ranged read of the slot, never scanning the column.
+
+Table (little endian), read by src/note-table.c:
+    0   "NT"        magic
+    2   u8          version (2)
+    3   u8          column count (c)
+    4   u16         row count (r)
+    6   u8          row height in pixels
+    7   u8          key index count (k)
+    8   column[c]   COLUMN bytes each:
+                        u8 type (0 number, 1 text)
+                        u8 value bytes (1, 2 or 4)
+                        u8 flags (bit 0: signed)
+                        u8 scale, decimal digits after the point
+                        u8 width in pixels, widest cell or name plus padding
+                        u8[3] reserved
+                        u32 values offset: r values of value bytes
+                        u32 pool offset (text): NUL terminated strings
+                        char name[NAME_LEN], NUL padded and terminated
+    ..  key[k]      KEY bytes each:
+                        u8 column
+                        u8 key length (l), longest key of the column
+                        u16 bucket count (m)
+                        u32 seeds offset: m u16 seeds
+                        u32 slots offset: r slots of l + 2 bytes, the key
+                        NUL padded then its u16 row
+    ..              values, pools, seeds and slots
+
+Offsets are from the start of the table.
+
+Key hash, also in src/note-table.c: FNV-1a over the key bytes starting from
+2166136261 ^ seed, then h ^= h >> 15. A key is in bucket hash(key, 0) % m
+and in slot hash(key, seeds[bucket]) % r.
+"""
+
+import csv
+import io
+import re
+import struct
+
+import layout
+
+MAGIC = b"NT"
+VERSION = 2
+HEADER = struct.Struct("<2sBBHBB")
+NAME_LEN = 12
+COLUMN = struct.Struct("<BBBBB3xII%ds" % NAME_LEN)
+KEY = struct.Struct("<BBHII")
+NUMBER, TEXT = 0, 1
+SIGNED = 1
+MAX_COLUMNS = 8      # Must match NOTE_TABLE_MAX_COLUMNS in src/note-table.h
+CELL_LEN = 24        # Must match NOTE_TABLE_CELL_LEN, NUL included
+PADDING = 6          # Pixels between columns
+MAX_KEY = 12         # Must match NOTE_SEARCH_KEY_LEN, the longest query
+MAX_KEYS = 4         # Must match NOTE_TABLE_MAX_KEYS
+KEYS_PER_BUCKET = 3
+
+_NUMBER = re.compile(r"^-?\d+(\.\d+)?$")
+_KEY = re.compile(r"^[a-z0-9]+$")
+
+
+def _decimals(cell):
+    return len(cell.split(".")[1].rstrip("0")) if "." in cell else 0
+
+
+def _fixed(cell, scale):
+    whole, _, frac = cell.partition(".")
+    negative = whole.startswith("-")
+    frac = (frac + "0" * (scale + 1))[:scale + 1]
+    value = int(whole.lstrip("-") or "0") * 10 ** scale + int(frac[:scale] or "0")
+    if int(frac[scale]) >= 5:
+        value += 1
+    return -value if negative else value
+
+
+def _fits(values):
+    """Smallest (bytes, signed) holding every value, or None."""
+    low, high = min(values), max(values)
+    for size in (1, 2, 4):
+        if low >= 0 and high < 1 << (8 * size):
+            return size, False
+        if low >= -(1 << (8 * size - 1)) and high < 1 << (8 * size - 1):
+            return size, True
+    return None
+
+
+def _text_width(text, points):
+    return sum(layout.advance(ch, points) for ch in text)
+
+
+def _number_column(cells):
+    """(values, bytes, signed, scale, rounded) or None when not numeric."""
+    if not cells or not all(_NUMBER.match(cell) for cell in cells):
+        return None
+    scale = max(_decimals(cell) for cell in cells)
+    # Fewer decimals when the exact ones would not fit in 32 bits
+    while scale >= 0:
+        values = [_fixed(cell, scale) for cell in cells]
+        fit = _fits(values)
+        if fit:
+            rounded = scale < max(_decimals(cell) for cell in cells)
+            return values, fit[0], fit[1], scale, rounded
+        scale -= 1
+    return None
+
+
+def _format(value, scale):
+    """The text the watch shows for a number, trailing zeros dropped."""
+    sign = "-" if value < 0 else ""
+    value = abs(value)
+    if scale == 0:
+        return sign + str(value)
+    whole, frac = divmod(value, 10 ** scale)
+    frac = str(frac).rjust(scale, "0").rstrip("0")
+    return sign + str(whole) + ("." + frac if frac else "")
+
+
+def key_hash(key, seed):
+    h = 2166136261 ^ seed
+    for byte in key:
+        h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+    return h ^ (h >> 15)
+
+
+def _keys(shown):
+    """The lowercase keys of a column, or None when it cannot be keyed."""
+    keys = [cell.lower().encode("utf-8") for cell in shown]
+    if not keys or len(set(keys)) != len(keys):
+        return None
+    if not all(_KEY.match(key.decode("utf-8")) and len(key) <= MAX_KEY for key in keys):
+        return None
+    return keys
+
+
+def perfect_hash(keys):
+    """Bucket seeds placing every key in its own slot, hash and displace:
+    biggest buckets first, each gets the first seed that lands all its keys
+    on free slots."""
+    n = len(keys)
+    m = max(1, (n + KEYS_PER_BUCKET - 1) // KEYS_PER_BUCKET)
+    while True:
+        buckets = [[] for _ in range(m)]
+        for key in keys:
+            buckets[key_hash(key, 0) % m].append(key)
+        seeds = [0] * m
+        taken = [False] * n
+        for b in sorted(range(m), key=lambda b: -len(buckets[b])):
+            if not buckets[b]:
+                continue
+            for seed in range(1, 1 << 16):
+                slots = [key_hash(key, seed) % n for key in buckets[b]]
+                if len(set(slots)) == len(slots) and not any(taken[slot] for slot in slots):
+                    for slot in slots:
+                        taken[slot] = True
+                    seeds[b] = seed
+                    break
+            else:
+                break
+        else:
+            return seeds
+        # Some bucket found no seed: smaller buckets, try again
+        m += m // 4 + 1
+
+
+def find(table, key, only=None):
+    """Row of key through the key indexes (or key index only), like the
+    watch, or None."""
+    _, _, columns, rows, _, count = HEADER.unpack_from(table)
+    key = key.lower().encode("utf-8")
+    for k in range(count) if only is None else [only]:
+        _, length, m, seeds, slots = KEY.unpack_from(table, HEADER.size + COLUMN.size * columns + KEY.size * k)
+        if len(key) > length:
+            continue
+        seed = struct.unpack_from("<H", table, seeds + 2 * (key_hash(key, 0) % m))[0]
+        slot = slots + (length + 2) * (key_hash(key, seed) % rows)
+        if table[slot:slot + length] == key.ljust(length, b"\0"):
+            return struct.unpack_from("<H", table, slot + length)[0]
+    return None
+
+
+def parse(text):
+    """Rows of the CSV (list of lists of str) and the column names."""
+    rows = [row for row in csv.reader(io.StringIO(text.decode("utf-8-sig"))) if any(cell.strip() for cell in row)]
+    width = max((len(row) for row in rows), default=0)
+    rows = [[cell.strip() for cell in row] + [""] * (width - len(row)) for row in rows]
+    names = [chr(ord("A") + i) for i in range(width)]
+    if len(rows) > 1:
+        first, rest = rows[0], rows[1:]
+        header = any(not _NUMBER.match(first[c]) and _number_column([row[c] for row in rest]) for c in range(width))
+        if header:
+            names = [first[c] or names[c] for c in range(width)]
+            rows = rest
+    return rows, names
+
+
+def _column(cells, name, points):
+    """One typed column: (descriptor fields but offsets, values, pool, shown
+    text, rounded scale or None)."""
+    number = _number_column(cells)
+    rounded = None
+    if number:
+        values, size, signed, scale, lossy = number
+        if lossy:
+            rounded = scale
+        shown = [_format(value, scale) for value in values]
+        kind, flags, pool = NUMBER, SIGNED if signed else 0, b""
+    else:
+        # Each distinct string once, in order of first use, so neighbour
+        # rows have neighbour strings
+        pool = bytearray()
+        where = {}
+        values = []
+        for cell in cells:
+            data_cell = cell.encode("utf-8")[:CELL_LEN - 1].decode("utf-8", "ignore").encode("utf-8")
+            if data_cell not in where:
+                where[data_cell] = len(pool)
+                pool += data_cell + b"\0"
+            values.append(where[data_cell])
+        size, _ = _fits(values or [0])
+        kind, flags, scale, shown = TEXT, 0, 0, cells
+        pool = bytes(pool)
+    width = max([_text_width(cell, points) for cell in shown] + [_text_width(name, points)]) + PADDING
+    code = {1: "b", 2: "h", 4: "i"}[size] if flags & SIGNED else {1: "B", 2: "H", 4: "I"}[size]
+    values = struct.pack("<%d%s" % (len(values), code), *values)
+    return (kind, size, flags, scale, min(width, layout.WIDTH)), values, pool, shown, rounded
+
+
+def _key_index(keys):
+    """Seeds and slots of the perfect hash over keys, and the key length."""
+    seeds = perfect_hash(keys)
+    length = max(len(key) for key in keys)
+    slots = [None] * len(keys)
+    for row, key in enumerate(keys):
+        bucket = key_hash(key, 0) % len(seeds)
+        slots[key_hash(key, seeds[bucket]) % len(keys)] = key.ljust(length, b"\0") + struct.pack("<H", row)
+    return struct.pack("<%dH" % len(seeds), *seeds), b"".join(slots), length, len(seeds)
+
+
+def build_table(text, font):
+    """Returns the table and a list of notes about lossy columns."""
+    points, line_height = layout.FONTS[font]
+    rows, names = parse(text)
+    columns = len(names)
+    if columns == 0 or columns > MAX_COLUMNS:
+        raise ValueError("%d columns, the viewer takes 1 to %d" % (columns, MAX_COLUMNS))
+    if len(rows) >= 1 << 16:
+        raise ValueError("%d rows, at most %d" % (len(rows), (1 << 16) - 1))
+
+    warnings = []
+    built = []
+    keyed = []
+    for c in range(columns):
+        name = names[c].encode("utf-8")[:NAME_LEN - 1].decode("utf-8", "ignore")
+        fields, values, pool, shown, rounded = _column([row[c] for row in rows], name, points)
+        if rounded is not None:
+            warnings.append("column %s rounded to %d decimals" % (name, rounded))
+        built.append((fields, values, pool, name))
+        keys = _keys(shown)
+        if keys and len(keyed) < MAX_KEYS:
+            keyed.append((c, _key_index(keys)))
+
+    # Descriptors first, then the data they point at
+    offset = HEADER.size + COLUMN.size * columns + KEY.size * len(keyed)
+    descriptors = []
+    data = []
+    for (kind, size, flags, scale, width), values, pool, name in built:
+        pool_offset = offset + len(values) if kind == TEXT else 0
+        descriptors.append(COLUMN.pack(kind, size, flags, scale, width, offset, pool_offset, name.encode("utf-8")))
+        data.append(values + pool)
+        offset += len(values) + len(pool)
+    for c, (seeds, slots, length, buckets) in keyed:
+        descriptors.append(KEY.pack(c, length, buckets, offset, offset + len(seeds)))
+        data.append(seeds + slots)
+        offset += len(seeds) + len(slots)
+
+    header = HEADER.pack(MAGIC, VERSION, columns, len(rows), line_height, len(keyed))
+    return header + b"".join(descriptors) + b"".join(data), warnings
+
+
+def cells(table):
+    """Reads a table back as (names, scales, rows of shown text), like the
+    watch. scales is None for text columns."""
+    _, _, columns, count, _, _ = HEADER.unpack_from(table)
+    names = []
+    scales = []
+    out = [[] for _ in range(count)]
+    for c in range(columns):
+        kind, size, flags, scale, _, values, pool, name = COLUMN.unpack_from(table, HEADER.size + COLUMN.size * c)
+        names.append(name.rstrip(b"\0").decode("utf-8"))
+        scales.append(scale if kind == NUMBER else None)
+        code = {1: "b", 2: "h", 4: "i"}[size] if flags & SIGNED else {1: "B", 2: "H", 4: "I"}[size]
+        for r, value in enumerate(struct.unpack_from("<%d%s" % (count, code), table, values)):
+            if kind == NUMBER:
+                out[r].append(_format(value, scale))
+            else:
+                start = pool + value
+                out[r].append(table[start:table.index(b"\0", start)].decode("utf-8"))
+    return names, scales, out
+
+
+def check(table, text):
+    """True when the table shows every cell of the CSV: text as is (cut to
+    CELL_LEN), numbers to within their rounding."""
+    rows, names = parse(text)
+    got_names, scales, got = cells(table)
+    if len(got) != len(rows) or len(got_names) != len(names):
+        return False
+    for row, shown in zip(rows, got):
+        for cell, value, scale in zip(row, shown, scales):
+            if scale is not None:
+                if abs(float(cell) - float(value)) > 0.5 * 10 ** -scale + 1e-12:
+                    return False
+            elif cell.encode("utf-8")[:CELL_LEN - 1].decode("utf-8", "ignore") != value:
+                return False
+    # Every key of every key index finds its own row
+    _, _, columns, _, _, count = HEADER.unpack_from(table)
+    for k in range(count):
+        c = KEY.unpack_from(table, HEADER.size + COLUMN.size * columns + KEY.size * k)[0]
+        if any(find(table, row[c], k) != r for r, row in enumerate(got)):
+            return False
+    return True